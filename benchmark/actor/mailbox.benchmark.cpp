@@ -0,0 +1,216 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/actor/mailbox.hpp>
+#include <mbgl/actor/message.hpp>
+#include <mbgl/util/mpsc_queue.hpp>
+#include <mbgl/util/thread_pool.hpp>
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+constexpr std::size_t messagesPerProducer = 10000;
+
+// The queue Mailbox used before switching to util::MPSCQueue, kept as a baseline.
+template <class T>
+class LockedQueue {
+public:
+    void push(T value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push(std::move(value));
+    }
+
+    bool pop(T& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty()) {
+            return false;
+        }
+        value = std::move(queue.front());
+        queue.pop();
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::queue<T> queue;
+};
+
+// Every producer thread pushes its messages while the benchmark thread consumes them.
+template <class Queue>
+void runProducers(benchmark::State& state) {
+    const auto producers = static_cast<std::size_t>(state.range(0));
+    const std::size_t total = producers * messagesPerProducer;
+
+    while (state.KeepRunning()) {
+        Queue queue;
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < producers; ++i) {
+            threads.emplace_back([&queue] {
+                for (std::size_t j = 0; j < messagesPerProducer; ++j) {
+                    queue.push(std::make_unique<std::size_t>(j));
+                }
+            });
+        }
+
+        std::unique_ptr<std::size_t> message;
+        for (std::size_t received = 0; received < total;) {
+            if (queue.pop(message)) {
+                ++received;
+            }
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * total);
+}
+
+// The Mailbox used before switching to util::MPSCQueue, kept as a baseline. Every push and
+// receive takes the queue lock, and pushes serialize with close() through a second lock.
+class LockedMailbox : public std::enable_shared_from_this<LockedMailbox> {
+public:
+    explicit LockedMailbox(Scheduler& scheduler_) : scheduler(scheduler_) {}
+
+    void close() {
+        std::lock_guard<std::recursive_mutex> receivingLock(receivingMutex);
+        std::lock_guard<std::mutex> pushingLock(pushingMutex);
+        closed = true;
+    }
+
+    void push(std::unique_ptr<Message> message) {
+        std::lock_guard<std::mutex> pushingLock(pushingMutex);
+        if (closed) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        const bool wasEmpty = queue.empty();
+        queue.push(std::move(message));
+        if (wasEmpty) {
+            scheduleReceive();
+        }
+    }
+
+    void receive() {
+        std::lock_guard<std::recursive_mutex> receivingLock(receivingMutex);
+        if (closed) {
+            return;
+        }
+
+        std::unique_ptr<Message> message;
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> queueLock(queueMutex);
+            message = std::move(queue.front());
+            queue.pop();
+            wasEmpty = queue.empty();
+        }
+
+        (*message)();
+
+        if (!wasEmpty) {
+            scheduleReceive();
+        }
+    }
+
+private:
+    void scheduleReceive() {
+        scheduler.schedule([mailbox = std::weak_ptr<LockedMailbox>(shared_from_this())] {
+            if (auto locked = mailbox.lock()) {
+                locked->receive();
+            }
+        });
+    }
+
+    Scheduler& scheduler;
+    std::recursive_mutex receivingMutex;
+    std::mutex pushingMutex;
+    std::mutex queueMutex;
+    std::queue<std::unique_ptr<Message>> queue;
+    bool closed = false;
+};
+
+class Counter {
+public:
+    Counter(std::size_t expected_, std::promise<void> done_) : expected(expected_), done(std::move(done_)) {}
+
+    void increment() {
+        if (++count == expected) {
+            done.set_value();
+        }
+    }
+
+private:
+    const std::size_t expected;
+    std::size_t count = 0;
+    std::promise<void> done;
+};
+
+// Every producer thread sends its messages to one mailbox, which receives them on a thread pool
+// and reschedules itself while messages are queued.
+template <class MailboxType>
+void runMailbox(benchmark::State& state) {
+    const auto producers = static_cast<std::size_t>(state.range(0));
+    const std::size_t total = producers * messagesPerProducer;
+    ThreadPool pool(2);
+
+    while (state.KeepRunning()) {
+        std::promise<void> done;
+        auto finished = done.get_future();
+        Counter counter(total, std::move(done));
+        auto mailbox = std::make_shared<MailboxType>(pool);
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < producers; ++i) {
+            threads.emplace_back([&counter, &mailbox] {
+                for (std::size_t j = 0; j < messagesPerProducer; ++j) {
+                    mailbox->push(actor::makeMessage(counter, &Counter::increment));
+                }
+            });
+        }
+
+        finished.get();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        // Waits for the last receive() to return before the counter goes away.
+        mailbox->close();
+    }
+
+    state.SetItemsProcessed(state.iterations() * total);
+}
+
+} // namespace
+
+static void Mailbox_LockedQueue(benchmark::State& state) {
+    runProducers<LockedQueue<std::unique_ptr<std::size_t>>>(state);
+}
+
+static void Mailbox_LockFreeQueue(benchmark::State& state) {
+    runProducers<util::MPSCQueue<std::unique_ptr<std::size_t>>>(state);
+}
+
+// Messages sent from several threads to a single mailbox, end to end: push, receive and
+// reschedule, with the previous locked mailbox and the current one.
+static void Mailbox_LockedMailbox(benchmark::State& state) {
+    runMailbox<LockedMailbox>(state);
+}
+
+static void Mailbox_Mailbox(benchmark::State& state) {
+    runMailbox<Mailbox>(state);
+}
+
+BENCHMARK(Mailbox_LockedQueue)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK(Mailbox_LockFreeQueue)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK(Mailbox_LockedMailbox)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK(Mailbox_Mailbox)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
@@ -7,9 +7,22 @@
 #include <mbgl/style/conversion/property_value.hpp>
 #include <mbgl/style/conversion_impl.hpp>
 
+#include <vector>
+
 using namespace mbgl;
 using namespace mbgl::style;
 
+static const std::size_t batchSize = 1024;
+
+static std::vector<StubGeometryTileFeature> createFeatures() {
+    std::vector<StubGeometryTileFeature> features;
+    features.reserve(batchSize);
+    for (std::size_t i = 0; i < batchSize; i++) {
+        features.emplace_back(PropertyMap { { "x", static_cast<int64_t>(rand() % 100) } });
+    }
+    return features;
+}
+
 static std::string createFunctionJSON(size_t stopCount) {
     std::string stops = "[";
     for (size_t outerStop = 0; outerStop < stopCount; outerStop++) {
@@ -58,10 +71,60 @@ static void Evaluate_CompositeFunction(benchmark::State& state) {
     state.SetLabel(std::to_string(stopCount).c_str());
 }
 
+static void Evaluate_CompositeFunctionFeatures(benchmark::State& state) {
+    size_t stopCount = state.range(0);
+    auto doc = createFunctionJSON(stopCount);
+    conversion::Error error;
+    std::optional<PropertyValue<float>> function = conversion::convertJSON<PropertyValue<float>>(doc, error, true, false);
+    if (!function) {
+        state.SkipWithError(error.message.c_str());
+    }
+    const auto features = createFeatures();
+
+    while (state.KeepRunning()) {
+        float z = 24.0f * static_cast<float>(rand() % 100) / 100;
+        for (const auto& feature : features) {
+            benchmark::DoNotOptimize(function->asExpression().evaluate(expression::EvaluationContext(z, &feature), -1.0f));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.SetLabel(std::to_string(stopCount).c_str());
+}
+
+static void Evaluate_CompositeFunctionBatch(benchmark::State& state) {
+    size_t stopCount = state.range(0);
+    auto doc = createFunctionJSON(stopCount);
+    conversion::Error error;
+    std::optional<PropertyValue<float>> function = conversion::convertJSON<PropertyValue<float>>(doc, error, true, false);
+    if (!function) {
+        state.SkipWithError(error.message.c_str());
+    }
+    const auto features = createFeatures();
+    std::vector<const GeometryTileFeature*> pointers;
+    for (const auto& feature : features) {
+        pointers.push_back(&feature);
+    }
+    std::vector<float> results(batchSize);
+
+    while (state.KeepRunning()) {
+        float z = 24.0f * static_cast<float>(rand() % 100) / 100;
+        function->asExpression().evaluate(expression::EvaluationContext(z, nullptr), pointers.data(), batchSize, results.data(), -1.0f);
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.SetLabel(std::to_string(stopCount).c_str());
+}
+
 BENCHMARK(Parse_CompositeFunction)
     ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
 
 BENCHMARK(Evaluate_CompositeFunction)
     ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
 
+BENCHMARK(Evaluate_CompositeFunctionFeatures)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
 
+BENCHMARK(Evaluate_CompositeFunctionBatch)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
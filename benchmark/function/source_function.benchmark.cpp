@@ -5,10 +5,25 @@
 #include <mbgl/style/conversion/json.hpp>
 #include <mbgl/style/conversion/property_value.hpp>
 #include <mbgl/style/conversion_impl.hpp>
+#include <mbgl/programs/attributes.hpp>
+#include <mbgl/renderer/paint_property_binder.hpp>
+
+#include <vector>
 
 using namespace mbgl;
 using namespace mbgl::style;
 
+static const std::size_t batchSize = 1024;
+
+static std::vector<StubGeometryTileFeature> createFeatures() {
+    std::vector<StubGeometryTileFeature> features;
+    features.reserve(batchSize);
+    for (std::size_t i = 0; i < batchSize; i++) {
+        features.emplace_back(PropertyMap { { "x", static_cast<int64_t>(rand() % 100) } });
+    }
+    return features;
+}
+
 static std::string createFunctionJSON(size_t stopCount) {
     std::string stops = "[";
     for (size_t i = 0; i < stopCount; i++) {
@@ -52,10 +67,112 @@ static void Evaluate_SourceFunction(benchmark::State& state) {
     state.SetLabel(std::to_string(stopCount).c_str());
 }
 
+static void Evaluate_SourceFunctionFeatures(benchmark::State& state) {
+    size_t stopCount = state.range(0);
+    auto doc = createFunctionJSON(stopCount);
+    conversion::Error error;
+    std::optional<PropertyValue<float>> function = conversion::convertJSON<PropertyValue<float>>(doc, error, true, false);
+    if (!function) {
+        state.SkipWithError(error.message.c_str());
+    }
+    const auto features = createFeatures();
+
+    while (state.KeepRunning()) {
+        for (const auto& feature : features) {
+            benchmark::DoNotOptimize(function->asExpression().evaluate(expression::EvaluationContext(&feature), -1.0f));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.SetLabel(std::to_string(stopCount).c_str());
+}
+
+static void Evaluate_SourceFunctionBatch(benchmark::State& state) {
+    size_t stopCount = state.range(0);
+    auto doc = createFunctionJSON(stopCount);
+    conversion::Error error;
+    std::optional<PropertyValue<float>> function = conversion::convertJSON<PropertyValue<float>>(doc, error, true, false);
+    if (!function) {
+        state.SkipWithError(error.message.c_str());
+    }
+    const auto features = createFeatures();
+    std::vector<const GeometryTileFeature*> pointers;
+    for (const auto& feature : features) {
+        pointers.push_back(&feature);
+    }
+    std::vector<float> results(batchSize);
+
+    while (state.KeepRunning()) {
+        function->asExpression().evaluate(expression::EvaluationContext(), pointers.data(), batchSize, results.data(), -1.0f);
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.SetLabel(std::to_string(stopCount).c_str());
+}
+
+using RadiusBinder = PaintPropertyBinder<float, float, PossiblyEvaluatedPropertyValue<float>, attributes::radius::Type>;
+
+// Populates the vertices of a circle radius binder with four vertices per feature, either a
+// feature at a time or in one batch.
+static void populateSourceFunctionBinder(benchmark::State& state, bool batch) {
+    size_t stopCount = state.range(0);
+    auto doc = createFunctionJSON(stopCount);
+    conversion::Error error;
+    std::optional<PropertyValue<float>> function = conversion::convertJSON<PropertyValue<float>>(doc, error, true, false);
+    if (!function) {
+        state.SkipWithError(error.message.c_str());
+    }
+    const auto features = createFeatures();
+    std::vector<const GeometryTileFeature*> pointers;
+    std::vector<std::size_t> lengths;
+    std::vector<std::size_t> indices;
+    for (std::size_t i = 0; i < batchSize; i++) {
+        pointers.push_back(&features[i]);
+        lengths.push_back((i + 1) * 4);
+        indices.push_back(i);
+    }
+    const CanonicalTileID canonical(0, 0, 0);
+    const PossiblyEvaluatedPropertyValue<float> value(function->asExpression());
+
+    while (state.KeepRunning()) {
+        auto binder = RadiusBinder::create(value, 0.0f, -1.0f);
+        if (batch) {
+            binder->populateVertexVectors(pointers.data(), lengths.data(), indices.data(), batchSize, canonical);
+        } else {
+            for (std::size_t i = 0; i < batchSize; i++) {
+                binder->populateVertexVector(features[i], lengths[i], indices[i], {}, {}, canonical, {});
+            }
+        }
+        benchmark::DoNotOptimize(binder);
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.SetLabel(std::to_string(stopCount).c_str());
+}
+
+static void Populate_SourceFunctionFeatures(benchmark::State& state) {
+    populateSourceFunctionBinder(state, false);
+}
+
+static void Populate_SourceFunctionBatch(benchmark::State& state) {
+    populateSourceFunctionBinder(state, true);
+}
+
 BENCHMARK(Parse_SourceFunction)
     ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
 
 BENCHMARK(Evaluate_SourceFunction)
     ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
 
+BENCHMARK(Evaluate_SourceFunctionFeatures)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
+
+BENCHMARK(Evaluate_SourceFunctionBatch)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
 
+BENCHMARK(Populate_SourceFunctionFeatures)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
+
+BENCHMARK(Populate_SourceFunctionBatch)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(6)->Arg(8)->Arg(10)->Arg(12);
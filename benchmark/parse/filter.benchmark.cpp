@@ -1,5 +1,6 @@
 #include <benchmark/benchmark.h>
 
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/style/filter.hpp>
 #include <mbgl/style/conversion/json.hpp>
 #include <mbgl/style/conversion/filter.hpp>
@@ -30,5 +31,41 @@ static void Parse_EvaluateFilter(benchmark::State& state) {
     }
 }
 
+static void Parse_EvaluateCompiledFilter(benchmark::State& state) {
+    const style::CompiledFilter filter(parse(R"FILTER(["==", "foo", "bar"])FILTER"));
+    const StubGeometryTileFeature feature = { {}, FeatureType::Unknown , {},  {{ "foo", std::string("bar") }} };
+    const style::expression::EvaluationContext context(&feature);
+
+    while (state.KeepRunning()) {
+        filter(context);
+    }
+}
+
+static const char* multiClauseFilter =
+    R"FILTER(["all", ["==", "class", "motorway"], ["!=", "$type", "Point"], ["in", "rank", 1, 2, 3], ["!", ["has", "tunnel"]]])FILTER";
+
+static void Parse_EvaluateMultiClauseFilter(benchmark::State& state) {
+    const style::Filter filter = parse(multiClauseFilter);
+    const StubGeometryTileFeature feature = { {}, FeatureType::LineString, {}, {{ "class", std::string("motorway") }, { "rank", uint64_t(3) }} };
+    const style::expression::EvaluationContext context(&feature);
+
+    while (state.KeepRunning()) {
+        filter(context);
+    }
+}
+
+static void Parse_EvaluateMultiClauseCompiledFilter(benchmark::State& state) {
+    const style::CompiledFilter filter(parse(multiClauseFilter));
+    const StubGeometryTileFeature feature = { {}, FeatureType::LineString, {}, {{ "class", std::string("motorway") }, { "rank", uint64_t(3) }} };
+    const style::expression::EvaluationContext context(&feature);
+
+    while (state.KeepRunning()) {
+        filter(context);
+    }
+}
+
 BENCHMARK(Parse_Filter);
 BENCHMARK(Parse_EvaluateFilter);
+BENCHMARK(Parse_EvaluateCompiledFilter);
+BENCHMARK(Parse_EvaluateMultiClauseFilter);
+BENCHMARK(Parse_EvaluateMultiClauseCompiledFilter);
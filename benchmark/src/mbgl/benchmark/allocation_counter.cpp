@@ -0,0 +1,71 @@
+#include <mbgl/benchmark/allocation_counter.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef MBGL_BENCHMARK_COUNT_ALLOCATIONS
+
+namespace {
+
+std::atomic<std::size_t> allocationCount{0};
+std::atomic<std::size_t> allocatedByteCount{0};
+
+void* allocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedByteCount.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+// The array and nothrow forms of the operators call these ones.
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+#endif
+
+namespace mbgl {
+
+AllocationCounter::AllocationCounter() : startAllocations(allocations()), startAllocatedBytes(allocatedBytes()) {}
+
+void AllocationCounter::report(::benchmark::State& state) const {
+#ifdef MBGL_BENCHMARK_COUNT_ALLOCATIONS
+    state.counters["allocations"] =
+        ::benchmark::Counter(static_cast<double>(allocations() - startAllocations), ::benchmark::Counter::kAvgIterations);
+    state.counters["allocated_bytes"] = ::benchmark::Counter(static_cast<double>(allocatedBytes() - startAllocatedBytes),
+                                                             ::benchmark::Counter::kAvgIterations);
+#else
+    (void)state;
+#endif
+}
+
+std::size_t AllocationCounter::allocations() {
+#ifdef MBGL_BENCHMARK_COUNT_ALLOCATIONS
+    return allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+std::size_t AllocationCounter::allocatedBytes() {
+#ifdef MBGL_BENCHMARK_COUNT_ALLOCATIONS
+    return allocatedByteCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+} // namespace mbgl
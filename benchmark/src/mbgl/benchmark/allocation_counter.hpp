@@ -0,0 +1,28 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+namespace mbgl {
+
+// Counts the allocations made through the global operator new, on all threads. Counting replaces
+// the operator for the whole benchmark runner, so it is only compiled in with the
+// MBGL_WITH_ALLOCATION_COUNTING option; otherwise nothing is counted or reported.
+class AllocationCounter {
+public:
+    AllocationCounter();
+
+    // Sets the "allocations" and "allocated_bytes" counters of the benchmark to the averages per
+    // iteration since the construction of this object, when counting is compiled in.
+    void report(::benchmark::State&) const;
+
+    static std::size_t allocations();
+    static std::size_t allocatedBytes();
+
+private:
+    const std::size_t startAllocations;
+    const std::size_t startAllocatedBytes;
+};
+
+} // namespace mbgl
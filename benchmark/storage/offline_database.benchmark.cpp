@@ -1,11 +1,13 @@
 #include <benchmark/benchmark.h>
 
+#include <mbgl/benchmark/allocation_counter.hpp>
 #include <mbgl/storage/offline_database.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/storage/sqlite3.hpp>
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/logging.hpp>
+#include <mbgl/util/io.hpp>
 
 #include <random>
 
@@ -125,12 +127,73 @@ BENCHMARK_F(OfflineDatabase, GetTile)(benchmark::State& state) {
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dis(0, tileCount - 1);
 
+    AllocationCounter allocations;
     while (state.KeepRunning()) {
         auto res = db.get(Resource::tile("mapbox://tile_ambient" + util::toString(dis(gen)), 1, 0, 0, 0, Tileset::Scheme::XYZ));
         assert(res != std::nullopt);
     }
+    allocations.report(state);
 }
 
+// Reads from a database file, where reads and the batched accessed timestamp writes go
+// through the WAL. Compare with GetTileFromFileReadOnly, which writes nothing at all.
+// The tiles are random, and stored without compression, so the counters show the cost of
+// moving the data out of the database.
+static void getTilesFromFile(benchmark::State& state, bool readOnly) {
+    using namespace mbgl;
+    using namespace std::chrono_literals;
+
+    const std::string path = "benchmark/fixtures/api/offline_database.db";
+    const unsigned tileCount = 100;
+    util::deleteFile(path);
+    util::deleteFile(path + "-wal");
+    util::deleteFile(path + "-shm");
+
+    {
+        mbgl::OfflineDatabase db(path, TileServerOptions::DefaultConfiguration());
+
+        std::mt19937 random(0);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::string data(50 * 1024, 0);
+        for (auto& c : data) {
+            c = static_cast<char>(byte(random));
+        }
+
+        Response response;
+        response.data = std::make_shared<std::string>(std::move(data));
+        response.expires = util::now() + 1h;
+
+        for (unsigned i = 0; i < tileCount; ++i) {
+            db.put(Resource::tile("mapbox://tile_file" + util::toString(i), 1, 0, 0, 0, Tileset::Scheme::XYZ), response);
+        }
+
+        db.reopenDatabaseReadOnly(readOnly);
+
+        std::mt19937 gen(0);
+        std::uniform_int_distribution<> dis(0, tileCount - 1);
+
+        AllocationCounter allocations;
+        while (state.KeepRunning()) {
+            auto res = db.get(Resource::tile("mapbox://tile_file" + util::toString(dis(gen)), 1, 0, 0, 0, Tileset::Scheme::XYZ));
+            assert(res != std::nullopt);
+        }
+        allocations.report(state);
+    }
+
+    util::deleteFile(path);
+}
+
+static void OfflineDatabase_GetTileFromFile(benchmark::State& state) {
+    getTilesFromFile(state, false);
+}
+
+static void OfflineDatabase_GetTileFromFileReadOnly(benchmark::State& state) {
+    getTilesFromFile(state, true);
+}
+
+BENCHMARK(OfflineDatabase_GetTileFromFile);
+BENCHMARK(OfflineDatabase_GetTileFromFileReadOnly);
+
 BENCHMARK_F(OfflineDatabase, AddTilesToFullDatabase)(benchmark::State& state) {
     using namespace mbgl;
 
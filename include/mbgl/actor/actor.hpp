@@ -65,6 +65,9 @@ public:
         return parent.self();
     }
 
+    /// Sets the priority with which messages to this actor are scheduled.
+    void setPriority(TaskPriority priority) { parent.mailbox->setPriority(priority); }
+
 private:
     std::shared_ptr<Scheduler> retainer;
     AspiringActor<Object> parent;
@@ -1,15 +1,17 @@
 #pragma once
 
+#include <mbgl/actor/scheduler.hpp>
+#include <mbgl/util/mpsc_queue.hpp>
+
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 
 #include <mapbox/std/weak.hpp>
 
 namespace mbgl {
 
-class Scheduler;
 class Message;
 
 class Mailbox : public std::enable_shared_from_this<Mailbox> {
@@ -31,6 +33,11 @@ public:
 
     bool isOpen() const;
 
+    /// Sets the priority with which this mailbox asks its scheduler to process
+    /// messages. It applies the next time the mailbox is scheduled.
+    void setPriority(TaskPriority);
+    TaskPriority getPriority() const;
+
     void push(std::unique_ptr<Message>);
     void receive();
 
@@ -38,15 +45,24 @@ public:
     static std::function<void()> makeClosure(std::weak_ptr<Mailbox>);
 
 private:
+    void scheduleReceive();
+
+    // Written once, by the constructor or by open() before `opened` is set.
     mapbox::base::WeakPtr<Scheduler> weakScheduler;
+    std::atomic<bool> opened{false};
+    // Serializes open() with the pushes to a holding mailbox.
+    std::mutex openingMutex;
 
     std::recursive_mutex receivingMutex;
-    std::mutex pushingMutex;
 
-    bool closed { false };
+    std::atomic<bool> closed{false};
+    std::atomic<TaskPriority> priority{TaskPriority::Default};
 
-    std::mutex queueMutex;
-    std::queue<std::unique_ptr<Message>> queue;
+    // Pushing the first message into an empty queue schedules a receive(), which keeps
+    // rescheduling itself until the queue is drained. The count is kept separately because
+    // a message may already be counted before the queue makes it visible to the consumer.
+    std::atomic<std::size_t> queueSize{0};
+    util::MPSCQueue<std::unique_ptr<Message>> queue;
 };
 
 } // namespace mbgl
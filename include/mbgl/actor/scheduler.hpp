@@ -4,6 +4,7 @@
 
 #include <mapbox/std/weak.hpp>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -11,6 +12,15 @@ namespace mbgl {
 
 class Mailbox;
 
+/// Relative urgency of the work handed to a `Scheduler`. Schedulers supporting
+/// priorities run pending work of a higher priority first; work of the same
+/// priority keeps its submission order.
+enum class TaskPriority : uint8_t {
+    High,    ///< Work the user is waiting for, e.g. parsing tiles in the viewport.
+    Default, ///< Everything not explicitly prioritized.
+    Low,     ///< Speculative work, e.g. parsing prefetched or cached tiles.
+};
+
 /**
     A `Scheduler` is responsible for coordinating the processing of messages by
     one or more actors via their mailboxes. It's an abstract interface. Currently,
@@ -39,6 +49,9 @@ public:
 
     /// Enqueues a function for execution.
     virtual void schedule(std::function<void()>) = 0;
+    /// Enqueues a function for execution with the given priority. Schedulers
+    /// without priority support treat it as a regular `schedule()` call.
+    virtual void scheduleWithPriority(TaskPriority, std::function<void()> fn) { schedule(std::move(fn)); }
     /// Makes a weak pointer to this Scheduler.
     virtual mapbox::base::WeakPtr<Scheduler> makeWeakPtr() = 0;
 
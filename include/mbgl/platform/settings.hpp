@@ -15,6 +15,14 @@ DECLARE_MAPBOX_SETTING(EXPERIMENTAL_THREAD_PRIORITY_FILE, thread_priority_file);
 DECLARE_MAPBOX_SETTING(EXPERIMENTAL_THREAD_PRIORITY_NETWORK, thread_priority_network);
 DECLARE_MAPBOX_SETTING(EXPERIMENTAL_THREAD_PRIORITY_DATABASE, thread_priority_database);
 
+// The value for EXPERIMENTAL_THREAD_POOL_SIZE, must be an unsigned integer. It is read when
+// the shared worker pool is created; zero or a missing value means one thread per core.
+DECLARE_MAPBOX_SETTING(EXPERIMENTAL_THREAD_POOL_SIZE, thread_pool_size);
+
+// The value for EXPERIMENTAL_PARALLEL_TILE_PARSING, must be a boolean. When set, the layer
+// groups of a vector tile that don't need glyphs are parsed concurrently on the worker pool.
+DECLARE_MAPBOX_SETTING(EXPERIMENTAL_PARALLEL_TILE_PARSING, parallel_tile_parsing);
+
 /// Settings class provides non-persistent, in-process key-value storage.
 class Settings final {
 public:
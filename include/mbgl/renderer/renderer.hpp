@@ -40,6 +40,16 @@ struct PlacedSymbolData {
     std::string layer;
 };
 
+struct TileParseStatistics {
+    /// Number of tile parses started by the tile workers
+    uint64_t parsesStarted = 0;
+    /// Number of tile parses abandoned because the tile became obsolete
+    uint64_t parsesCancelled = 0;
+    /// Wall-clock time spent on abandoned tile parses, in milliseconds. Includes the time the
+    /// worker threads were preempted, so it is an upper bound of the CPU time wasted.
+    double wastedParseWallTime = 0;
+};
+
 class Renderer {
 public:
     Renderer(gfx::RendererBackend&, float pixelRatio_, const std::optional<std::string>& localFontFamily = std::nullopt);
@@ -101,6 +111,13 @@ public:
      */
     const std::vector<PlacedSymbolData>& getPlacedSymbolsData() const;
 
+    /**
+     * @brief Returns the statistics of the tile parses performed for this renderer
+     * since it was created, e.g. how much parsing work was thrown away because the
+     * tiles became obsolete before the parse finished.
+     */
+    TileParseStatistics getTileParseStatistics() const;
+
     // Memory
     void reduceMemoryUse();
     void clearData();
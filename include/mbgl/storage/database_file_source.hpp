@@ -18,6 +18,7 @@ public:
     /// FileSource overrides
     std::unique_ptr<AsyncRequest> request(const Resource&, Callback) override;
     void forward(const Resource&, const Response&, std::function<void()> callback) override;
+    void markAccessed(const Resource&) override;
     bool canRequest(const Resource&) const override;
     void setProperty(const std::string&, const mapbox::base::Value&) override;
     void pause() override;
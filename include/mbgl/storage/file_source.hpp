@@ -25,6 +25,7 @@ enum FileSourceType : uint8_t {
     FileSystem,
     Network,
     Mbtiles,
+    Pmtiles,
     ResourceLoader ///< %Resource loader acts as a proxy and has logic
     /// for request delegation to Asset, Cache, and other
     /// file sources.
@@ -53,6 +54,10 @@ public:
     // NOLINTNEXTLINE(performance-unnecessary-value-param)
     virtual void forward(const Resource&, const Response&, std::function<void()>) {}
 
+    /// Notifies the source that a resource it stores was served from a cache in front of it,
+    /// so that it can keep track of the resources in use, e.g. for least recently used eviction.
+    virtual void markAccessed(const Resource&) {}
+
     /// When a file source supports consulting a local cache only, it must return true.
     /// Cache-only requests are requests that aren't as urgent, but could be useful, e.g.
     /// to cover part of the map while loading. The FileSource should only do cheap actions to
@@ -110,6 +115,36 @@ constexpr const char* API_BASE_URL_KEY = "api-base-url";
 /// type: unsigned
 constexpr const char* MAX_CONCURRENT_REQUESTS_KEY = "max-concurrent-requests";
 
+/// Property name to set / get maximum number of concurrent requests to a single host, on top of
+/// the overall maximum. 0 means that there is no limit per host.
+/// type: unsigned
+constexpr const char* MAX_CONCURRENT_REQUESTS_PER_HOST_KEY = "max-concurrent-requests-per-host";
+
+/// Property name to set / get whether requests prefer HTTP/2 and share a multiplexed connection
+/// per host. Raise the maximum number of concurrent requests to make use of it.
+/// type: bool
+constexpr const char* HTTP2_MULTIPLEXING_KEY = "http2-multiplexing";
+
+/// Property name to get the counters of the completed requests: "requests", "http2-requests",
+/// "connections-opened", "connections-reused", "tls-handshakes", "bytes-sent" and
+/// "bytes-received".
+/// type: mapbox::base::ValueObject of unsigned
+constexpr const char* HTTP_METRICS_KEY = "http-metrics";
+
+// Properties that may be supported by resource loaders:
+
+/// Property name to set / get the maximum size, in bytes, of the in-memory cache of fresh style,
+/// source, glyph, sprite and image responses that is shared by the resource loaders of the process.
+/// The size is a process-wide setting: setting it through any resource loader resizes the cache
+/// for all of them, and the responses of all scopes count against the same size.
+/// type: unsigned
+constexpr const char* RESPONSE_CACHE_SIZE_KEY = "response-cache-size";
+
+/// Property name to get the counters of the in-memory response cache: "hits", "misses", "entries"
+/// and "size".
+/// type: mapbox::base::ValueObject of unsigned
+constexpr const char* RESPONSE_CACHE_STATISTICS_KEY = "response-cache-statistics";
+
 // Properties that may be supported by database file sources:
 
 /// Property to set database mode. When set, database opens in read-only mode; database opens in read-write-create mode
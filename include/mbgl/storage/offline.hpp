@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mbgl/util/chrono.hpp>
 #include <mbgl/util/geo.hpp>
 #include <mbgl/util/geometry.hpp>
 #include <mbgl/util/range.hpp>
@@ -156,6 +157,20 @@ public:
      */
     bool requiredResourceCountIsPrecise = false;
 
+    /**
+     * Throughput of an active download since it was activated: the number of tiles and
+     * bytes received from the network per second. Resources found in the database don't
+     * count towards them.
+     */
+    double downloadedTilesPerSecond = 0;
+    double downloadedBytesPerSecond = 0;
+
+    /**
+     * The average time an active download spent writing a batch of downloaded resources
+     * to the database.
+     */
+    Duration averageCommitDuration = Duration::zero();
+
     bool complete() const {
         return completedResourceCount >= requiredResourceCount;
     }
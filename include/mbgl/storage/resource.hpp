@@ -64,6 +64,7 @@ public:
     }
 
     void setPriority(Priority p) { priority = p; }
+    void setRank(double r) { rank = r; }
     void setUsage(Usage u) { usage = u; }
 
     bool hasLoadingMethod(LoadingMethod method) const;
@@ -88,6 +89,9 @@ public:
     LoadingMethod loadingMethod;
     Usage usage{ Usage::Online };
     Priority priority{ Priority::Regular };
+    // Orders the requests of the same priority that wait for the network: lower ranks are sent
+    // first. For tiles, the renderer sets it from their distance to the viewport.
+    double rank = 0;
     std::string url;
 
     // Includes auxiliary data if this is a tile request.
@@ -31,6 +31,8 @@ public:
     bool mustRevalidate = false;
 
     // The actual data of the response. Present only for non-error, non-notModified responses.
+    // Always the complete, decoded body: file sources buffer it, and parsing starts once it has
+    // arrived. There is no streaming mode.
     std::shared_ptr<const std::string> data;
 
     std::optional<Timestamp> modified;
@@ -18,9 +18,14 @@ public:
     static ParseResult parse(const mbgl::style::conversion::Convertible& value, ParsingContext& ctx);
 
     EvaluationResult evaluate(const EvaluationContext& params) const override;
+    void evaluateNumbers(const EvaluationContext& params,
+                         const GeometryTileFeature* const* features,
+                         std::size_t count,
+                         double* values,
+                         bool* valid) const override;
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
     
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
 
     std::vector<std::optional<Value>> possibleOutputs() const override;
     
@@ -16,15 +16,14 @@ class Case : public Expression {
 public:
     using Branch = std::pair<std::unique_ptr<Expression>, std::unique_ptr<Expression>>;
 
-    Case(type::Type type_, std::vector<Branch> branches_, std::unique_ptr<Expression> otherwise_)
-        : Expression(Kind::Case, std::move(type_)), branches(std::move(branches_)), otherwise(std::move(otherwise_)) {}
+    Case(type::Type type_, std::vector<Branch> branches_, std::unique_ptr<Expression> otherwise_);
 
     static ParseResult parse(const mbgl::style::conversion::Convertible& value, ParsingContext& ctx);
 
     EvaluationResult evaluate(const EvaluationContext& params) const override;
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
     
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
 
     std::vector<std::optional<Value>> possibleOutputs() const override;
 
@@ -32,6 +31,11 @@ public:
 private:
     std::vector<Branch> branches;
     std::unique_ptr<Expression> otherwise;
+
+    // The branches whose test isn't a literal `false`, up to the first one whose test is a
+    // literal `true`; that branch's output, or `otherwise`, is the fallback.
+    std::vector<const Branch*> liveBranches;
+    const Expression* fallback;
 };
 
 } // namespace expression
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <map>
+#include <vector>
 
 namespace mbgl {
 namespace style {
@@ -14,10 +15,7 @@ namespace expression {
 class Coalesce : public Expression {
 public:
     using Args = std::vector<std::unique_ptr<Expression>>;
-    Coalesce(const type::Type& type_, Args args_) :
-        Expression(Kind::Coalesce, type_),
-        args(std::move(args_))
-    {}
+    Coalesce(const type::Type& type_, Args args_);
 
     static ParseResult parse(const mbgl::style::conversion::Convertible& value, ParsingContext& ctx);
 
@@ -26,7 +24,7 @@ public:
     
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
 
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
 
     std::vector<std::optional<Value>> possibleOutputs() const override;
 
@@ -41,6 +39,10 @@ public:
     std::string getOperator() const override { return "coalesce"; }
 private:
     Args args;
+
+    // The arguments that are evaluated: literal nulls are skipped, and the arguments after the
+    // first literal that isn't null are never reached.
+    std::vector<const Expression*> liveArgs;
 };
 
 } // namespace expression
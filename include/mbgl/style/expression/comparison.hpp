@@ -23,7 +23,7 @@ public:
         std::unique_ptr<Expression> rhs);
 
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
-    bool operator==(const Expression&) const override;
+    bool equals(const Expression&) const override;
     EvaluationResult evaluate(const EvaluationContext&) const override;
     std::vector<std::optional<Value>> possibleOutputs() const override;
     std::string getOperator() const override;
@@ -47,7 +47,7 @@ public:
         std::unique_ptr<Expression> collator);
 
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
-    bool operator==(const Expression&) const override;
+    bool equals(const Expression&) const override;
     EvaluationResult evaluate(const EvaluationContext&) const override;
     std::vector<std::optional<Value>> possibleOutputs() const override;
     std::string getOperator() const override;
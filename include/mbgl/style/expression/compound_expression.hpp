@@ -35,7 +35,7 @@ public:
     EvaluationResult evaluate(const EvaluationContext& evaluationParams) const override;
     std::vector<std::optional<Value>> possibleOutputs() const override;
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
 
     std::optional<std::size_t> getParameterCount() const;
 
@@ -16,7 +16,7 @@ public:
 
     void eachChild(const std::function<void(const Expression&)>&) const override {}
 
-    bool operator==(const Expression& e) const override {
+    bool equals(const Expression& e) const override {
         return e.getKind() == Kind::Error;
     }
 
@@ -8,6 +8,7 @@
 #include <mbgl/util/variant.hpp>
 
 #include <array>
+#include <cstddef>
 #include <vector>
 #include <memory>
 #include <optional>
@@ -173,7 +174,8 @@ enum class Kind : int32_t {
     ImageExpression,
     In,
     Within,
-    Distance
+    Distance,
+    SharedSubexpression
 };
 
 class Expression {
@@ -183,10 +185,13 @@ public:
     
     virtual EvaluationResult evaluate(const EvaluationContext& params) const = 0;
     virtual void eachChild(const std::function<void(const Expression&)>&) const = 0;
-    virtual bool operator==(const Expression&) const = 0;
+    // Compares the expressions, looking through the SharedSubexpression wrappers on either side.
+    bool operator==(const Expression&) const;
     bool operator!=(const Expression& rhs) const {
         return !operator==(rhs);
     }
+    // Compares with an expression that isn't wrapped; only called by operator==.
+    virtual bool equals(const Expression&) const = 0;
 
     Kind getKind() const { return kind; };
     type::Type getType() const { return type; };
@@ -203,6 +208,22 @@ public:
                               const CanonicalTileID& canonical) const;
     EvaluationResult evaluate(std::optional<mbgl::Value> accumulated, const Feature& feature) const;
 
+    /**
+     * Evaluates the expression for each of `count` features, each of which takes the place of
+     * the feature of `params`, and writes the results to `values`. `valid[i]` is set to false
+     * where the evaluation fails or doesn't produce a number; otherwise `values[i]` is the
+     * number evaluate() would return for that feature.
+     *
+     * The default implementation evaluates the features one at a time; expressions that
+     * commonly produce numbers for data-driven properties (literals, interpolate, step, match)
+     * evaluate the whole batch in tight loops instead, without boxing each intermediate result.
+     */
+    virtual void evaluateNumbers(const EvaluationContext& params,
+                                 const GeometryTileFeature* const* features,
+                                 std::size_t count,
+                                 double* values,
+                                 bool* valid) const;
+
     /**
      * Statically analyze the expression, attempting to enumerate possible outputs. Returns
      * an array of values plus the sentinel null optional value, used to indicate that the
@@ -222,6 +243,15 @@ public:
     virtual std::string getOperator() const = 0;
 
 protected:
+    // Evaluates `outputs[i]` for each feature i, in batches of the features that share an
+    // output. Features without an output (nullptr) are marked invalid.
+    static void evaluateSelectedNumbers(const EvaluationContext& params,
+                                        const GeometryTileFeature* const* features,
+                                        std::size_t count,
+                                        const Expression* const* outputs,
+                                        double* values,
+                                        bool* valid);
+
     template <typename T>
     static bool childrenEqual(const T& lhs, const T& rhs) {
         if (lhs.size() != rhs.size()) return false;
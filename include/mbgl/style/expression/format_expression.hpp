@@ -32,7 +32,7 @@ public:
     
     void eachChild(const std::function<void(const Expression&)>&) const override;
     
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
     
     std::vector<std::optional<Value>> possibleOutputs() const override {
         // Technically the combinatoric set of all children
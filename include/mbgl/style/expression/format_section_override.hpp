@@ -39,7 +39,7 @@ public:
                            [] (const T&) {});
     }
 
-    bool operator==(const Expression& e) const final {
+    bool equals(const Expression& e) const final {
         if (e.getKind() == Kind::FormatSectionOverride) {
             const auto* other = static_cast<const FormatSectionOverride*>(&e);
 
@@ -3,6 +3,7 @@
 #include <mbgl/style/conversion.hpp>
 #include <mbgl/style/expression/expression.hpp>
 #include <memory>
+#include <optional>
 
 namespace mbgl {
 namespace style {
@@ -17,15 +18,20 @@ public:
     EvaluationResult evaluate(const EvaluationContext& params) const override;
     void eachChild(const std::function<void(const Expression&)>&) const override;
 
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
 
     std::vector<std::optional<Value>> possibleOutputs() const override;
 
     std::string getOperator() const override;
 
 private:
+    EvaluationResult search(const Value& haystackValue, const EvaluationContext& params) const;
+
     std::unique_ptr<Expression> needle;
     std::unique_ptr<Expression> haystack;
+    // The value of a literal haystack, which is searched in place instead of being copied for
+    // every evaluation.
+    std::optional<Value> constantHaystack;
 };
 
 } // namespace expression
@@ -51,7 +51,7 @@ public:
         );
     }
 
-    bool operator==(const Expression& e) const override {
+    bool equals(const Expression& e) const override {
         if (e.getKind() == Kind::Interpolate) {
             auto rhs = static_cast<const Interpolate*>(&e);
             if (interpolator != rhs->interpolator ||
@@ -66,6 +66,12 @@ public:
         return false;
     }
 
+    void evaluateNumbers(const EvaluationContext& params,
+                         const GeometryTileFeature* const* features,
+                         std::size_t count,
+                         double* values,
+                         bool* valid) const override;
+
     std::vector<std::optional<Value>> possibleOutputs() const override;
     mbgl::Value serialize() const override;
     std::string getOperator() const override { return "interpolate"; }
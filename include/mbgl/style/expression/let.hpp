@@ -27,7 +27,7 @@ public:
     EvaluationResult evaluate(const EvaluationContext& params) const override;
     void eachChild(const std::function<void(const Expression&)>&) const override;
 
-    bool operator==(const Expression& e) const override {
+    bool equals(const Expression& e) const override {
         if (e.getKind() == Kind::Let) {
             auto rhs = static_cast<const Let*>(&e);
             return *result == *(rhs->result);
@@ -58,7 +58,7 @@ public:
     EvaluationResult evaluate(const EvaluationContext& params) const override;
     void eachChild(const std::function<void(const Expression&)>&) const override;
 
-    bool operator==(const Expression& e) const override {
+    bool equals(const Expression& e) const override {
         if (e.getKind() == Kind::Var) {
             auto rhs = static_cast<const Var*>(&e);
             return *value == *(rhs->value);
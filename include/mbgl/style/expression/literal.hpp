@@ -4,6 +4,7 @@
 #include <mbgl/style/expression/parsing_context.hpp>
 #include <mbgl/style/conversion.hpp>
 
+#include <algorithm>
 #include <memory>
 
 namespace mbgl {
@@ -20,12 +21,22 @@ public:
     EvaluationResult evaluate(const EvaluationContext&) const override {
         return value;
     }
+
+    void evaluateNumbers(const EvaluationContext&,
+                         const GeometryTileFeature* const*,
+                         std::size_t count,
+                         double* values,
+                         bool* valid) const override {
+        const bool isNumber = value.is<double>();
+        std::fill(values, values + count, isNumber ? value.get<double>() : 0.0);
+        std::fill(valid, valid + count, isNumber);
+    }
     
     static ParseResult parse(const mbgl::style::conversion::Convertible&, ParsingContext&);
 
     void eachChild(const std::function<void(const Expression&)>&) const override {}
     
-    bool operator==(const Expression& e) const override {
+    bool equals(const Expression& e) const override {
         if (e.getKind() == Kind::Literal) {
             auto rhs = static_cast<const Literal*>(&e);
             return value == rhs->value;
@@ -26,15 +26,24 @@ public:
 
     EvaluationResult evaluate(const EvaluationContext& params) const override;
 
+    void evaluateNumbers(const EvaluationContext& params,
+                         const GeometryTileFeature* const* features,
+                         std::size_t count,
+                         double* values,
+                         bool* valid) const override;
+
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
 
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
 
     std::vector<std::optional<Value>> possibleOutputs() const override;
     
     mbgl::Value serialize() const override;
     std::string getOperator() const override { return "match"; }
 private:
+    // Returns the output selected by the given input value.
+    const Expression& findOutput(const Value& inputValue) const;
+
     std::unique_ptr<Expression> input;
     Branches branches;
     std::unique_ptr<Expression> otherwise;
@@ -21,13 +21,18 @@ public:
          std::map<double, std::unique_ptr<Expression>> stops_);
 
     EvaluationResult evaluate(const EvaluationContext& params) const override;
+    void evaluateNumbers(const EvaluationContext& params,
+                         const GeometryTileFeature* const* features,
+                         std::size_t count,
+                         double* values,
+                         bool* valid) const override;
     void eachChild(const std::function<void(const Expression&)>& visit) const override;
     void eachStop(const std::function<void(double, const Expression&)>& visit) const;
 
     const std::unique_ptr<Expression>& getInput() const { return input; }
     Range<float> getCoveringStops(double lower, double upper) const;
 
-    bool operator==(const Expression& e) const override;
+    bool equals(const Expression& e) const override;
 
     std::vector<std::optional<Value>> possibleOutputs() const override;
 
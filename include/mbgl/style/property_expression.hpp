@@ -7,7 +7,10 @@
 #include <mbgl/style/expression/find_zoom_curve.hpp>
 #include <mbgl/util/range.hpp>
 
+#include <memory>
 #include <optional>
+#include <type_traits>
+#include <vector>
 
 namespace mbgl {
 namespace style {
@@ -125,6 +128,17 @@ public:
         return evaluate(expression::EvaluationContext(zoom, &feature, &state), finalDefaultValue);
     }
 
+    // Evaluates the expression for each of `count` features, each of which takes the place of
+    // the feature of `context`. The results are the same as the ones of evaluate(), but
+    // numeric expressions are evaluated for the whole batch at once.
+    void evaluate(const expression::EvaluationContext& context,
+                  const GeometryTileFeature* const* features,
+                  std::size_t count,
+                  T* results,
+                  T finalDefaultValue = T()) const {
+        evaluateBatch(context, features, count, results, finalDefaultValue, std::is_same<T, float>());
+    }
+
     std::vector<std::optional<T>> possibleOutputs() const {
         return expression::fromExpressionValues<T>(expression->possibleOutputs());
     }
@@ -135,6 +149,35 @@ public:
     }
 
 private:
+    void evaluateBatch(const expression::EvaluationContext& context,
+                       const GeometryTileFeature* const* features,
+                       std::size_t count,
+                       T* results,
+                       T finalDefaultValue,
+                       std::true_type /* numeric */) const {
+        std::vector<double> values(count);
+        std::unique_ptr<bool[]> valid = std::make_unique<bool[]>(count);
+        expression->evaluateNumbers(context, features, count, values.data(), valid.get());
+
+        const T fallback = defaultValue ? *defaultValue : finalDefaultValue;
+        for (std::size_t i = 0; i < count; ++i) {
+            results[i] = valid[i] ? static_cast<T>(values[i]) : fallback;
+        }
+    }
+
+    void evaluateBatch(const expression::EvaluationContext& context,
+                       const GeometryTileFeature* const* features,
+                       std::size_t count,
+                       T* results,
+                       T finalDefaultValue,
+                       std::false_type /* numeric */) const {
+        expression::EvaluationContext featureContext = context;
+        for (std::size_t i = 0; i < count; ++i) {
+            featureContext.feature = features[i];
+            results[i] = evaluate(featureContext, finalDefaultValue);
+        }
+    }
+
     std::optional<T> defaultValue;
 };
 
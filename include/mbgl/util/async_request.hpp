@@ -7,6 +7,10 @@ namespace mbgl {
 class AsyncRequest : private util::noncopyable {
 public:
     virtual ~AsyncRequest() = default;
+
+    // Updates the rank of the requested resource, see Resource::rank. Requests that don't
+    // wait in a queue ignore it.
+    virtual void setRank(double) {}
 };
 
 } // namespace mbgl
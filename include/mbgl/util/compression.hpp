@@ -10,5 +10,11 @@ enum CompressionFormat { ZLIB = 15, GZIP = 15 + 16, DEFLATE = -15, DETECT = 15 +
 std::string compress(const std::string& raw, int windowBits = CompressionFormat::ZLIB);
 std::string decompress(const std::string& raw, int windowBits = CompressionFormat::DETECT);
 
+// Same as compress() and decompress() in the zlib format, with a preset dictionary: bytes that are
+// likely to occur in the input, which makes small inputs compress much better. The data can only
+// be decompressed with the same dictionary.
+std::string compressWithDictionary(const std::string& raw, const std::string& dictionary);
+std::string decompressWithDictionary(const std::string& raw, const std::string& dictionary);
+
 } // namespace util
 } // namespace mbgl
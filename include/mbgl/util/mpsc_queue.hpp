@@ -0,0 +1,73 @@
+#pragma once
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <atomic>
+#include <utility>
+
+namespace mbgl {
+namespace util {
+
+/**
+ * @brief MPSCQueue is an unbounded, lock-free multi-producer/single-consumer FIFO queue
+ *
+ * push() may be called concurrently from any number of threads; pop() must only be called
+ * from one thread at a time. Producers link a new node with a single atomic exchange, and
+ * the consumer never has to synchronize with them beyond reading the link.
+ *
+ * A producer publishes its node in two steps, so pop() may briefly report an empty queue
+ * while a push() that started earlier is still in progress. Callers that need an exact
+ * element count have to keep it themselves.
+ *
+ * T must be default constructible and movable.
+ */
+template <class T>
+class MPSCQueue : private util::noncopyable {
+public:
+    MPSCQueue() : head(new Node), tail(head.load(std::memory_order_relaxed)) {}
+
+    ~MPSCQueue() {
+        while (Node* node = tail) {
+            tail = node->next.load(std::memory_order_relaxed);
+            delete node;
+        }
+    }
+
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /// Moves the oldest element into `value` and returns true, or returns false if there is
+    /// no element available yet.
+    bool pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+
+        // `next` becomes the new sentinel node; its value is handed out.
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(T value_) : value(std::move(value_)) {}
+
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    // Most recently pushed node; written by producers.
+    std::atomic<Node*> head;
+    // Sentinel preceding the oldest element; owned by the consumer.
+    Node* tail;
+};
+
+} // namespace util
+} // namespace mbgl
@@ -207,6 +207,15 @@ std::unique_ptr<AsyncRequest> HTTPFileSource::request(const Resource& resource,
     return std::make_unique<HTTPRequest>(*impl->env, resource, callback);
 }
 
+// Requests go through OkHttp, which negotiates HTTP/2 and multiplexes requests on its own.
+void HTTPFileSource::setProperty(const std::string& key, const mapbox::base::Value& value) {
+    FileSource::setProperty(key, value);
+}
+
+mapbox::base::Value HTTPFileSource::getProperty(const std::string& key) const {
+    return FileSource::getProperty(key);
+}
+
 void HTTPFileSource::setResourceOptions(ResourceOptions options) {
     impl->setResourceOptions(options.clone());
 }
@@ -13,6 +13,13 @@ HTTPFileSource::HTTPFileSource(const ResourceOptions& /*resourceOptions*/, const
 
 HTTPFileSource::~HTTPFileSource() = default;
 
+void HTTPFileSource::setProperty(const std::string&, const mapbox::base::Value&) {
+}
+
+mapbox::base::Value HTTPFileSource::getProperty(const std::string&) const {
+    return {};
+}
+
 void HTTPFileSource::setResourceOptions(ResourceOptions /*options*/) {
 }
 
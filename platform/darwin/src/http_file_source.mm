@@ -409,6 +409,15 @@ std::unique_ptr<AsyncRequest> HTTPFileSource::request(const Resource& resource,
     return std::move(request);
 }
 
+// NSURLSession negotiates HTTP/2 and multiplexes requests on its own.
+void HTTPFileSource::setProperty(const std::string& key, const mapbox::base::Value& value) {
+    FileSource::setProperty(key, value);
+}
+
+mapbox::base::Value HTTPFileSource::getProperty(const std::string& key) const {
+    return FileSource::getProperty(key);
+}
+
 void HTTPFileSource::setResourceOptions(ResourceOptions options) {
     impl->setResourceOptions(options.clone());
 }
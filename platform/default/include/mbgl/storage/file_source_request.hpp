@@ -17,6 +17,8 @@ public:
     ~FileSourceRequest() final;
 
     void onCancel(std::function<void()>&& callback);
+    void onSetRank(std::function<void(double)>&& callback);
+    void setRank(double) final;
     void setResponse(const Response& res);
 
     ActorRef<FileSourceRequest> actor();
@@ -24,6 +26,7 @@ public:
 private:
     FileSource::Callback responseCallback = nullptr;
     std::function<void()> cancelCallback = nullptr;
+    std::function<void(double)> setRankCallback = nullptr;
 
     std::shared_ptr<Mailbox> mailbox;
 };
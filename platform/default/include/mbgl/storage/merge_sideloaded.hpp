@@ -1,7 +1,7 @@
 #pragma once
 
 // THIS IS A GENERATED FILE; EDIT merge_sideloaded.sql INSTEAD
-// To regenerate, run `node platform/default/mbgl/storage/merge_sideloaded.js`
+// To regenerate, run `node platform/default/include/mbgl/storage/merge_sideloaded.js`
 
 namespace mbgl {
 
@@ -16,11 +16,12 @@ static constexpr const char* mergeSideloadedDatabaseSQL =
 "      r.id AS main_region_id\n"
 "    FROM side.regions sr\n"
 "    JOIN regions r ON sr.definition = r.definition  AND sr.description IS r.description;\n"
-"REPLACE INTO tiles\n"
+"REPLACE INTO tiles (id, url_template, pixel_ratio, z, x, y, expires, modified, etag, data, compressed, accessed, must_revalidate, ambient)\n"
 "    SELECT t.id,\n"
 "        st.url_template, st.pixel_ratio, st.z, st.x, st.y,\n"
-"        st.expires, st.modified, st.etag, st.data, st.compressed, st.accessed, st.must_revalidate\n"
-"    FROM (SELECT DISTINCT sti.* FROM side.region_tiles srt JOIN side.tiles sti ON srt.tile_id = sti.id)\n"
+"        st.expires, st.modified, st.etag, st.data, st.compressed, st.accessed, st.must_revalidate,\n"
+"        IFNULL(t.ambient, 1)\n"
+"    FROM (SELECT DISTINCT sti.* FROM side.region_tiles srt JOIN side_tiles sti ON srt.tile_id = sti.id)\n"
 "    AS st\n"
 "    LEFT JOIN tiles t ON st.url_template = t.url_template AND st.pixel_ratio = t.pixel_ratio AND st.z = t.z AND st.x = t.x AND st.y = t.y\n"
 "        WHERE t.id IS NULL\n"
@@ -32,10 +33,11 @@ static constexpr const char* mergeSideloadedDatabaseSQL =
 "    JOIN (SELECT t.id, st.id AS side_tile_id FROM side.tiles st\n"
 "            JOIN tiles t ON st.url_template = t.url_template AND st.pixel_ratio = t.pixel_ratio AND st.z = t.z AND st.x = t.x AND st.y = t.y\n"
 "    ) AS sti ON srt.tile_id = sti.side_tile_id;\n"
-"REPLACE INTO resources\n"
+"REPLACE INTO resources (id, url, kind, expires, modified, etag, data, compressed, accessed, must_revalidate, ambient)\n"
 "    SELECT r.id, \n"
 "        sr.url, sr.kind, sr.expires, sr.modified, sr.etag,\n"
-"        sr.data, sr.compressed, sr.accessed, sr.must_revalidate\n"
+"        sr.data, sr.compressed, sr.accessed, sr.must_revalidate,\n"
+"        IFNULL(r.ambient, 1)\n"
 "    FROM side.region_resources srr JOIN side.resources sr ON srr.resource_id = sr.id\n"
 "    LEFT JOIN resources r ON sr.url = r.url\n"
 "        WHERE r.id IS NULL\n"
@@ -11,11 +11,12 @@ CREATE TEMPORARY TABLE region_mapping AS
     JOIN regions r ON sr.definition = r.definition  AND sr.description IS r.description;
 
 --Insert /Update tiles
-REPLACE INTO tiles
+REPLACE INTO tiles (id, url_template, pixel_ratio, z, x, y, expires, modified, etag, data, compressed, accessed, must_revalidate, ambient)
     SELECT t.id, -- use the old ID in case we run a REPLACE. If it doesn't exist yet, it'll be NULL which will auto-assign a new ID.
         st.url_template, st.pixel_ratio, st.z, st.x, st.y,
-        st.expires, st.modified, st.etag, st.data, st.compressed, st.accessed, st.must_revalidate
-    FROM (SELECT DISTINCT sti.* FROM side.region_tiles srt JOIN side.tiles sti ON srt.tile_id = sti.id)   -- ensure that we're only considering region tiles, and not ambient tiles.
+        st.expires, st.modified, st.etag, st.data, st.compressed, st.accessed, st.must_revalidate,
+        IFNULL(t.ambient, 1) -- new tiles become region tiles when inserted into region_tiles below.
+    FROM (SELECT DISTINCT sti.* FROM side.region_tiles srt JOIN side_tiles sti ON srt.tile_id = sti.id)   -- ensure that we're only considering region tiles, and not ambient tiles. side_tiles resolves the tile contents of the side database.
     AS st
     LEFT JOIN tiles t ON st.url_template = t.url_template AND st.pixel_ratio = t.pixel_ratio AND st.z = t.z AND st.x = t.x AND st.y = t.y
         WHERE t.id IS NULL -- only consider tiles that don't exist yet in the original database.
@@ -31,10 +32,11 @@ INSERT OR IGNORE INTO region_tiles
     ) AS sti ON srt.tile_id = sti.side_tile_id;
 
 -- copy over resources
-REPLACE INTO resources
+REPLACE INTO resources (id, url, kind, expires, modified, etag, data, compressed, accessed, must_revalidate, ambient)
     SELECT r.id, 
         sr.url, sr.kind, sr.expires, sr.modified, sr.etag,
-        sr.data, sr.compressed, sr.accessed, sr.must_revalidate
+        sr.data, sr.compressed, sr.accessed, sr.must_revalidate,
+        IFNULL(r.ambient, 1) -- new resources become region resources when inserted into region_resources below.
     FROM side.region_resources srr JOIN side.resources sr ON srr.resource_id = sr.id   --only consider region resources, and not ambient resources.
     LEFT JOIN resources r ON sr.url = r.url
         WHERE r.id IS NULL -- only consider resources that don't exist yet in the main database
@@ -3,16 +3,19 @@
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/offline.hpp>
 #include <mbgl/util/tile_server_options.hpp>
+#include <mbgl/util/chrono.hpp>
 #include <mbgl/util/exception.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/mapbox.hpp>
 #include <mbgl/util/expected.hpp>
 
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
 #include <optional>
+#include <vector>
 
 namespace mapbox {
 namespace sqlite {
@@ -27,6 +30,7 @@ namespace mbgl {
 
 class Response;
 class TileID;
+class CanonicalTileID;
 
 namespace util {
 struct IOException;
@@ -38,17 +42,48 @@ struct MapboxTileLimitExceededException :  util::Exception {
 
 class OfflineDatabase {
 public:
-    OfflineDatabase(std::string path, const TileServerOptions& options);
+    enum class Access {
+        // Creates, migrates and, when it is corrupt or incompatible, removes the database file.
+        Owner,
+        // Reads a database file owned by another connection, and only writes the accessed
+        // timestamps of its reads. Fails to open files that its owner hasn't created or migrated
+        // yet, and closes the connection instead of removing the file.
+        Reader,
+    };
+
+    OfflineDatabase(std::string path, const TileServerOptions& options, Access = Access::Owner);
     ~OfflineDatabase();
 
+    // Sets a function called before the database file is removed, once this connection is
+    // closed, so that the other connections to the file can be closed first.
+    void setRemovalCallback(std::function<void()> callback) { removalCallback = std::move(callback); }
+
+    // Returns whether the connection is open. Closed connections are reopened by the next
+    // operation.
+    bool isOpen() const { return db != nullptr; }
+
     void changePath(const std::string&);
     std::exception_ptr resetDatabase();
 
     std::optional<Response> get(const Resource&);
 
+    // Updates the accessed timestamp of a stored resource that was served from elsewhere, e.g.
+    // an in-memory cache in front of the database, so that it isn't evicted as if unused.
+    void markAccessed(const Resource&);
+
+    // Looks up tiles of one tileset with a query per zoom level instead of a query per tile.
+    // The result holds the responses in the order of the tile IDs, and nullopt for the tiles
+    // that aren't in the database.
+    std::vector<std::optional<Response>> getTiles(const std::string& urlTemplate,
+                                                  uint8_t pixelRatio,
+                                                  const std::vector<CanonicalTileID>&);
+
     // Return value is (inserted, stored size)
     std::pair<bool, uint64_t> put(const Resource&, const Response&);
 
+    // Stores the given resources in the ambient cache in a single transaction.
+    void putResources(const std::list<std::tuple<Resource, Response>>&);
+
     // Force Mapbox GL Native to revalidate tiles stored in the ambient
     // cache with the tile server before using them, making sure they
     // are the latest version. This is more efficient than cleaning the
@@ -84,6 +119,16 @@ public:
     expected<OfflineRegionStatus, std::exception_ptr> getRegionCompletedStatus(int64_t regionID);
 
     std::exception_ptr setMaximumAmbientCacheSize(uint64_t);
+
+    // Inserts into a full ambient cache only evict for a short while. When that was not enough
+    // to bring the cache back under its maximum size, isEvictionPending() is true and the rest
+    // is evicted by calls to evictAmbientCache(), each taking about the given time.
+    // Return value is true iff more entries remain to be evicted.
+    bool evictAmbientCache(Duration budget);
+    bool isEvictionPending() const { return evictionPending; }
+    // Sets the time an insert may spend evicting, 5 ms by default.
+    void setInsertEvictionBudget(Duration budget) { insertEvictionBudget = budget; }
+
     void setOfflineMapboxTileCountLimit(uint64_t);
     uint64_t getOfflineMapboxTileCountLimit();
     bool offlineMapboxTileCountLimitExceeded();
@@ -95,6 +140,15 @@ public:
 
     void reopenDatabaseReadOnly(bool readOnly);
 
+    // How the data of a row is encoded, as stored in the `compressed` column.
+    enum class Codec : int64_t {
+        None = 0,
+        Zlib = 1,
+        // zlib with version 1 of the preset dictionary of strings common in vector tiles. Since
+        // schema version 8. Later dictionary versions get codec values of their own.
+        ZlibTileDictionaryV1 = 2,
+    };
+
 private:
     class DatabaseSizeChangeStats;
 
@@ -110,6 +164,9 @@ private:
     void migrateToVersion5();
     void migrateToVersion3();
     void migrateToVersion6();
+    void migrateToVersion7();
+    void migrateToVersion8();
+    void migrateToVersion9();
     void cleanup();
     bool disabled();
     void vacuum();
@@ -118,17 +175,32 @@ private:
     mapbox::sqlite::Statement& getStatement(const char *);
 
     std::optional<std::pair<Response, uint64_t>> getTile(const Resource::TileData&);
+    // Reads the response of a tile from the first columns of a query on the tiles table.
+    std::pair<Response, uint64_t> readTile(mapbox::sqlite::Query&);
     std::optional<int64_t> hasTile(const Resource::TileData&);
-    bool putTile(const Resource::TileData&, const Response&,
-                 const std::string&, bool compressed);
+    // Writes a tile whose contents, if any, are stored in the tile_data row `dataID`.
+    bool putTile(const Resource::TileData&, const Response&, std::optional<int64_t> dataID);
+    // Returns the tile_data row holding the given contents, looked up by their hash, and the
+    // size of the row as stored.
+    std::optional<std::pair<int64_t, uint64_t>> findTileData(int64_t hash, const std::string& data);
+    bool hasTileData(int64_t dataID);
+    int64_t putTileData(int64_t hash, const std::string& data, Codec);
 
     std::optional<std::pair<Response, uint64_t>> getResource(const Resource&);
     std::optional<int64_t> hasResource(const Resource&);
     bool putResource(const Resource&, const Response&,
-                     const std::string&, bool compressed);
+                     const std::string&, Codec);
 
     uint64_t putRegionResourceInternal(int64_t regionID, const Resource&, const Response&);
 
+    // Accessed timestamps of the rows read since the last flush are kept in memory, and
+    // written in a single transaction when enough of them are pending, before eviction,
+    // and when the database is closed.
+    void recordAccess(std::map<int64_t, Timestamp>&, int64_t id);
+    bool accessedTimestampsPending() const;
+    void flushAccessedTimestamps();
+    void writeAccessedTimestamps();
+
     std::optional<std::pair<Response, uint64_t>> getInternal(const Resource&);
     std::optional<int64_t> hasInternal(const Resource&);
     std::pair<bool, uint64_t> putInternal(const Resource&, const Response&, bool evict);
@@ -143,6 +215,11 @@ private:
     std::unique_ptr<mapbox::sqlite::Database> db;
     std::map<const char*, const std::unique_ptr<mapbox::sqlite::Statement>> statements;
 
+    // Pending accessed timestamps, by row id.
+    std::map<int64_t, Timestamp> accessedTiles;
+    std::map<int64_t, Timestamp> accessedResources;
+    Timestamp firstAccess;
+
     template <class T>
     T getPragma(const char *);
 
@@ -151,7 +228,12 @@ private:
 
     std::optional<uint64_t> offlineMapboxTileCount;
 
-    bool evict(uint64_t neededFreeSize, DatabaseSizeChangeStats& stats);
+    // Evicts the least recently used ambient entries, until there is room for neededFreeSize
+    // bytes or the budget is spent, in which case evictionPending is set.
+    bool evict(uint64_t neededFreeSize, DatabaseSizeChangeStats& stats, Duration budget = Duration::max());
+    bool evictionPending = false;
+    // Time an insert may spend evicting entries from a full ambient cache.
+    Duration insertEvictionBudget = Milliseconds(5);
 
     TileServerOptions tileServerOptions;
 
@@ -186,6 +268,8 @@ private:
 
     bool autopack = true;
     bool readOnly = false;
+    const Access access;
+    std::function<void()> removalCallback;
 };
 
 } // namespace mbgl
@@ -3,11 +3,14 @@
 #include <mbgl/storage/file_source.hpp>
 #include <mbgl/storage/offline.hpp>
 #include <mbgl/storage/resource.hpp>
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/timer.hpp>
 
 #include <list>
 #include <unordered_set>
 #include <memory>
 #include <deque>
+#include <optional>
 
 namespace mbgl {
 
@@ -41,6 +44,7 @@ private:
     void continueDownload();
     void deactivateDownload();
     bool flushResourcesBuffer();
+    void updateThroughput();
 
     /*
      * Ensure that the resource is stored in the database, requesting it if necessary.
@@ -62,10 +66,27 @@ private:
     std::set<std::string> requiredSourceURLs;
     std::deque<Resource> resourcesRemaining;
     std::list<Resource> resourcesToBeMarkedAsUsed;
+    // Downloaded resources are written in batches, once enough of them are buffered or when
+    // the first one has waited for the batch interval.
     std::list<std::tuple<Resource, Response>> buffer;
+    util::Timer bufferTimer;
+
+    // Tiles are enumerated as they are requested, one tileset after the other, instead of
+    // being queued as resources up front.
+    class TileStream;
+    std::deque<std::unique_ptr<TileStream>> tilesRemaining;
+
+    // Throughput since the download was activated.
+    TimePoint activationTime;
+    uint64_t downloadedTileCount = 0;
+    uint64_t downloadedSize = 0;
+    Duration commitDuration = Duration::zero();
+    uint64_t commitCount = 0;
 
     void queueResource(Resource&&);
     void queueTiles(style::SourceType, uint16_t tileSize, const Tileset&);
+    bool hasRemainingResources() const;
+    std::optional<Resource> nextResource();
     void markPendingUsedResources();
 };
 
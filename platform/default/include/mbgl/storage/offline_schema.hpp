@@ -17,8 +17,16 @@ static constexpr const char* offlineDatabaseSchema =
 "  compressed INTEGER NOT NULL DEFAULT 0,\n"
 "  accessed INTEGER NOT NULL,\n"
 "  must_revalidate INTEGER NOT NULL DEFAULT 0,\n"
+"  ambient INTEGER NOT NULL DEFAULT 1,\n"
 "  UNIQUE (url)\n"
 ");\n"
+"CREATE TABLE tile_data (\n"
+"  id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,\n"
+"  hash INTEGER NOT NULL,\n"
+"  data BLOB NOT NULL,\n"
+"  compressed INTEGER NOT NULL DEFAULT 0,\n"
+"  refcount INTEGER NOT NULL DEFAULT 0\n"
+");\n"
 "CREATE TABLE tiles (\n"
 "  id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,\n"
 "  url_template TEXT NOT NULL,\n"
@@ -33,6 +41,8 @@ static constexpr const char* offlineDatabaseSchema =
 "  compressed INTEGER NOT NULL DEFAULT 0,\n"
 "  accessed INTEGER NOT NULL,\n"
 "  must_revalidate INTEGER NOT NULL DEFAULT 0,\n"
+"  ambient INTEGER NOT NULL DEFAULT 1,\n"
+"  data_id INTEGER REFERENCES tile_data(id),\n"
 "  UNIQUE (url_template, pixel_ratio, z, x, y)\n"
 ");\n"
 "CREATE TABLE regions (\n"
@@ -50,14 +60,59 @@ static constexpr const char* offlineDatabaseSchema =
 "  tile_id INTEGER NOT NULL REFERENCES tiles(id),\n"
 "  UNIQUE (region_id, tile_id)\n"
 ");\n"
-"CREATE INDEX resources_accessed\n"
-"ON resources (accessed);\n"
-"CREATE INDEX tiles_accessed\n"
-"ON tiles (accessed);\n"
+"CREATE INDEX resources_ambient_accessed\n"
+"ON resources (ambient, accessed);\n"
+"CREATE INDEX tiles_ambient_accessed\n"
+"ON tiles (ambient, accessed);\n"
 "CREATE INDEX region_resources_resource_id\n"
 "ON region_resources (resource_id);\n"
 "CREATE INDEX region_tiles_tile_id\n"
 "ON region_tiles (tile_id);\n"
+"CREATE INDEX tile_data_hash\n"
+"ON tile_data (hash);\n"
+"CREATE TRIGGER region_resources_insert\n"
+"AFTER INSERT ON region_resources\n"
+"BEGIN\n"
+"  UPDATE resources SET ambient = 0 WHERE id = NEW.resource_id;\n"
+"END;\n"
+"CREATE TRIGGER region_resources_delete\n"
+"AFTER DELETE ON region_resources\n"
+"WHEN NOT EXISTS (SELECT 1 FROM region_resources WHERE resource_id = OLD.resource_id)\n"
+"BEGIN\n"
+"  UPDATE resources SET ambient = 1 WHERE id = OLD.resource_id;\n"
+"END;\n"
+"CREATE TRIGGER region_tiles_insert\n"
+"AFTER INSERT ON region_tiles\n"
+"BEGIN\n"
+"  UPDATE tiles SET ambient = 0 WHERE id = NEW.tile_id;\n"
+"END;\n"
+"CREATE TRIGGER region_tiles_delete\n"
+"AFTER DELETE ON region_tiles\n"
+"WHEN NOT EXISTS (SELECT 1 FROM region_tiles WHERE tile_id = OLD.tile_id)\n"
+"BEGIN\n"
+"  UPDATE tiles SET ambient = 1 WHERE id = OLD.tile_id;\n"
+"END;\n"
+"CREATE TRIGGER tiles_data_insert\n"
+"AFTER INSERT ON tiles\n"
+"WHEN NEW.data_id IS NOT NULL\n"
+"BEGIN\n"
+"  UPDATE tile_data SET refcount = refcount + 1 WHERE id = NEW.data_id;\n"
+"END;\n"
+"CREATE TRIGGER tiles_data_update\n"
+"AFTER UPDATE OF data_id ON tiles\n"
+"WHEN OLD.data_id IS NOT NEW.data_id\n"
+"BEGIN\n"
+"  UPDATE tile_data SET refcount = refcount + 1 WHERE id = NEW.data_id;\n"
+"  UPDATE tile_data SET refcount = refcount - 1 WHERE id = OLD.data_id;\n"
+"  DELETE FROM tile_data WHERE id = OLD.data_id AND refcount <= 0;\n"
+"END;\n"
+"CREATE TRIGGER tiles_data_delete\n"
+"AFTER DELETE ON tiles\n"
+"WHEN OLD.data_id IS NOT NULL\n"
+"BEGIN\n"
+"  UPDATE tile_data SET refcount = refcount - 1 WHERE id = OLD.data_id;\n"
+"  DELETE FROM tile_data WHERE id = OLD.data_id AND refcount <= 0;\n"
+"END;\n"
 ;
 
 } // namespace mbgl
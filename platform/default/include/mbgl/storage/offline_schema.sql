@@ -29,19 +29,42 @@ CREATE TABLE resources (
 
   data BLOB,                                       -- Contents of the resource.
 
-  compressed INTEGER NOT NULL DEFAULT 0,           -- If the resource is compressed with Deflate or not. Compression is
-                                                   -- optional and should be used when the compression ratio is
-                                                   -- significant. Using compression will make decoding time slower
-                                                   -- because it will add an extra decompression step.
+  compressed INTEGER NOT NULL DEFAULT 0,           -- How the resource is encoded, see OfflineDatabase::Codec:
+                                                   -- not compressed = 0
+                                                   -- zlib           = 1
+                                                   -- zlib with the vector tile dictionary = 2
+                                                   -- Compression is optional and only used when the compression
+                                                   -- ratio is significant, because decoding takes an extra step.
 
   accessed INTEGER NOT NULL,                       -- Last time the resource was used by GL Native. Useful for when
                                                    -- evicting the least used resources from the cache.
 
   must_revalidate INTEGER NOT NULL DEFAULT 0,      -- When set to true, the resource will not be used unless it gets
                                                    -- first revalidated by the server.
+
+  ambient INTEGER NOT NULL DEFAULT 1,              -- Whether the resource is part of the ambient cache, i.e. not used by
+                                                   -- any region. Maintained by the triggers on region_resources below.
   UNIQUE (url)
 );
 
+--
+-- Table containing the contents of tiles. Tiles with identical contents, like
+-- ocean or empty land tiles, share a single row.
+--
+CREATE TABLE tile_data (
+  id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,   -- Primary key.
+
+  hash INTEGER NOT NULL,                           -- 64-bit FNV-1a hash of the uncompressed contents. Not unique, the
+                                                   -- contents are compared before a row is shared.
+
+  data BLOB NOT NULL,                              -- Contents of the tile.
+
+  compressed INTEGER NOT NULL DEFAULT 0,           -- How the contents are encoded, see the tiles table below.
+
+  refcount INTEGER NOT NULL DEFAULT 0              -- Number of tiles using this row. Maintained by the triggers on
+                                                   -- tiles below, the row is deleted when it drops to zero.
+);
+
 --
 -- Table containing all tiles, both vector and raster.
 --
@@ -72,18 +95,28 @@ CREATE TABLE tiles (
                                                    -- get re-downloaded. See:
                                                    -- https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/ETag
 
-  data BLOB,                                       -- Contents of the tile.
+  data BLOB,                                       -- Contents of the tile, as written by versions older than 9.
+                                                   -- Newer rows refer to tile_data instead. NULL in both places
+                                                   -- means the tile has no content.
 
-  compressed INTEGER NOT NULL DEFAULT 0,           -- If the tile is compressed with Deflate or not. Compression is
-                                                   -- optional and should be used when the compression ratio is
-                                                   -- significant. Using compression will make decoding time slower
-                                                   -- because it will add an extra decompression step.
+  compressed INTEGER NOT NULL DEFAULT 0,           -- How the tile is encoded, see OfflineDatabase::Codec:
+                                                   -- not compressed = 0
+                                                   -- zlib           = 1
+                                                   -- zlib with the vector tile dictionary = 2
+                                                   -- Compression is optional and only used when the compression
+                                                   -- ratio is significant, because decoding takes an extra step.
 
   accessed INTEGER NOT NULL,                       -- Last time the tile was used by GL Native. Useful for when
                                                    -- evicting the least used tiles from the cache.
 
   must_revalidate INTEGER NOT NULL DEFAULT 0,      -- When set to true, the tile will not be used unless it gets
                                                    -- first revalidated by the server.
+
+  ambient INTEGER NOT NULL DEFAULT 1,              -- Whether the tile is part of the ambient cache, i.e. not used by
+                                                   -- any region. Maintained by the triggers on region_tiles below.
+
+  data_id INTEGER REFERENCES tile_data(id),        -- Contents of the tile, shared with the tiles that have the same
+                                                   -- contents.
   UNIQUE (url_template, pixel_ratio, z, x, y)
 );
 
@@ -149,17 +182,83 @@ CREATE TABLE region_tiles (
 );
 
 --
--- Indexes for efficient eviction queries.
+-- Indexes for efficient eviction queries. Eviction walks the ambient
+-- entries in the order they were accessed.
 --
 
-CREATE INDEX resources_accessed
-ON resources (accessed);
+CREATE INDEX resources_ambient_accessed
+ON resources (ambient, accessed);
 
-CREATE INDEX tiles_accessed
-ON tiles (accessed);
+CREATE INDEX tiles_ambient_accessed
+ON tiles (ambient, accessed);
 
 CREATE INDEX region_resources_resource_id
 ON region_resources (resource_id);
 
 CREATE INDEX region_tiles_tile_id
 ON region_tiles (tile_id);
+
+CREATE INDEX tile_data_hash
+ON tile_data (hash);
+
+--
+-- Triggers keeping the ambient flag of resources and tiles up to date.
+-- Deleting a region deletes its rows in region_resources and region_tiles,
+-- which runs the delete triggers.
+--
+
+CREATE TRIGGER region_resources_insert
+AFTER INSERT ON region_resources
+BEGIN
+  UPDATE resources SET ambient = 0 WHERE id = NEW.resource_id;
+END;
+
+CREATE TRIGGER region_resources_delete
+AFTER DELETE ON region_resources
+WHEN NOT EXISTS (SELECT 1 FROM region_resources WHERE resource_id = OLD.resource_id)
+BEGIN
+  UPDATE resources SET ambient = 1 WHERE id = OLD.resource_id;
+END;
+
+CREATE TRIGGER region_tiles_insert
+AFTER INSERT ON region_tiles
+BEGIN
+  UPDATE tiles SET ambient = 0 WHERE id = NEW.tile_id;
+END;
+
+CREATE TRIGGER region_tiles_delete
+AFTER DELETE ON region_tiles
+WHEN NOT EXISTS (SELECT 1 FROM region_tiles WHERE tile_id = OLD.tile_id)
+BEGIN
+  UPDATE tiles SET ambient = 1 WHERE id = OLD.tile_id;
+END;
+
+--
+-- Triggers keeping the reference counts of tile_data up to date. Tile data
+-- is deleted along with the last tile using it, whether the tile is evicted,
+-- deleted with its region or replaced.
+--
+
+CREATE TRIGGER tiles_data_insert
+AFTER INSERT ON tiles
+WHEN NEW.data_id IS NOT NULL
+BEGIN
+  UPDATE tile_data SET refcount = refcount + 1 WHERE id = NEW.data_id;
+END;
+
+CREATE TRIGGER tiles_data_update
+AFTER UPDATE OF data_id ON tiles
+WHEN OLD.data_id IS NOT NEW.data_id
+BEGIN
+  UPDATE tile_data SET refcount = refcount + 1 WHERE id = NEW.data_id;
+  UPDATE tile_data SET refcount = refcount - 1 WHERE id = OLD.data_id;
+  DELETE FROM tile_data WHERE id = OLD.data_id AND refcount <= 0;
+END;
+
+CREATE TRIGGER tiles_data_delete
+AFTER DELETE ON tiles
+WHEN OLD.data_id IS NOT NULL
+BEGIN
+  UPDATE tile_data SET refcount = refcount - 1 WHERE id = OLD.data_id;
+  DELETE FROM tile_data WHERE id = OLD.data_id AND refcount <= 0;
+END;
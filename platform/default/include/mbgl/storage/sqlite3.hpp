@@ -12,6 +12,7 @@ namespace sqlite {
 
 enum OpenFlag : int {
     ReadOnly        = 0b001,
+    ReadWrite       = 0b010,
     ReadWriteCreate = 0b110,
 };
 
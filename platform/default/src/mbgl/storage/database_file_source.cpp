@@ -6,92 +6,269 @@
 #include <mbgl/storage/offline_download.hpp>
 #include <mbgl/storage/resource_options.hpp>
 #include <mbgl/storage/response.hpp>
+#include <mbgl/storage/response_cache.hpp>
+#include <mbgl/tile/tile_id.hpp>
+#include <mbgl/util/chrono.hpp>
 #include <mbgl/util/client_options.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/logging.hpp>
 #include <mbgl/util/platform.hpp>
 #include <mbgl/util/thread.hpp>
+#include <mbgl/util/timer.hpp>
 
+#include <atomic>
+#include <list>
 #include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace mbgl {
+
+namespace {
+
+// Number of threads serving cache reads when the database is a file.
+constexpr std::size_t readerCount = 2;
+
+// Puts are written in a single transaction once this many are pending, or when the
+// first pending put has waited for the batch interval.
+constexpr std::size_t putBatchSize = 64;
+constexpr Milliseconds putBatchInterval{20};
+
+// When inserts leave the ambient cache over its maximum size, the rest of the eviction is
+// done in slices of this length, with room for other requests in between.
+constexpr Milliseconds evictionBudget{10};
+constexpr Milliseconds evictionInterval{50};
+
+// In-memory databases are private to their connection, so only the writer can read them.
+bool isSharedDatabasePath(const std::string& path) {
+    return !path.empty() && path != ":memory:" && path.rfind("file::memory:", 0) == std::string::npos &&
+           path.find("mode=memory") == std::string::npos;
+}
+
+// URLs of the responses forwarded to the writer thread and not written yet. The readers can't
+// see these, so reads of them are served by the writer, which writes its pending puts first.
+class PendingPutURLs {
+public:
+    void add(const std::string& url) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++urls[url];
+    }
+
+    void remove(const std::string& url) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = urls.find(url);
+        if (it != urls.end() && --it->second == 0) {
+            urls.erase(it);
+        }
+    }
+
+    bool contains(const std::string& url) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return urls.find(url) != urls.end();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::size_t> urls;
+};
+
+void respond(std::optional<Response> offlineResponse, const ActorRef<FileSourceRequest>& req) {
+    if (!offlineResponse) {
+        offlineResponse.emplace();
+        offlineResponse->noContent = true;
+        offlineResponse->error =
+            std::make_unique<Response::Error>(Response::Error::Reason::NotFound, "Not found in offline database");
+    } else if (!offlineResponse->isUsable()) {
+        offlineResponse->error =
+            std::make_unique<Response::Error>(Response::Error::Reason::NotFound, "Cached resource is unusable");
+    }
+    req.invoke(&FileSourceRequest::setResponse, *offlineResponse);
+}
+
+void respond(OfflineDatabase* db, const Resource& resource, const ActorRef<FileSourceRequest>& req) {
+    respond((db && resource.storagePolicy != Resource::StoragePolicy::Volatile) ? db->get(resource) : std::nullopt,
+            req);
+}
+
+} // namespace
+
+// Serves cache reads on a database connection of its own, so that reads don't queue behind
+// writes. The connection is opened and closed by DatabaseFileSourceThread, which owns the
+// database and is the only one to write to it, besides the accessed timestamps of reads. The
+// writer waits for the readers to close their connections before it removes, moves or reopens
+// the database.
+//
+// Tile requests are collected until the reader gets to the requests queued behind them, and
+// the tiles of each tileset are then read together, as the tiles of a cover are requested in
+// a burst.
+class DatabaseFileSourceReader {
+public:
+    DatabaseFileSourceReader(const ActorRef<DatabaseFileSourceReader>& self_, TileServerOptions tileServerOptions_)
+        : self(self_),
+          tileServerOptions(std::move(tileServerOptions_)) {}
+
+    void request(const Resource& resource, const ActorRef<FileSourceRequest>& req) {
+        if (!db || resource.kind != Resource::Kind::Tile || !resource.tileData ||
+            resource.storagePolicy == Resource::StoragePolicy::Volatile) {
+            respond(db.get(), resource, req);
+            return;
+        }
+        if (pendingTiles.empty()) {
+            self.invoke(&DatabaseFileSourceReader::respondToTiles);
+        }
+        pendingTiles.emplace_back(*resource.tileData, req);
+    }
+
+    void respondToTiles() {
+        auto tiles = std::move(pendingTiles);
+        pendingTiles.clear();
+
+        std::map<std::pair<std::string, uint8_t>, std::vector<std::size_t>> tilesets;
+        for (std::size_t i = 0; i < tiles.size(); ++i) {
+            const auto& tile = tiles[i].first;
+            tilesets[{tile.urlTemplate, tile.pixelRatio}].push_back(i);
+        }
+
+        for (const auto& tileset : tilesets) {
+            std::vector<CanonicalTileID> tileIDs;
+            tileIDs.reserve(tileset.second.size());
+            for (std::size_t i : tileset.second) {
+                const auto& tile = tiles[i].first;
+                tileIDs.emplace_back(tile.z, tile.x, tile.y);
+            }
+
+            auto responses = db ? db->getTiles(tileset.first.first, tileset.first.second, tileIDs)
+                                : std::vector<std::optional<Response>>(tileIDs.size());
+            for (std::size_t j = 0; j < responses.size(); ++j) {
+                respond(std::move(responses[j]), tiles[tileset.second[j]].second);
+            }
+        }
+    }
+
+    // Opens the given database as a reader, which never creates, migrates or removes it.
+    void open(const std::string& path) {
+        close();
+        db = std::make_unique<OfflineDatabase>(path, tileServerOptions, OfflineDatabase::Access::Reader);
+    }
+
+    // Answers the pending tile requests and closes the connection.
+    void close() {
+        respondToTiles();
+        db.reset();
+    }
+
+private:
+    const ActorRef<DatabaseFileSourceReader> self;
+    const TileServerOptions tileServerOptions;
+    std::unique_ptr<OfflineDatabase> db;
+    std::vector<std::pair<Resource::TileData, ActorRef<FileSourceRequest>>> pendingTiles;
+};
+
 class DatabaseFileSourceThread {
 public:
-    DatabaseFileSourceThread(std::shared_ptr<FileSource> onlineFileSource_, const std::string& cachePath)
+    DatabaseFileSourceThread(std::shared_ptr<FileSource> onlineFileSource_,
+                             const std::string& cachePath,
+                             std::vector<ActorRef<DatabaseFileSourceReader>> readers_,
+                             std::shared_ptr<std::atomic<bool>> readersEnabled_,
+                             std::shared_ptr<PendingPutURLs> pendingPutURLs_)
         : db(std::make_unique<OfflineDatabase>(
             cachePath,
             onlineFileSource_->getResourceOptions().tileServerOptions())
-        ), onlineFileSource(std::move(onlineFileSource_)) {}
+        ), onlineFileSource(std::move(onlineFileSource_)),
+          readers(std::move(readers_)),
+          readersEnabled(std::move(readersEnabled_)),
+          pendingPutURLs(std::move(pendingPutURLs_)),
+          path(cachePath) {
+        db->setRemovalCallback([this] {
+            closeReaders();
+            readersRemoved = true;
+        });
+        openReaders();
+    }
+
+    ~DatabaseFileSourceThread() { writePendingPuts(); }
 
     void request(const Resource& resource, const ActorRef<FileSourceRequest>& req) {
-        std::optional<Response> offlineResponse =
-            (resource.storagePolicy != Resource::StoragePolicy::Volatile) ? db->get(resource) : std::nullopt;
-        if (!offlineResponse) {
-            offlineResponse.emplace();
-            offlineResponse->noContent = true;
-            offlineResponse->error =
-                std::make_unique<Response::Error>(Response::Error::Reason::NotFound, "Not found in offline database");
-        } else if (!offlineResponse->isUsable()) {
-            offlineResponse->error =
-                std::make_unique<Response::Error>(Response::Error::Reason::NotFound, "Cached resource is unusable");
-        }
-        req.invoke(&FileSourceRequest::setResponse, *offlineResponse);
+        respond(&database(), resource, req);
+        reopenRemovedReaders();
     }
 
-    void setDatabasePath(const std::string& path, const std::function<void()>& callback) {
-        db->changePath(path);
+    void setDatabasePath(const std::string& path_, const std::function<void()>& callback) {
+        closeReaders();
+        database().changePath(path_);
+        path = path_;
+        openReaders();
         if (callback) {
             callback();
         }
     }
 
     void forward(const Resource& resource, const Response& response, const std::function<void()>& callback) {
-        db->put(resource, response);
+        pendingPuts.emplace_back(resource, response);
         if (callback) {
-            callback();
+            pendingCallbacks.push_back(callback);
+        }
+
+        if (pendingPuts.size() >= putBatchSize) {
+            writePendingPuts();
+        } else if (pendingPuts.size() == 1) {
+            putTimer.start(putBatchInterval, Duration::zero(), [this] { writePendingPuts(); });
         }
     }
 
-    void resetDatabase(const std::function<void(std::exception_ptr)>& callback) { callback(db->resetDatabase()); }
+    // Pending puts don't need to be written first, as writing them records the access anyway.
+    void markAccessed(const Resource& resource) { db->markAccessed(resource); }
+
+    void resetDatabase(const std::function<void(std::exception_ptr)>& callback) {
+        closeReaders();
+        auto result = database().resetDatabase();
+        ResponseCache::getInstance().clear();
+        openReaders();
+        callback(result);
+    }
 
-    void packDatabase(const std::function<void(std::exception_ptr)>& callback) { callback(db->pack()); }
+    void packDatabase(const std::function<void(std::exception_ptr)>& callback) { callback(database().pack()); }
 
-    void runPackDatabaseAutomatically(bool autopack) { db->runPackDatabaseAutomatically(autopack); }
+    void runPackDatabaseAutomatically(bool autopack) { database().runPackDatabaseAutomatically(autopack); }
 
-    void put(const Resource& resource, const Response& response) { db->put(resource, response); }
+    void put(const Resource& resource, const Response& response) { forward(resource, response, {}); }
 
     void invalidateAmbientCache(const std::function<void(std::exception_ptr)>& callback) {
-        callback(db->invalidateAmbientCache());
+        ResponseCache::getInstance().clear();
+        callback(database().invalidateAmbientCache());
     }
 
     void clearAmbientCache(const std::function<void(std::exception_ptr)>& callback) {
-        callback(db->clearAmbientCache());
+        ResponseCache::getInstance().clear();
+        callback(database().clearAmbientCache());
     }
 
     void setMaximumAmbientCacheSize(uint64_t size, const std::function<void(std::exception_ptr)>& callback) {
-        callback(db->setMaximumAmbientCacheSize(size));
+        callback(database().setMaximumAmbientCacheSize(size));
     }
 
     void listRegions(const std::function<void(expected<OfflineRegions, std::exception_ptr>)>& callback) {
-        callback(db->listRegions());
+        callback(database().listRegions());
     }
 
     void createRegion(const OfflineRegionDefinition& definition,
                       const OfflineRegionMetadata& metadata,
                       const std::function<void(expected<OfflineRegion, std::exception_ptr>)>& callback) {
-        callback(db->createRegion(definition, metadata));
+        callback(database().createRegion(definition, metadata));
     }
 
     void mergeOfflineRegions(const std::string& sideDatabasePath,
                              const std::function<void(expected<OfflineRegions, std::exception_ptr>)>& callback) {
-        callback(db->mergeDatabase(sideDatabasePath));
+        callback(database().mergeDatabase(sideDatabasePath));
     }
 
     void updateMetadata(const int64_t regionID,
                         const OfflineRegionMetadata& metadata,
                         const std::function<void(expected<OfflineRegionMetadata, std::exception_ptr>)>& callback) {
-        callback(db->updateMetadata(regionID, metadata));
+        callback(database().updateMetadata(regionID, metadata));
     }
 
     void getRegionStatus(int64_t regionID,
@@ -105,11 +282,11 @@ public:
 
     void deleteRegion(OfflineRegion region, const std::function<void(std::exception_ptr)>& callback) {
         downloads.erase(region.getID());
-        callback(db->deleteRegion(std::move(region)));
+        callback(database().deleteRegion(std::move(region)));
     }
 
     void invalidateRegion(int64_t regionID, const std::function<void(std::exception_ptr)>& callback) {
-        callback(db->invalidateRegion(regionID));
+        callback(database().invalidateRegion(regionID));
     }
 
     void setRegionObserver(int64_t regionID, std::unique_ptr<OfflineRegionObserver> observer) {
@@ -124,11 +301,88 @@ public:
         }
     }
 
-    void setOfflineMapboxTileCountLimit(uint64_t limit) { db->setOfflineMapboxTileCountLimit(limit); }
+    void setOfflineMapboxTileCountLimit(uint64_t limit) { database().setOfflineMapboxTileCountLimit(limit); }
 
-    void reopenDatabaseReadOnly(bool readOnly) { db->reopenDatabaseReadOnly(readOnly); }
+    void reopenDatabaseReadOnly(bool readOnly_) {
+        closeReaders();
+        database().reopenDatabaseReadOnly(readOnly_);
+        readOnly = readOnly_;
+        openReaders();
+    }
 
 private:
+    // Writes the pending puts first, so that every other operation sees the puts requested
+    // before it.
+    OfflineDatabase& database() {
+        writePendingPuts();
+        return *db;
+    }
+
+    void writePendingPuts() {
+        putTimer.stop();
+        if (pendingPuts.empty()) {
+            return;
+        }
+
+        db->putResources(pendingPuts);
+        for (const auto& put : pendingPuts) {
+            pendingPutURLs->remove(std::get<0>(put).url);
+        }
+        pendingPuts.clear();
+        reopenRemovedReaders();
+
+        auto callbacks = std::move(pendingCallbacks);
+        pendingCallbacks.clear();
+        for (const auto& callback : callbacks) {
+            callback();
+        }
+
+        if (db->isEvictionPending() && !evicting) {
+            evicting = true;
+            evictionTimer.start(evictionInterval, evictionInterval, [this] {
+                if (!db->evictAmbientCache(evictionBudget)) {
+                    evicting = false;
+                    evictionTimer.stop();
+                }
+            });
+        }
+    }
+
+    // Reads are served by the readers as long as they can open the database: it has to be a
+    // file, and the readers write accessed timestamps, which read-only mode doesn't allow.
+    void openReaders() {
+        readersRemoved = false;
+        if (readOnly || !isSharedDatabasePath(path)) {
+            return;
+        }
+        for (const auto& reader : readers) {
+            reader.invoke(&DatabaseFileSourceReader::open, path);
+        }
+        readersOpen = true;
+        readersEnabled->store(true);
+    }
+
+    // Routes new reads to the writer and waits for the readers to answer the reads they have
+    // and close their connections.
+    void closeReaders() {
+        readersEnabled->store(false);
+        if (!readersOpen) {
+            return;
+        }
+        for (const auto& reader : readers) {
+            reader.ask(&DatabaseFileSourceReader::close).wait();
+        }
+        readersOpen = false;
+    }
+
+    // After the database removed its file while handling an error, reads are served by the
+    // writer until it has created the database again.
+    void reopenRemovedReaders() {
+        if (readersRemoved && db->isOpen()) {
+            openReaders();
+        }
+    }
+
     expected<OfflineDownload*, std::exception_ptr> getDownload(int64_t regionID) {
         if (!onlineFileSource) {
             return unexpected<std::exception_ptr>(
@@ -139,7 +393,7 @@ private:
         if (it != downloads.end()) {
             return it->second.get();
         }
-        auto definition = db->getRegionDefinition(regionID);
+        auto definition = database().getRegionDefinition(regionID);
         if (!definition) {
             return unexpected<std::exception_ptr>(definition.error());
         }
@@ -151,23 +405,62 @@ private:
     std::unique_ptr<OfflineDatabase> db;
     std::map<int64_t, std::unique_ptr<OfflineDownload>> downloads;
     std::shared_ptr<FileSource> onlineFileSource;
+
+    const std::vector<ActorRef<DatabaseFileSourceReader>> readers;
+    const std::shared_ptr<std::atomic<bool>> readersEnabled;
+    const std::shared_ptr<PendingPutURLs> pendingPutURLs;
+    std::string path;
+    bool readOnly = false;
+    bool readersOpen = false;
+    bool readersRemoved = false;
+
+    std::list<std::tuple<Resource, Response>> pendingPuts;
+    std::vector<std::function<void()>> pendingCallbacks;
+    util::Timer putTimer;
+    util::Timer evictionTimer;
+    bool evicting = false;
 };
 
 class DatabaseFileSource::Impl {
 public:
     Impl(std::shared_ptr<FileSource> onlineFileSource, const ResourceOptions& resourceOptions_, const ClientOptions& clientOptions_) :
+        readers(makeReaders(onlineFileSource->getResourceOptions().tileServerOptions())),
         thread(std::make_unique<util::Thread<DatabaseFileSourceThread>>(
               util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_DATABASE),
               "DatabaseFileSource",
               std::move(onlineFileSource),
-              resourceOptions_.cachePath())),
+              resourceOptions_.cachePath(),
+              readerActors(),
+              readersEnabled,
+              pendingPutURLs)),
               resourceOptions(resourceOptions_.clone()),
               clientOptions(clientOptions_.clone()) {}
 
     ActorRef<DatabaseFileSourceThread> actor() const { return thread->actor(); }
 
-    void pause() { thread->pause(); }
-    void resume() { thread->resume(); }
+    void addPendingPut(const std::string& url) { pendingPutURLs->add(url); }
+
+    // Returns the next reader, or nullopt if the read has to be served by the writer thread.
+    std::optional<ActorRef<DatabaseFileSourceReader>> reader(const Resource& resource) const {
+        if (!readersEnabled->load() || pendingPutURLs->contains(resource.url)) {
+            return std::nullopt;
+        }
+        return readers[nextReader++ % readers.size()]->actor();
+    }
+
+    void pause() {
+        thread->pause();
+        for (const auto& reader : readers) {
+            reader->pause();
+        }
+    }
+
+    void resume() {
+        for (const auto& reader : readers) {
+            reader->resume();
+        }
+        thread->resume();
+    }
 
     void setResourceOptions(ResourceOptions options) {
         std::lock_guard<std::mutex> lock(resourceOptionsMutex);
@@ -190,6 +483,32 @@ public:
     }
 
 private:
+    static std::vector<std::unique_ptr<util::Thread<DatabaseFileSourceReader>>> makeReaders(
+        const TileServerOptions& tileServerOptions) {
+        std::vector<std::unique_ptr<util::Thread<DatabaseFileSourceReader>>> result;
+        for (std::size_t i = 0; i < readerCount; ++i) {
+            result.push_back(std::make_unique<util::Thread<DatabaseFileSourceReader>>(
+                util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_DATABASE),
+                "DatabaseFileSourceReader",
+                tileServerOptions));
+        }
+        return result;
+    }
+
+    std::vector<ActorRef<DatabaseFileSourceReader>> readerActors() const {
+        std::vector<ActorRef<DatabaseFileSourceReader>> result;
+        for (const auto& reader : readers) {
+            result.push_back(reader->actor());
+        }
+        return result;
+    }
+
+    // Set by the writer thread while the readers have the database open.
+    const std::shared_ptr<std::atomic<bool>> readersEnabled = std::make_shared<std::atomic<bool>>(false);
+    const std::shared_ptr<PendingPutURLs> pendingPutURLs = std::make_shared<PendingPutURLs>();
+    mutable std::atomic<std::size_t> nextReader{0};
+    // The writer thread stops before the readers, and writes its pending puts as it stops.
+    const std::vector<std::unique_ptr<util::Thread<DatabaseFileSourceReader>>> readers;
     const std::unique_ptr<util::Thread<DatabaseFileSourceThread>> thread;
     mutable std::mutex resourceOptionsMutex;
     mutable std::mutex clientOptionsMutex;
@@ -207,13 +526,18 @@ DatabaseFileSource::~DatabaseFileSource() = default;
 
 std::unique_ptr<AsyncRequest> DatabaseFileSource::request(const Resource& resource, Callback callback) {
     auto req = std::make_unique<FileSourceRequest>(std::move(callback));
-    impl->actor().invoke(&DatabaseFileSourceThread::request, resource, req->actor());
+    if (auto reader = impl->reader(resource)) {
+        reader->invoke(&DatabaseFileSourceReader::request, resource, req->actor());
+    } else {
+        impl->actor().invoke(&DatabaseFileSourceThread::request, resource, req->actor());
+    }
     return req;
 }
 
 void DatabaseFileSource::forward(const Resource& res, const Response& response, std::function<void()> callback) {
     if (res.storagePolicy == Resource::StoragePolicy::Volatile) return;
 
+    impl->addPendingPut(res.url);
     std::function<void()> wrapper;
     if (callback) {
         wrapper = Scheduler::GetCurrent()->bindOnce(std::move(callback));
@@ -221,6 +545,12 @@ void DatabaseFileSource::forward(const Resource& res, const Response& response,
     impl->actor().invoke(&DatabaseFileSourceThread::forward, res, response, std::move(wrapper));
 }
 
+void DatabaseFileSource::markAccessed(const Resource& res) {
+    if (res.storagePolicy == Resource::StoragePolicy::Volatile) return;
+
+    impl->actor().invoke(&DatabaseFileSourceThread::markAccessed, res);
+}
+
 bool DatabaseFileSource::canRequest(const Resource& resource) const {
     return resource.hasLoadingMethod(Resource::LoadingMethod::Cache) &&
            resource.url.rfind(mbgl::util::ASSET_PROTOCOL, 0) == std::string::npos &&
@@ -17,7 +17,9 @@
 #include <dlfcn.h>
 #include <queue>
 #include <map>
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <cstdio>
 #include <optional>
@@ -64,6 +66,23 @@ public:
     // them all the time.
     std::queue<CURL *> handles;
 
+    // When set, requests prefer HTTP/2 and wait for an existing connection to the host to
+    // multiplex onto instead of opening a new one.
+    bool multiplexing = false;
+    void setMultiplexing(bool);
+
+    // Counters of the completed requests and of the connections they used.
+    struct Metrics {
+        uint64_t requests = 0;
+        uint64_t http2Requests = 0;
+        uint64_t connectionsOpened = 0;
+        uint64_t connectionsReused = 0;
+        uint64_t tlsHandshakes = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesReceived = 0;
+    } metrics;
+    void recordMetrics(CURL *handle);
+
     void setResourceOptions(ResourceOptions options);
     ResourceOptions getResourceOptions();
 
@@ -96,6 +115,9 @@ private:
     std::shared_ptr<std::string> data;
     std::unique_ptr<Response> response;
 
+    // Size announced by the Content-Length header, used to allocate the body once.
+    std::size_t expectedSize = 0;
+
     std::optional<std::string> retryAfter;
     std::optional<std::string> xRateLimitReset;
 
@@ -120,6 +142,58 @@ HTTPFileSource::Impl::Impl(const ResourceOptions& resourceOptions_, const Client
     handleError(curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this));
 }
 
+void HTTPFileSource::Impl::setMultiplexing(bool multiplexing_) {
+#if LIBCURL_VERSION_NUM >= ((7) << 16 | (43) << 8 | 0) // Multiplexing since 7.43.0
+    // libcurl multiplexes by default since 7.62.0; older versions need to be asked for it.
+    if (multiplexing_) {
+        handleError(curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX));
+    }
+    multiplexing = multiplexing_;
+#else
+    if (multiplexing_) {
+        Log::Warning(Event::HttpRequest, "HTTP/2 multiplexing requires libcurl 7.43.0 or newer");
+    }
+#endif
+}
+
+void HTTPFileSource::Impl::recordMetrics(CURL *handle) {
+    long connects = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+    double appConnectTime = 0;
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME, &appConnectTime);
+    long requestSize = 0;
+    curl_easy_getinfo(handle, CURLINFO_REQUEST_SIZE, &requestSize);
+    long headerSize = 0;
+    curl_easy_getinfo(handle, CURLINFO_HEADER_SIZE, &headerSize);
+#if LIBCURL_VERSION_NUM >= ((7) << 16 | (55) << 8 | 0) // CURLINFO_SIZE_DOWNLOAD_T since 7.55.0
+    curl_off_t bodySize = 0;
+    curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &bodySize);
+#else
+    double bodySize = 0;
+    curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD, &bodySize);
+#endif
+
+    metrics.requests++;
+#if LIBCURL_VERSION_NUM >= ((7) << 16 | (50) << 8 | 0) // CURLINFO_HTTP_VERSION since 7.50.0
+    long httpVersion = 0;
+    curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &httpVersion);
+    if (httpVersion == CURL_HTTP_VERSION_2_0) {
+        metrics.http2Requests++;
+    }
+#endif
+    if (connects > 0) {
+        metrics.connectionsOpened += connects;
+        // The TLS handshake time is only set for the transfers that made one.
+        if (appConnectTime > 0) {
+            metrics.tlsHandshakes++;
+        }
+    } else {
+        metrics.connectionsReused++;
+    }
+    metrics.bytesSent += requestSize;
+    metrics.bytesReceived += headerSize + static_cast<uint64_t>(bodySize);
+}
+
 HTTPFileSource::Impl::~Impl() {
     while (!handles.empty()) {
         curl_easy_cleanup(handles.front());
@@ -300,6 +374,14 @@ HTTPRequest::HTTPRequest(HTTPFileSource::Impl* context_, Resource resource_, Fil
 #endif
     handleError(curl_easy_setopt(handle, CURLOPT_USERAGENT, "MapboxGL/1.0"));
     handleError(curl_easy_setopt(handle, CURLOPT_SHARE, context->share));
+#if LIBCURL_VERSION_NUM >= ((7) << 16 | (47) << 8 | 0) // CURL_HTTP_VERSION_2TLS since 7.47.0
+    if (context->multiplexing) {
+        // HTTP/2 over TLS, HTTP/1.1 otherwise. Requests queue up behind the connection being
+        // opened to the host and share it once it turns out to support multiplexing.
+        handleError(curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS));
+        handleError(curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L));
+    }
+#endif
 
     // Start requesting the information.
     handleError(curl_multi_add_handle(context->multi, handle));
@@ -327,6 +409,10 @@ size_t HTTPRequest::writeCallback(void *const contents, const size_t size, const
 
     if (!impl->data) {
         impl->data = std::make_shared<std::string>();
+        // For compressed bodies this is the compressed size. The body is inflated as it arrives,
+        // so the reservation still saves the early reallocations. Don't trust larger values.
+        constexpr std::size_t maximumReservation = 256 * 1024 * 1024;
+        impl->data->reserve(std::min(impl->expectedSize, maximumReservation));
     }
 
     impl->data->append(static_cast<char *>(contents), size * nmemb);
@@ -359,7 +445,13 @@ size_t HTTPRequest::headerCallback(char *const buffer, const size_t size, const
 
     const size_t length = size * nmemb;
     size_t begin = std::string::npos;
-    if ((begin = headerMatches("last-modified: ", buffer, length)) != std::string::npos) {
+    if (headerMatches("http/", buffer, length) != std::string::npos) {
+        // A new response starts, e.g. after a redirect.
+        baton->expectedSize = 0;
+    } else if ((begin = headerMatches("content-length: ", buffer, length)) != std::string::npos) {
+        const std::string value { buffer + begin, length - begin - 2 }; // remove \r\n
+        baton->expectedSize = static_cast<std::size_t>(std::strtoull(value.c_str(), nullptr, 10));
+    } else if ((begin = headerMatches("last-modified: ", buffer, length)) != std::string::npos) {
         // Always overwrite the modification date; We might already have a value here from the
         // Date header, but this one is more accurate.
         const std::string value { buffer + begin, length - begin - 2 }; // remove \r\n
@@ -391,6 +483,8 @@ void HTTPRequest::handleResult(CURLcode code) {
 
     using Error = Response::Error;
 
+    context->recordMetrics(handle);
+
     // Add human-readable error code
     if (code != CURLE_OK) {
         switch (code) {
@@ -456,6 +550,34 @@ std::unique_ptr<AsyncRequest> HTTPFileSource::request(const Resource& resource,
     return std::make_unique<HTTPRequest>(impl.get(), resource, callback);
 }
 
+void HTTPFileSource::setProperty(const std::string& key, const mapbox::base::Value& value) {
+    if (key == HTTP2_MULTIPLEXING_KEY) {
+        if (auto* boolValue = value.getBool()) {
+            impl->setMultiplexing(*boolValue);
+        } else {
+            Log::Error(Event::General, "Invalid http2-multiplexing property value type.");
+        }
+    } else {
+        FileSource::setProperty(key, value);
+    }
+}
+
+mapbox::base::Value HTTPFileSource::getProperty(const std::string& key) const {
+    if (key == HTTP2_MULTIPLEXING_KEY) {
+        return impl->multiplexing;
+    } else if (key == HTTP_METRICS_KEY) {
+        const auto& metrics = impl->metrics;
+        return mapbox::base::ValueObject{{"requests", metrics.requests},
+                                         {"http2-requests", metrics.http2Requests},
+                                         {"connections-opened", metrics.connectionsOpened},
+                                         {"connections-reused", metrics.connectionsReused},
+                                         {"tls-handshakes", metrics.tlsHandshakes},
+                                         {"bytes-sent", metrics.bytesSent},
+                                         {"bytes-received", metrics.bytesReceived}};
+    }
+    return FileSource::getProperty(key);
+}
+
 void HTTPFileSource::setResourceOptions(ResourceOptions options) {
     impl->setResourceOptions(options.clone());
 }
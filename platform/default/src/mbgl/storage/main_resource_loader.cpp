@@ -6,12 +6,19 @@
 #include <mbgl/storage/main_resource_loader.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/resource_options.hpp>
+#include <mbgl/storage/response_cache.hpp>
 #include <mbgl/util/client_options.hpp>
+#include <mbgl/util/logging.hpp>
 #include <mbgl/util/stopwatch.hpp>
+#include <mbgl/util/string.hpp>
 #include <mbgl/util/thread.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
 
 namespace mbgl {
 
@@ -21,15 +28,54 @@ public:
                              std::shared_ptr<FileSource> databaseFileSource_,
                              std::shared_ptr<FileSource> localFileSource_,
                              std::shared_ptr<FileSource> onlineFileSource_,
-                             std::shared_ptr<FileSource> mbtilesFileSource_)
+                             std::shared_ptr<FileSource> mbtilesFileSource_,
+                             std::shared_ptr<FileSource> pmtilesFileSource_,
+                             std::string cacheScope_)
         : assetFileSource(std::move(assetFileSource_)),
           databaseFileSource(std::move(databaseFileSource_)),
           localFileSource(std::move(localFileSource_)),
           onlineFileSource(std::move(onlineFileSource_)),
-          mbtilesFileSource(std::move(mbtilesFileSource_)) {}
+          mbtilesFileSource(std::move(mbtilesFileSource_)),
+          pmtilesFileSource(std::move(pmtilesFileSource_)),
+          cacheScope(std::move(cacheScope_)) {}
 
     void request(AsyncRequest* req, const Resource& resource, const ActorRef<FileSourceRequest>& ref) {
-        auto callback = [ref](const Response& res) { ref.invoke(&FileSourceRequest::setResponse, res); };
+        if (auto cached = ResponseCache::getInstance().get(resource, cacheScope)) {
+            // The database doesn't see this read, but its least recently used eviction must.
+            if (databaseFileSource && databaseFileSource->canRequest(resource)) {
+                databaseFileSource->markAccessed(resource);
+            }
+            ref.invoke(&FileSourceRequest::setResponse, *cached);
+            return;
+        }
+
+        // Attach to an identical request that is still waiting for its first response.
+        std::string key = coalescingKey(resource);
+        if (!key.empty()) {
+            if (auto it = waitingGroups.find(key); it != waitingGroups.end()) {
+                groups[it->second].members.emplace(req, ref);
+                groupOf[req] = it->second;
+                ranks[req] = resource.rank;
+                updateRank(groups[it->second]);
+                return;
+            }
+        }
+
+        const uint64_t id = nextGroup++;
+        Group& group = groups[id];
+        group.members.emplace(req, ref);
+        groupOf[req] = id;
+        ranks[req] = resource.rank;
+        group.rank = resource.rank;
+        if (!key.empty()) {
+            waitingGroups[key] = id;
+            group.key = std::move(key);
+        }
+
+        auto callback = [this, id, resource, scope = cacheScope](const Response& res) {
+            ResponseCache::getInstance().put(resource, res, scope);
+            respond(id, res);
+        };
 
         auto requestFromNetwork = [=](const Resource& res,
                                       std::unique_ptr<AsyncRequest> parent) -> std::unique_ptr<AsyncRequest> {
@@ -58,28 +104,31 @@ public:
             });
         };
 
-        // Initial tasksSize is used to check whether any of
-        // the sources were able to request a resource.
-        const std::size_t tasksSize = tasks.size();
-
         // Waterfall resource request processing and return early once resource was requested.
         if (assetFileSource && assetFileSource->canRequest(resource)) {
             // Asset request
-            tasks[req] = assetFileSource->request(resource, callback);
+            group.task = assetFileSource->request(resource, callback);
         } else if (mbtilesFileSource && mbtilesFileSource->canRequest(resource)) {
             // Local file request
-            tasks[req] = mbtilesFileSource->request(resource, callback);
+            group.task = mbtilesFileSource->request(resource, callback);
+        } else if (pmtilesFileSource && pmtilesFileSource->canRequest(resource)) {
+            // Local file request
+            group.task = pmtilesFileSource->request(resource, callback);
         } else if (localFileSource && localFileSource->canRequest(resource)) {
             // Local file request
-            tasks[req] = localFileSource->request(resource, callback);
+            group.task = localFileSource->request(resource, callback);
         } else if (databaseFileSource && databaseFileSource->canRequest(resource)) {
             // Try cache only request if needed.
             if (resource.loadingMethod == Resource::LoadingMethod::CacheOnly) {
-                tasks[req] = databaseFileSource->request(resource, callback);
+                group.task = databaseFileSource->request(resource, callback);
             } else {
                 // Cache request with fallback to network with cache control
-                tasks[req] = databaseFileSource->request(resource, [=](const Response& response) {
+                group.task = databaseFileSource->request(resource, [=](const Response& response) {
                     Resource res = resource;
+                    auto& task = groups[id].task;
+                    if (auto rank = groups[id].rank) {
+                        res.setRank(*rank);
+                    }
 
                     // Resource is in the cache
                     if (!response.noContent) {
@@ -100,16 +149,16 @@ public:
                         res.priorEtag = response.etag;
                     }
 
-                    tasks[req] = requestFromNetwork(res, std::move(tasks[req]));
+                    task = requestFromNetwork(res, std::move(task));
                 });
             }
         } else if (auto networkReq = requestFromNetwork(resource, nullptr)) {
             // Get from the online file source
-            tasks[req] = std::move(networkReq);
+            group.task = std::move(networkReq);
         }
 
-        // If no new tasks were added, notify client that request cannot be processed.
-        if (tasks.size() == tasksSize) {
+        // If no task was started, notify client that request cannot be processed.
+        if (!group.task) {
             Response response;
             response.noContent = true;
             response.error =
@@ -120,16 +169,109 @@ public:
 
     void cancel(AsyncRequest* req) {
         assert(req);
-        tasks.erase(req);
+        ranks.erase(req);
+        auto it = groupOf.find(req);
+        if (it == groupOf.end()) {
+            return;
+        }
+        const uint64_t id = it->second;
+        groupOf.erase(it);
+
+        // The shared task is cancelled along with the last request attached to it.
+        Group& group = groups[id];
+        group.members.erase(req);
+        if (group.members.empty()) {
+            if (!group.key.empty()) {
+                waitingGroups.erase(group.key);
+            }
+            groups.erase(id);
+        } else {
+            updateRank(group);
+        }
     }
 
+    void setRank(AsyncRequest* req, double rank) {
+        assert(req);
+        auto it = groupOf.find(req);
+        if (it == groupOf.end()) {
+            return;
+        }
+        ranks[req] = rank;
+        updateRank(groups[it->second]);
+    }
+
+    void setCacheScope(std::string scope) { cacheScope = std::move(scope); }
+
 private:
+    // Requests attached to a single task: the first request for a resource and the identical
+    // requests that were made before it got its first response.
+    struct Group {
+        // Set while the group waits for its first response and accepts new requests.
+        std::string key;
+        std::unique_ptr<AsyncRequest> task;
+        std::map<AsyncRequest*, ActorRef<FileSourceRequest>> members;
+        // Remembered for the network request that may follow the database request.
+        std::optional<double> rank;
+    };
+
+    // Requests that revalidate data they already hold, or that ask for it in a different way,
+    // don't share tasks.
+    static std::string coalescingKey(const Resource& resource) {
+        if (resource.priorModified || resource.priorExpires || resource.priorEtag || resource.priorData) {
+            return {};
+        }
+        return util::toString(static_cast<int>(resource.kind)) + ':' +
+               util::toString(static_cast<int>(resource.loadingMethod)) + ':' +
+               util::toString(static_cast<int>(resource.priority)) + ':' +
+               util::toString(static_cast<int>(resource.usage)) + ':' +
+               util::toString(static_cast<int>(resource.storagePolicy)) + ':' +
+               util::toString(static_cast<int64_t>(resource.minimumUpdateInterval.count())) + ':' + resource.url;
+    }
+
+    void respond(uint64_t id, const Response& response) {
+        auto it = groups.find(id);
+        if (it == groups.end()) {
+            return;
+        }
+        Group& group = it->second;
+        if (!group.key.empty()) {
+            waitingGroups.erase(group.key);
+            group.key.clear();
+        }
+        for (const auto& member : group.members) {
+            member.second.invoke(&FileSourceRequest::setResponse, response);
+        }
+    }
+
+    // The shared task takes the lowest rank of the requests attached to it.
+    void updateRank(Group& group) {
+        std::optional<double> rank;
+        for (const auto& member : group.members) {
+            if (auto it = ranks.find(member.first); it != ranks.end()) {
+                rank = rank ? std::min(*rank, it->second) : it->second;
+            }
+        }
+        if (rank && rank != group.rank) {
+            group.rank = rank;
+            if (group.task) {
+                group.task->setRank(*rank);
+            }
+        }
+    }
+
     const std::shared_ptr<FileSource> assetFileSource;
     const std::shared_ptr<FileSource> databaseFileSource;
     const std::shared_ptr<FileSource> localFileSource;
     const std::shared_ptr<FileSource> onlineFileSource;
     const std::shared_ptr<FileSource> mbtilesFileSource;
-    std::map<AsyncRequest*, std::unique_ptr<AsyncRequest>> tasks;
+    const std::shared_ptr<FileSource> pmtilesFileSource;
+    std::map<uint64_t, Group> groups;
+    std::map<AsyncRequest*, uint64_t> groupOf;
+    std::unordered_map<std::string, uint64_t> waitingGroups;
+    std::map<AsyncRequest*, double> ranks;
+    uint64_t nextGroup = 0;
+    // Scope of the responses this loader shares through the response cache.
+    std::string cacheScope;
 };
 
 class MainResourceLoader::Impl {
@@ -140,12 +282,14 @@ public:
          std::shared_ptr<FileSource> databaseFileSource_,
          std::shared_ptr<FileSource> localFileSource_,
          std::shared_ptr<FileSource> onlineFileSource_,
-         std::shared_ptr<FileSource> mbtilesFileSource_)
+         std::shared_ptr<FileSource> mbtilesFileSource_,
+         std::shared_ptr<FileSource> pmtilesFileSource_)
         : assetFileSource(std::move(assetFileSource_)),
           databaseFileSource(std::move(databaseFileSource_)),
           localFileSource(std::move(localFileSource_)),
           onlineFileSource(std::move(onlineFileSource_)),
           mbtilesFileSource(std::move(mbtilesFileSource_)),
+          pmtilesFileSource(std::move(pmtilesFileSource_)),
           supportsCacheOnlyRequests_(bool(databaseFileSource)),
           thread(std::make_unique<util::Thread<MainResourceLoaderThread>>(
               util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_WORKER),
@@ -154,7 +298,9 @@ public:
               databaseFileSource,
               localFileSource,
               onlineFileSource,
-              mbtilesFileSource)),
+              mbtilesFileSource,
+              pmtilesFileSource,
+              cacheScopeOf(resourceOptions_))),
           resourceOptions (resourceOptions_.clone()),
           clientOptions (clientOptions_.clone()) {}
 
@@ -164,6 +310,9 @@ public:
         req->onCancel([actorRef = thread->actor(), req = req.get()]() {
             actorRef.invoke(&MainResourceLoaderThread::cancel, req);
         });
+        req->onSetRank([actorRef = thread->actor(), req = req.get()](double rank) {
+            actorRef.invoke(&MainResourceLoaderThread::setRank, req, rank);
+        });
         thread->actor().invoke(&MainResourceLoaderThread::request, req.get(), resource, req->actor());
         return req;
     }
@@ -173,7 +322,8 @@ public:
                (localFileSource && localFileSource->canRequest(resource)) ||
                (databaseFileSource && databaseFileSource->canRequest(resource)) ||
                (onlineFileSource && onlineFileSource->canRequest(resource)) ||
-               (mbtilesFileSource && mbtilesFileSource->canRequest(resource));
+               (mbtilesFileSource && mbtilesFileSource->canRequest(resource)) ||
+               (pmtilesFileSource && pmtilesFileSource->canRequest(resource));
     }
 
     bool supportsCacheOnlyRequests() const { return supportsCacheOnlyRequests_; }
@@ -190,6 +340,8 @@ public:
         localFileSource->setResourceOptions(options.clone());
         onlineFileSource->setResourceOptions(options.clone());
         mbtilesFileSource->setResourceOptions(options.clone());
+        pmtilesFileSource->setResourceOptions(options.clone());
+        thread->actor().invoke(&MainResourceLoaderThread::setCacheScope, cacheScopeOf(options));
     }
 
     ResourceOptions getResourceOptions() {
@@ -205,6 +357,7 @@ public:
         localFileSource->setClientOptions(options.clone());
         onlineFileSource->setClientOptions(options.clone());
         mbtilesFileSource->setClientOptions(options.clone());
+        pmtilesFileSource->setClientOptions(options.clone());
     }
 
     ClientOptions getClientOptions() {
@@ -213,11 +366,30 @@ public:
     }
 
 private:
+    // Identifies the options that change what a cached resource URL resolves to.
+    static std::string cacheScopeOf(const ResourceOptions& options) {
+        const TileServerOptions tileServerOptions = options.tileServerOptions();
+        std::string scope;
+        for (const std::string* part : {&options.apiKey(),
+                                        &options.cachePath(),
+                                        &options.assetPath(),
+                                        &tileServerOptions.baseURL(),
+                                        &tileServerOptions.uriSchemeAlias(),
+                                        &tileServerOptions.sourceTemplate(),
+                                        &tileServerOptions.styleTemplate(),
+                                        &tileServerOptions.spritesTemplate(),
+                                        &tileServerOptions.glyphsTemplate()}) {
+            scope += util::toString(part->size()) + ':' + *part;
+        }
+        return scope;
+    }
+
     const std::shared_ptr<FileSource> assetFileSource;
     const std::shared_ptr<FileSource> databaseFileSource;
     const std::shared_ptr<FileSource> localFileSource;
     const std::shared_ptr<FileSource> onlineFileSource;
     const std::shared_ptr<FileSource> mbtilesFileSource;
+    const std::shared_ptr<FileSource> pmtilesFileSource;
     const bool supportsCacheOnlyRequests_;
     const std::unique_ptr<util::Thread<MainResourceLoaderThread>> thread;
     mutable std::mutex resourceOptionsMutex;
@@ -233,7 +405,8 @@ MainResourceLoader::MainResourceLoader(const ResourceOptions& resourceOptions, c
                                 FileSourceManager::get()->getFileSource(FileSourceType::Database, resourceOptions, clientOptions),
                                 FileSourceManager::get()->getFileSource(FileSourceType::FileSystem, resourceOptions, clientOptions),
                                 FileSourceManager::get()->getFileSource(FileSourceType::Network, resourceOptions, clientOptions),
-                                FileSourceManager::get()->getFileSource(FileSourceType::Mbtiles, resourceOptions, clientOptions))) {}
+                                FileSourceManager::get()->getFileSource(FileSourceType::Mbtiles, resourceOptions, clientOptions),
+                                FileSourceManager::get()->getFileSource(FileSourceType::Pmtiles, resourceOptions, clientOptions))) {}
 
 MainResourceLoader::~MainResourceLoader() = default;
 
@@ -257,6 +430,33 @@ void MainResourceLoader::resume() {
     impl->resume();
 }
 
+void MainResourceLoader::setProperty(const std::string& key, const mapbox::base::Value& value) {
+    if (key == RESPONSE_CACHE_SIZE_KEY) {
+        // Process-wide, like the cache itself, rather than a setting of this loader.
+        if (auto* size = value.getUint()) {
+            ResponseCache::getInstance().setMaximumSize(*size);
+        }
+    } else {
+        std::string message = "Resource provider does not support property " + key;
+        Log::Error(Event::General, message.c_str());
+    }
+}
+
+mapbox::base::Value MainResourceLoader::getProperty(const std::string& key) const {
+    if (key == RESPONSE_CACHE_SIZE_KEY) {
+        return ResponseCache::getInstance().getMaximumSize();
+    } else if (key == RESPONSE_CACHE_STATISTICS_KEY) {
+        const auto statistics = ResponseCache::getInstance().getStatistics();
+        return mapbox::base::ValueObject{{"hits", statistics.hits},
+                                         {"misses", statistics.misses},
+                                         {"entries", statistics.entries},
+                                         {"size", statistics.size}};
+    }
+    std::string message = "Resource provider does not support property " + key;
+    Log::Error(Event::General, message.c_str());
+    return {};
+}
+
 void MainResourceLoader::setResourceOptions(ResourceOptions options) {
     impl->setResourceOptions(options.clone());
 }
@@ -1,5 +1,7 @@
 #include <sstream>
 #include <map>
+#include <stdexcept>
+#include <utility>
 
 #include <mbgl/platform/settings.hpp>
 #include <mbgl/storage/mbtiles_file_source.hpp>
@@ -34,6 +36,60 @@ bool acceptsURL(const std::string& url) {
 std::string url_to_path(const std::string &url) {
     return mbgl::util::percentDecode(url.substr(std::char_traits<char>::length(mbgl::util::MBTILES_PROTOCOL)));
 }
+
+std::string db_path(const std::string &path) {
+    return path.substr(0, path.find('?'));
+}
+
+bool is_compressed(const std::string &v) {
+    return v.size() >= 2 && (((uint8_t) v[0]) == 0x1f) && (((uint8_t) v[1]) == 0x8b);
+}
+
+// Number of threads serving tile requests.
+constexpr std::size_t reader_count = 2;
+
+// Modification time and size of a file, to tell when it was replaced or written to.
+std::pair<int64_t, int64_t> file_version(const std::string &path) {
+    struct stat buffer;
+    if (stat(path.c_str(), &buffer) == -1) {
+        return {-1, -1};
+    }
+    return {static_cast<int64_t>(buffer.st_mtime), static_cast<int64_t>(buffer.st_size)};
+}
+
+// A read-only connection to an .mbtiles file, with the tile statement prepared once.
+struct Connection {
+    Connection(const std::string &path, std::pair<int64_t, int64_t> version_)
+        : db(mapbox::sqlite::Database::open(path.c_str(), mapbox::sqlite::ReadOnly)),
+          tile_stmt(db, "SELECT tile_data FROM tiles WHERE zoom_level = ?1 AND tile_column = ?2 AND tile_row = ?3"),
+          version(version_) {}
+
+    mapbox::sqlite::Database db;
+    // Declared after the database, which has to outlive it.
+    mapbox::sqlite::Statement tile_stmt;
+    const std::pair<int64_t, int64_t> version;
+};
+
+// Connections open simultaneously, to effectively support multiple .mbtiles maps. A connection
+// is reopened once its file changes.
+class ConnectionCache {
+public:
+    Connection &get(const std::string &path) {
+        const auto version = file_version(path);
+        auto ptr = connections.find(path);
+        if (ptr != connections.end()) {
+            if (ptr->second->version == version) {
+                return *ptr->second;
+            }
+            connections.erase(ptr);
+        }
+        auto connection = std::make_unique<Connection>(path, version);
+        return *connections.emplace(path, std::move(connection)).first->second;
+    }
+
+private:
+    std::map<std::string, std::unique_ptr<Connection>> connections;
+};
 } // namespace
 
 namespace mbgl {
@@ -72,25 +128,29 @@ public:
 
 
 
-    std::string db_path(const std::string &path) {
-        return path.substr(0, path.find('?'));
-    }
-
-    bool is_compressed(const std::string &v) {
-        return (((uint8_t) v[0]) == 0x1f) && (((uint8_t) v[1]) == 0x8b);
-    }
-
     // Generate a tilejson resource from .mbtiles file
     void request_tilejson(const Resource &resource, ActorRef<FileSourceRequest> req) {
-        auto path = url_to_path(resource.url);
-
         Response response;
 
+        // Opening the file, reading its metadata and parsing the numbers in it all throw on
+        // malformed files.
+        try {
+            response.data = std::make_shared<std::string>(tilejson(resource.url));
+        } catch (const std::exception &ex) {
+            response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other, ex.what());
+        }
+
+        req.invoke(&FileSourceRequest::setResponse, response);
+    }
+
+    std::string tilejson(const std::string &url) {
+        auto path = url_to_path(url);
+
         Document doc;
         auto &allocator = doc.GetAllocator();
 
         std::map<std::string, std::string> values;
-        auto db = mapbox::sqlite::Database::open(path.c_str(), mapbox::sqlite::ReadOnly);
+        auto &db = connections.get(path).db;
 
         mapbox::sqlite::Statement meta(db, "SELECT * from metadata");
         for (mapbox::sqlite::Query q(meta); q.run();) {
@@ -118,7 +178,7 @@ public:
         }
 
         // We use file location with appended parameter query parameter as URL for actual tile data
-        std::string tile_url = std::string(resource.url + "?file={x}/{y}/{z}." + format);
+        std::string tile_url = std::string(url + "?file={x}/{y}/{z}." + format);
         rapidjson::Value arr(kArrayType);
         rapidjson::Value tile_url_val(tile_url, allocator);
         arr.PushBack(tile_url_val, allocator);
@@ -158,9 +218,7 @@ public:
             } else if (entry.first == "bounds") {
                 std::vector<double> x = split(entry.second, ',');
                 if (x.size() != 4) {
-                    response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other);
-                    req.invoke(&FileSourceRequest::setResponse, response);
-                    return;
+                    throw std::runtime_error("invalid bounds in " + path);
                 }
                 double cLon = (x[0] + x[2]) / 2;
                 double cLat = (x[1] + x[3]) / 2;
@@ -185,45 +243,7 @@ public:
             }
         }
 
-        response.data = std::make_shared<std::string>(serialize(doc));
-        req.invoke(&FileSourceRequest::setResponse, response);
-    }
-
-    // Load data for specific tile
-    void request_tile(const Resource &resource, ActorRef<FileSourceRequest> req) {
-        std::string base_path = url_to_path(resource.url);
-        std::string path = db_path(base_path);
-        auto &db = get_db(path);
-
-        int iy = resource.tileData->y;
-        int iz = resource.tileData->z;
-
-        auto x = std::to_string(resource.tileData->x);
-        auto y = std::to_string((int)(pow(2, iz) - 1) - iy);
-        auto z = std::to_string(iz);
-
-        std::string sql = "SELECT tile_data FROM tiles where zoom_level = " + z +
-                          " AND tile_column = " + x + " AND tile_row = " + y;
-        mapbox::sqlite::Statement stmt(db, sql.c_str());
-
-        Response response;
-        response.noContent = true;
-
-        for (mapbox::sqlite::Query q(stmt); q.run();) {
-
-            std::optional<std::string> data = q.get<std::optional<std::string>>(0);
-            if (data) {
-                response.data = std::make_shared<std::string>(*data);
-                response.noContent = false;
-                response.expires = Timestamp::max();
-                response.etag = resource.url;
-
-                if (is_compressed(*response.data)) {
-                    response.data = std::make_shared<std::string>(util::decompress(*response.data));
-                }
-            }
-        }
-        req.invoke(&FileSourceRequest::setResponse, response);
+        return serialize(doc);
     }
 
     void setResourceOptions(ResourceOptions options) {
@@ -248,29 +268,7 @@ public:
 
 
 private:
-    std::map<std::string, mapbox::sqlite::Database> db_cache;
-
-    void close_db(const std::string &path) {
-        auto ptr = db_cache.find(path);
-        if (ptr != db_cache.end()) {
-            db_cache.erase(path);
-        }
-    }
-
-    void close_all() {
-        db_cache.clear();
-    }
-
-    // Multiple databases open simultaneoulsy, to effectively support multiple .mbtiles maps
-    mapbox::sqlite::Database &get_db(const std::string &path) {
-        auto ptr = db_cache.find(path);
-        if (ptr != db_cache.end()) {
-            return ptr->second;
-        };
-
-        auto ptr2 = db_cache.insert(std::pair<std::string, mapbox::sqlite::Database>(path, mapbox::sqlite::Database::open(path.c_str(), mapbox::sqlite::ReadOnly)));
-        return ptr2.first->second;
-    }
+    ConnectionCache connections;
 
     mutable std::mutex resourceOptionsMutex;
     mutable std::mutex clientOptionsMutex;
@@ -279,16 +277,61 @@ private:
 };
 
 
+// Serves tile requests on connections of its own, so that tiles are read in parallel.
+class MBTilesFileSource::Reader {
+public:
+    // Load data for specific tile
+    void request_tile(const Resource &resource, ActorRef<FileSourceRequest> req) {
+        Response response;
+        response.noContent = true;
+
+        try {
+            auto &connection = connections.get(db_path(url_to_path(resource.url)));
+
+            // .mbtiles files use the TMS scheme
+            const auto &tile = *resource.tileData;
+            mapbox::sqlite::Query q(connection.tile_stmt);
+            q.bind(1, tile.z);
+            q.bind(2, tile.x);
+            q.bind(3, (int32_t(1) << tile.z) - 1 - tile.y);
+
+            if (q.run()) {
+                std::optional<std::string> data = q.get<std::optional<std::string>>(0);
+                if (data) {
+                    response.data = std::make_shared<std::string>(
+                        is_compressed(*data) ? util::decompress(*data) : std::move(*data));
+                    response.noContent = false;
+                    response.expires = Timestamp::max();
+                    response.etag = resource.url;
+                }
+            }
+        } catch (const std::exception &ex) {
+            response.noContent = false;
+            response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other, ex.what());
+        }
+
+        req.invoke(&FileSourceRequest::setResponse, response);
+    }
+
+private:
+    ConnectionCache connections;
+};
+
 MBTilesFileSource::MBTilesFileSource(const ResourceOptions& resourceOptions, const ClientOptions& clientOptions) :
     thread(std::make_unique<util::Thread<Impl>>(
-        util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_FILE), "MBTilesFileSource", resourceOptions.clone(), clientOptions.clone())) {}
+        util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_FILE), "MBTilesFileSource", resourceOptions.clone(), clientOptions.clone())) {
+    for (std::size_t i = 0; i < reader_count; ++i) {
+        readers.push_back(std::make_unique<util::Thread<Reader>>(
+            util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_FILE), "MBTilesFileSourceReader"));
+    }
+}
 
 std::unique_ptr<AsyncRequest> MBTilesFileSource::request(const Resource &resource, FileSource::Callback callback) {
     auto req = std::make_unique<FileSourceRequest>(std::move(callback));
 
     // assume if there is a tile request, that the mbtiles file has been validated
     if (resource.kind == Resource::Tile) {
-        thread->actor().invoke(&Impl::request_tile, resource, req->actor());
+        readers[nextReader++ % readers.size()]->actor().invoke(&Reader::request_tile, resource, req->actor());
         return req;
     }
 
@@ -1,6 +1,7 @@
 #include <mbgl/storage/offline_database.hpp>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/storage/sqlite3.hpp>
+#include <mbgl/tile/tile_id.hpp>
 #include <mbgl/util/compression.hpp>
 #include <mbgl/util/io.hpp>
 #include <mbgl/util/string.hpp>
@@ -11,10 +12,119 @@
 #include <mbgl/storage/offline_schema.hpp>
 #include <mbgl/storage/merge_sideloaded.hpp>
 
+#include <algorithm>
+#include <cstring>
+
 namespace mbgl {
 
-OfflineDatabase::OfflineDatabase(std::string path_, const TileServerOptions& options)
-    : path(std::move(path_)), tileServerOptions(options) {
+namespace {
+
+// Version of the schema created by createSchema() and reached by the last migration. Readers only
+// open databases the writer has migrated to it.
+constexpr int64_t currentSchemaVersion = 9;
+
+// Accessed timestamps are only used to order the ambient cache for eviction, so reads
+// record them in memory and write them in batches.
+constexpr std::size_t accessedTimestampsBatchSize = 256;
+constexpr Seconds accessedTimestampsFlushInterval{30};
+
+// Version 1 of the preset dictionary for compressing tiles: a hand-picked list of layer names,
+// keys and values of the OpenMapTiles and Mapbox Streets schemas, encoded the way they occur in a
+// tile so that matches span their protobuf tags and lengths too. The ones expected to be the most
+// frequent come last, where they are the cheapest to refer to. Tiles stored with
+// Codec::ZlibTileDictionaryV1 can only be read with this exact dictionary: a changed dictionary
+// needs a new version, and a new codec value to go with it.
+const std::string& tileDictionaryV1() {
+    static const std::string dictionary = [] {
+        // clang-format off
+        const char* const values[] = {
+            "motorway", "trunk", "primary", "secondary", "tertiary", "minor", "residential", "service",
+            "track", "path", "rail", "transit", "street", "street_limited", "link", "motorway_link",
+            "bridge", "tunnel", "ford", "none", "false", "true", "yes", "no",
+            "water", "river", "stream", "canal", "drain", "ditch", "wood", "forest",
+            "grass", "scrub", "park", "farmland", "wetland", "sand", "rock", "ice",
+            "cemetery", "hospital", "school", "country", "state", "city", "town", "village",
+            "hamlet", "suburb", "neighbourhood",
+        };
+        const char* const layers[] = {
+            "aerodrome_label", "aeroway", "boundary", "building", "housenumber", "landcover",
+            "landuse", "mountain_peak", "park", "place", "poi", "transportation",
+            "transportation_name", "water", "water_name", "waterway", "admin", "barrier_line",
+            "country_label", "hillshade", "housenum_label", "landuse_overlay", "marine_label", "motorway_junction",
+            "place_label", "poi_label", "rail_station_label", "road", "road_label", "state_label",
+            "waterway_label", "contour",
+        };
+        const char* const keys[] = {
+            "ldir", "len", "structure", "maki", "scalerank", "localrank", "type", "index",
+            "ele_ft", "ele", "intermittent", "housenumber", "hide_3d", "colour", "render_min_height", "render_height",
+            "network", "ref_length", "ref", "iso_3166_1", "iso_a2", "capital", "rank", "maritime",
+            "disputed", "admin_level", "surface", "service", "indoor", "level", "layer", "ramp",
+            "oneway", "brunnel", "name_zh", "name_ru", "name_fr", "name_es", "name_int", "name:nonlatin",
+            "name:latin", "name_de", "name_en", "name", "subclass", "class",
+        };
+        // clang-format on
+
+        std::string result;
+        for (const char* value : values) {
+            const auto length = static_cast<char>(std::strlen(value));
+            result += '\x22'; // Layer.values, holding a Value.string_value
+            result += static_cast<char>(length + 2);
+            result += '\x0a';
+            result += length;
+            result += value;
+        }
+        for (const char* layer : layers) {
+            result += '\x0a'; // Layer.name
+            result += static_cast<char>(std::strlen(layer));
+            result += layer;
+        }
+        for (const char* key : keys) {
+            result += '\x1a'; // Layer.keys
+            result += static_cast<char>(std::strlen(key));
+            result += key;
+        }
+        // Layer.extent = 4096, Layer.version = 2
+        result += "\x28\x80\x20\x78\x02";
+        return result;
+    }();
+    return dictionary;
+}
+
+// Leading bytes of the image formats that are compressed already, and that are not worth
+// passing through Deflate again.
+bool isCompressedImage(const std::string& data) {
+    return data.compare(0, 4, "\x89PNG") == 0 || data.compare(0, 3, "\xFF\xD8\xFF") == 0 ||
+           (data.compare(0, 4, "RIFF") == 0 && data.size() >= 12 && data.compare(8, 4, "WEBP") == 0);
+}
+
+// Takes the data read from the database, and returns it as is when it isn't compressed.
+std::string decode(std::string data, OfflineDatabase::Codec codec) {
+    switch (codec) {
+    case OfflineDatabase::Codec::None:
+        return data;
+    case OfflineDatabase::Codec::Zlib:
+        return util::decompress(data);
+    case OfflineDatabase::Codec::ZlibTileDictionaryV1:
+        return util::decompressWithDictionary(data, tileDictionaryV1());
+    }
+    throw std::runtime_error("unknown codec " + util::toString(static_cast<int64_t>(codec)));
+}
+
+// 64-bit FNV-1a hash of the tile contents, used to find the tile_data rows worth comparing
+// with. SQLite integers are signed, so the hash is stored as its two's complement.
+int64_t contentHash(const std::string& data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<int64_t>(hash);
+}
+
+} // namespace
+
+OfflineDatabase::OfflineDatabase(std::string path_, const TileServerOptions& options, Access access_)
+    : path(std::move(path_)), tileServerOptions(options), access(access_) {
     try {
         initialize();
     } catch (...) {
@@ -40,11 +150,29 @@ void OfflineDatabase::initialize() {
         return;
     }
 
+    if (access == Access::Reader) {
+        db = std::make_unique<mapbox::sqlite::Database>(mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadWrite));
+        db->setBusyTimeout(Milliseconds::max());
+        db->exec("PRAGMA foreign_keys = ON");
+
+        if (getPragma<int64_t>("PRAGMA user_version") != currentSchemaVersion) {
+            statements.clear();
+            db.reset();
+            throw std::runtime_error("Database isn't migrated to the current schema yet");
+        }
+
+        db->exec("PRAGMA mmap_size = 67108864");
+        db->exec("PRAGMA recursive_triggers = ON");
+        return;
+    }
+
     db = std::make_unique<mapbox::sqlite::Database>(
         mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadWriteCreate));
     db->setBusyTimeout(Milliseconds::max());
     db->exec("PRAGMA foreign_keys = ON");
 
+    // Bumping the schema version requires a migration, and a case for it below.
+    static_assert(currentSchemaVersion == 9, "Add a migration to the new schema version");
     const auto userVersion = getPragma<int64_t>("PRAGMA user_version");
     switch (userVersion) {
     case 0:
@@ -52,7 +180,7 @@ void OfflineDatabase::initialize() {
         // Newly created database, or old cache-only database; remove old table if it exists.
         removeOldCacheTable();
         createSchema();
-        return;
+        break;
     case 2:
         migrateToVersion3();
         // fall through
@@ -66,13 +194,34 @@ void OfflineDatabase::initialize() {
         migrateToVersion6();
         // fall through
     case 6:
+        migrateToVersion7();
+        // fall through
+    case 7:
+        migrateToVersion8();
+        // fall through
+    case 8:
+        migrateToVersion9();
+        // fall through
+    case currentSchemaVersion:
         // Happy path; we're done
-        return;
+        break;
     default:
         // Downgrade: delete the database and try to reinitialize.
         removeExisting();
         initialize();
+        return;
     }
+
+    // Readers don't block behind the writer in WAL mode. The journal mode persists in the
+    // database file, while the synchronous setting applies to this connection only.
+    db->exec("PRAGMA journal_mode = WAL");
+    db->exec("PRAGMA synchronous = NORMAL");
+    // Reads map up to 64 MB of the database file instead of copying its pages through the page
+    // cache.
+    db->exec("PRAGMA mmap_size = 67108864");
+    // REPLACE deletes the rows it replaces without running the delete triggers otherwise, which
+    // would leave the reference counts of tile_data behind.
+    db->exec("PRAGMA recursive_triggers = ON");
 }
 
 void OfflineDatabase::changePath(const std::string& path_) {
@@ -83,6 +232,12 @@ void OfflineDatabase::changePath(const std::string& path_) {
 }
 
 void OfflineDatabase::cleanup() {
+    try {
+        flushAccessedTimestamps();
+    } catch (...) {
+        handleError("update timestamps");
+    }
+
     // Deleting these SQLite objects may result in exceptions
     try {
         statements.clear();
@@ -148,12 +303,25 @@ void OfflineDatabase::handleError(const char* action) {
 }
 
 void OfflineDatabase::removeExisting() {
-    Log::Warning(Event::Database, "Removing existing incompatible offline database");
-
+    accessedTiles.clear();
+    accessedResources.clear();
+    evictionPending = false;
     statements.clear();
     db.reset();
 
+    if (access == Access::Reader) {
+        // The owner of the file removes it; this connection is reopened by the next statement.
+        return;
+    }
+
+    Log::Warning(Event::Database, "Removing existing incompatible offline database");
+    if (removalCallback) {
+        removalCallback();
+    }
+
     util::deleteFile(path);
+    util::deleteFile(path + "-wal");
+    util::deleteFile(path + "-shm");
 }
 
 void OfflineDatabase::removeOldCacheTable() {
@@ -173,7 +341,7 @@ void OfflineDatabase::createSchema() {
     db->exec("PRAGMA synchronous = FULL");
     mapbox::sqlite::Transaction transaction(*db);
     db->exec(offlineDatabaseSchema);
-    db->exec("PRAGMA user_version = 6");
+    db->exec("PRAGMA user_version = " + std::to_string(currentSchemaVersion));
     transaction.commit();
 }
 
@@ -188,6 +356,8 @@ void OfflineDatabase::migrateToVersion3() {
 // Schema version 4 was WAL journal + NORMAL sync. It was reverted during pre-
 // release development and the migration was removed entirely to avoid potential
 // conflicts from quickly (and needlessly) switching journal and sync modes.
+// WAL is now enabled by initialize() whenever the database is opened for writing,
+// independently of the schema version.
 //
 // See: https://github.com/mapbox/mapbox-gl-native/pull/6320
 
@@ -211,6 +381,89 @@ void OfflineDatabase::migrateToVersion6() {
     transaction.commit();
 }
 
+void OfflineDatabase::migrateToVersion7() {
+    assert(db);
+    checkFlags();
+
+    // clang-format off
+    mapbox::sqlite::Transaction transaction(*db);
+    db->exec("ALTER TABLE resources ADD COLUMN ambient INTEGER NOT NULL DEFAULT 1");
+    db->exec("ALTER TABLE tiles ADD COLUMN ambient INTEGER NOT NULL DEFAULT 1");
+    db->exec("UPDATE resources SET ambient = 0 WHERE id IN (SELECT resource_id FROM region_resources)");
+    db->exec("UPDATE tiles SET ambient = 0 WHERE id IN (SELECT tile_id FROM region_tiles)");
+    db->exec("DROP INDEX IF EXISTS resources_accessed");
+    db->exec("DROP INDEX IF EXISTS tiles_accessed");
+    db->exec("CREATE INDEX resources_ambient_accessed ON resources (ambient, accessed)");
+    db->exec("CREATE INDEX tiles_ambient_accessed ON tiles (ambient, accessed)");
+    db->exec(
+        "CREATE TRIGGER region_resources_insert AFTER INSERT ON region_resources "
+        "BEGIN UPDATE resources SET ambient = 0 WHERE id = NEW.resource_id; END");
+    db->exec(
+        "CREATE TRIGGER region_resources_delete AFTER DELETE ON region_resources "
+        "WHEN NOT EXISTS (SELECT 1 FROM region_resources WHERE resource_id = OLD.resource_id) "
+        "BEGIN UPDATE resources SET ambient = 1 WHERE id = OLD.resource_id; END");
+    db->exec(
+        "CREATE TRIGGER region_tiles_insert AFTER INSERT ON region_tiles "
+        "BEGIN UPDATE tiles SET ambient = 0 WHERE id = NEW.tile_id; END");
+    db->exec(
+        "CREATE TRIGGER region_tiles_delete AFTER DELETE ON region_tiles "
+        "WHEN NOT EXISTS (SELECT 1 FROM region_tiles WHERE tile_id = OLD.tile_id) "
+        "BEGIN UPDATE tiles SET ambient = 1 WHERE id = OLD.tile_id; END");
+    db->exec("PRAGMA user_version = 7");
+    transaction.commit();
+    // clang-format on
+}
+
+// Version 8 adds codec values to the `compressed` column. Existing rows keep their meaning, but
+// older versions can't read the rows written with the new codecs.
+void OfflineDatabase::migrateToVersion8() {
+    assert(db);
+    checkFlags();
+
+    db->exec("PRAGMA user_version = 8");
+}
+
+// Version 9 stores the contents of tiles in tile_data, shared by the tiles with identical
+// contents. Existing tiles keep their contents inline until they are written again.
+void OfflineDatabase::migrateToVersion9() {
+    assert(db);
+    checkFlags();
+
+    // clang-format off
+    mapbox::sqlite::Transaction transaction(*db);
+    db->exec(
+        "CREATE TABLE tile_data ("
+        "  id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT,"
+        "  hash INTEGER NOT NULL,"
+        "  data BLOB NOT NULL,"
+        "  compressed INTEGER NOT NULL DEFAULT 0,"
+        "  refcount INTEGER NOT NULL DEFAULT 0)");
+    db->exec("CREATE INDEX tile_data_hash ON tile_data (hash)");
+    db->exec("ALTER TABLE tiles ADD COLUMN data_id INTEGER REFERENCES tile_data(id)");
+    db->exec(
+        "CREATE TRIGGER tiles_data_insert AFTER INSERT ON tiles "
+        "WHEN NEW.data_id IS NOT NULL "
+        "BEGIN UPDATE tile_data SET refcount = refcount + 1 WHERE id = NEW.data_id; END");
+    db->exec(
+        "CREATE TRIGGER tiles_data_update AFTER UPDATE OF data_id ON tiles "
+        "WHEN OLD.data_id IS NOT NEW.data_id "
+        "BEGIN "
+        "UPDATE tile_data SET refcount = refcount + 1 WHERE id = NEW.data_id; "
+        "UPDATE tile_data SET refcount = refcount - 1 WHERE id = OLD.data_id; "
+        "DELETE FROM tile_data WHERE id = OLD.data_id AND refcount <= 0; "
+        "END");
+    db->exec(
+        "CREATE TRIGGER tiles_data_delete AFTER DELETE ON tiles "
+        "WHEN OLD.data_id IS NOT NULL "
+        "BEGIN "
+        "UPDATE tile_data SET refcount = refcount - 1 WHERE id = OLD.data_id; "
+        "DELETE FROM tile_data WHERE id = OLD.data_id AND refcount <= 0; "
+        "END");
+    db->exec("PRAGMA user_version = 9");
+    transaction.commit();
+    // clang-format on
+}
+
 void OfflineDatabase::vacuum() {
     assert(db);
     checkFlags();
@@ -246,12 +499,208 @@ std::optional<Response> OfflineDatabase::get(const Resource& resource) try {
     }
 
     auto result = getInternal(resource);
+    if (accessedTimestampsPending()) {
+        flushAccessedTimestamps();
+    }
     return result ? std::optional<Response>{ result->first } : std::nullopt;
 } catch (...) {
     handleError("read resource");
     return std::nullopt;
 }
 
+void OfflineDatabase::markAccessed(const Resource& resource) try {
+    if (readOnly || disabled()) {
+        return;
+    }
+
+    if (resource.kind == Resource::Kind::Tile) {
+        assert(resource.tileData);
+        const Resource::TileData& tile = *resource.tileData;
+        // clang-format off
+        mapbox::sqlite::Query query{ getStatement(
+            "SELECT id FROM tiles "
+            "WHERE url_template = ?1 "
+            "  AND pixel_ratio  = ?2 "
+            "  AND x            = ?3 "
+            "  AND y            = ?4 "
+            "  AND z            = ?5 ") };
+        // clang-format on
+        query.bind(1, tile.urlTemplate);
+        query.bind(2, tile.pixelRatio);
+        query.bind(3, tile.x);
+        query.bind(4, tile.y);
+        query.bind(5, tile.z);
+        if (query.run()) {
+            recordAccess(accessedTiles, query.get<int64_t>(0));
+        }
+    } else {
+        mapbox::sqlite::Query query{getStatement("SELECT id FROM resources WHERE url = ?")};
+        query.bind(1, resource.url);
+        if (query.run()) {
+            recordAccess(accessedResources, query.get<int64_t>(0));
+        }
+    }
+
+    if (accessedTimestampsPending()) {
+        flushAccessedTimestamps();
+    }
+} catch (...) {
+    handleError("mark resource accessed");
+}
+
+std::vector<std::optional<Response>> OfflineDatabase::getTiles(const std::string& urlTemplate,
+                                                              uint8_t pixelRatio,
+                                                              const std::vector<CanonicalTileID>& tileIDs) try {
+    std::vector<std::optional<Response>> result(tileIDs.size());
+    if (tileIDs.empty() || disabled()) {
+        return result;
+    }
+
+    std::map<uint8_t, std::vector<std::size_t>> indicesByZoom;
+    for (std::size_t i = 0; i < tileIDs.size(); ++i) {
+        indicesByZoom[tileIDs[i].z].push_back(i);
+    }
+
+    for (const auto& level : indicesByZoom) {
+        const uint8_t z = level.first;
+        const auto& indices = level.second;
+
+        uint32_t minX = tileIDs[indices.front()].x;
+        uint32_t maxX = minX;
+        uint32_t minY = tileIDs[indices.front()].y;
+        uint32_t maxY = minY;
+        for (std::size_t i : indices) {
+            minX = std::min(minX, tileIDs[i].x);
+            maxX = std::max(maxX, tileIDs[i].x);
+            minY = std::min(minY, tileIDs[i].y);
+            maxY = std::max(maxY, tileIDs[i].y);
+        }
+
+        // Tile covers are close to rectangles, so reading the bounding box of the tiles returns
+        // few rows that weren't asked for. Scattered tiles are looked up one by one instead.
+        const uint64_t area = uint64_t(maxX - minX + 1) * (maxY - minY + 1);
+        if (indices.size() == 1 || area > 4 * indices.size()) {
+            for (std::size_t i : indices) {
+                const Resource::TileData tile{urlTemplate,
+                                              pixelRatio,
+                                              static_cast<int32_t>(tileIDs[i].x),
+                                              static_cast<int32_t>(tileIDs[i].y),
+                                              static_cast<int8_t>(z)};
+                if (auto response = getTile(tile)) {
+                    result[i] = std::move(response->first);
+                }
+            }
+            continue;
+        }
+
+        std::multimap<std::pair<uint32_t, uint32_t>, std::size_t> wanted;
+        for (std::size_t i : indices) {
+            wanted.emplace(std::make_pair(tileIDs[i].x, tileIDs[i].y), i);
+        }
+
+        // clang-format off
+        mapbox::sqlite::Query query{ getStatement(
+            //        0      1           2,            3,                4,                             5,                   6   7  8
+            "SELECT etag, expires, must_revalidate, modified, IFNULL(d.data, t.data), IFNULL(d.compressed, t.compressed), t.id, x, y "
+            "FROM tiles t "
+            "LEFT JOIN tile_data d ON d.id = t.data_id "
+            "WHERE url_template = ?1 "
+            "  AND pixel_ratio  = ?2 "
+            "  AND z            = ?3 "
+            "  AND x BETWEEN ?4 AND ?5 "
+            "  AND y BETWEEN ?6 AND ?7 ") };
+        // clang-format on
+
+        query.bind(1, urlTemplate);
+        query.bind(2, pixelRatio);
+        query.bind(3, z);
+        query.bind(4, int64_t(minX));
+        query.bind(5, int64_t(maxX));
+        query.bind(6, int64_t(minY));
+        query.bind(7, int64_t(maxY));
+
+        while (query.run()) {
+            const auto range = wanted.equal_range(
+                std::make_pair(static_cast<uint32_t>(query.get<int64_t>(7)), static_cast<uint32_t>(query.get<int64_t>(8))));
+            if (range.first == range.second) {
+                continue;
+            }
+            Response response = readTile(query).first;
+            for (auto it = range.first; it != range.second; ++it) {
+                result[it->second] = response;
+            }
+        }
+    }
+
+    if (accessedTimestampsPending()) {
+        flushAccessedTimestamps();
+    }
+    return result;
+} catch (...) {
+    handleError("read tiles");
+    return std::vector<std::optional<Response>>(tileIDs.size());
+}
+
+void OfflineDatabase::recordAccess(std::map<int64_t, Timestamp>& accessed, int64_t id) {
+    const Timestamp now = util::now();
+    if (accessedTiles.empty() && accessedResources.empty()) {
+        firstAccess = now;
+    }
+    accessed[id] = now;
+}
+
+bool OfflineDatabase::accessedTimestampsPending() const {
+    const std::size_t count = accessedTiles.size() + accessedResources.size();
+    return count >= accessedTimestampsBatchSize ||
+           (count > 0 && util::now() - firstAccess >= accessedTimestampsFlushInterval);
+}
+
+void OfflineDatabase::flushAccessedTimestamps() {
+    if (!db || (accessedTiles.empty() && accessedResources.empty())) {
+        return;
+    }
+
+    try {
+        mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
+        writeAccessedTimestamps();
+        transaction.commit();
+    } catch (const mapbox::sqlite::Exception& ex) {
+        if (ex.code == mapbox::sqlite::ResultCode::NotADB || ex.code == mapbox::sqlite::ResultCode::Corrupt) {
+            throw;
+        }
+
+        // If we don't have any indication that the database is corrupt, continue as usual. The
+        // timestamps are dropped rather than retried on every read.
+        accessedTiles.clear();
+        accessedResources.clear();
+        Log::Warning(Event::Database, static_cast<int>(ex.code), std::string("Can't update timestamp: ") + ex.what());
+    }
+}
+
+void OfflineDatabase::writeAccessedTimestamps() {
+    // Rows deleted since they were read are not updated.
+    const auto tiles = std::move(accessedTiles);
+    const auto resources = std::move(accessedResources);
+    accessedTiles.clear();
+    accessedResources.clear();
+
+    mapbox::sqlite::Query tileQuery{getStatement("UPDATE tiles SET accessed = ?1 WHERE id = ?2")};
+    for (const auto& tile : tiles) {
+        tileQuery.bind(1, tile.second);
+        tileQuery.bind(2, tile.first);
+        tileQuery.run();
+        tileQuery.reset();
+    }
+
+    mapbox::sqlite::Query resourceQuery{getStatement("UPDATE resources SET accessed = ?1 WHERE id = ?2")};
+    for (const auto& resource : resources) {
+        resourceQuery.bind(1, resource.second);
+        resourceQuery.bind(2, resource.first);
+        resourceQuery.run();
+        resourceQuery.reset();
+    }
+}
+
 std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getInternal(const Resource& resource) {
     if (resource.kind == Resource::Kind::Tile) {
         assert(resource.tileData);
@@ -290,6 +739,26 @@ std::pair<bool, uint64_t> OfflineDatabase::put(const Resource& resource, const R
     return {false, 0};
 }
 
+void OfflineDatabase::putResources(const std::list<std::tuple<Resource, Response>>& resources) try {
+    if (readOnly || resources.empty()) return;
+
+    if (!db) {
+        initialize();
+    }
+
+    if (disabled()) {
+        return;
+    }
+
+    mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
+    for (const auto& resource : resources) {
+        putInternal(std::get<0>(resource), std::get<1>(resource), true);
+    }
+    transaction.commit();
+} catch (...) {
+    handleError("write resources");
+}
+
 std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource, const Response& response, bool evict_) {
     checkFlags();
 
@@ -297,36 +766,63 @@ std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource,
         return { false, 0 };
     }
 
+    const bool tile = resource.kind == Resource::Kind::Tile;
+    static const std::string empty;
+    const std::string& data = response.data ? *response.data : empty;
     std::string compressedData;
-    bool compressed = false;
+    Codec codec = Codec::None;
     uint64_t size = 0;
 
-    if (response.data) {
-        compressedData = util::compress(*response.data);
-        compressed = compressedData.size() < response.data->size();
-        size = compressed ? compressedData.size() : response.data->size();
+    const auto encode = [&] {
+        if (response.data && !isCompressedImage(data)) {
+            compressedData = tile ? util::compressWithDictionary(data, tileDictionaryV1()) : util::compress(data);
+            if (compressedData.size() < data.size()) {
+                codec = tile ? Codec::ZlibTileDictionaryV1 : Codec::Zlib;
+            }
+        }
+        size = codec != Codec::None ? compressedData.size() : data.size();
+    };
+
+    // Tiles whose contents are in tile_data already share its row, and skip the compression.
+    std::optional<int64_t> hash;
+    std::optional<std::pair<int64_t, uint64_t>> shared;
+    if (tile && !response.noContent && !response.notModified) {
+        hash = contentHash(data);
+        shared = findTileData(*hash, data);
+    }
+
+    if (!shared) {
+        encode();
     }
 
     std::optional<DatabaseSizeChangeStats> stats;
     if (evict_) {
         stats = DatabaseSizeChangeStats(this);
-        if (!evict(size, *stats)) {
+        if (!evict(shared ? 0 : size, *stats, insertEvictionBudget)) {
             Log::Info(Event::Database, "Unable to make space for entry");
             return {false, 0};
         }
+        // The shared row goes away when eviction deletes the last tiles using it.
+        if (shared && !hasTileData(shared->first)) {
+            shared = std::nullopt;
+            encode();
+        }
     }
 
     bool inserted;
 
-    if (resource.kind == Resource::Kind::Tile) {
+    if (tile) {
         assert(resource.tileData);
-        inserted = putTile(*resource.tileData, response,
-                compressed ? compressedData : response.data ? *response.data : "",
-                compressed);
+        std::optional<int64_t> dataID;
+        if (shared) {
+            dataID = shared->first;
+            size = shared->second;
+        } else if (hash) {
+            dataID = putTileData(*hash, codec != Codec::None ? compressedData : data, codec);
+        }
+        inserted = putTile(*resource.tileData, response, dataID);
     } else {
-        inserted = putResource(resource, response,
-                compressed ? compressedData : response.data ? *response.data : "",
-                compressed);
+        inserted = putResource(resource, response, codec != Codec::None ? compressedData : data, codec);
     }
 
     if (stats) {
@@ -337,27 +833,10 @@ std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource,
 }
 
 std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getResource(const Resource& resource) {
-    // Update accessed timestamp used for LRU eviction.
-    if (!readOnly) {
-        try {
-            mapbox::sqlite::Query accessedQuery{getStatement("UPDATE resources SET accessed = ?1 WHERE url = ?2")};
-            accessedQuery.bind(1, util::now());
-            accessedQuery.bind(2, resource.url);
-            accessedQuery.run();
-        } catch (const mapbox::sqlite::Exception& ex) {
-            if (ex.code == mapbox::sqlite::ResultCode::NotADB || ex.code == mapbox::sqlite::ResultCode::Corrupt) {
-                throw;
-            }
-
-            // If we don't have any indication that the database is corrupt, continue as usual.
-            Log::Warning(Event::Database, static_cast<int>(ex.code), std::string("Can't update timestamp: ") + ex.what());
-        }
-    }
-
     // clang-format off
     mapbox::sqlite::Query query{ getStatement(
-        //        0      1            2            3       4      5
-        "SELECT etag, expires, must_revalidate, modified, data, compressed "
+        //        0      1            2            3       4      5        6
+        "SELECT etag, expires, must_revalidate, modified, data, compressed, id "
         "FROM resources "
         "WHERE url = ?") };
     // clang-format on
@@ -376,15 +855,18 @@ std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getResource(const
     response.mustRevalidate = query.get<bool>(2);
     response.modified       = query.get<std::optional<Timestamp>>(3);
 
+    // Update accessed timestamp used for LRU eviction.
+    if (!readOnly) {
+        recordAccess(accessedResources, query.get<int64_t>(6));
+    }
+
     auto data = query.get<std::optional<std::string>>(4);
     if (!data) {
         response.noContent = true;
-    } else if (query.get<bool>(5)) {
-        response.data = std::make_shared<std::string>(util::decompress(*data));
-        size = data->length();
     } else {
-        response.data = std::make_shared<std::string>(*data);
+        // The data is copied once out of the database, then moved into the response.
         size = data->length();
+        response.data = std::make_shared<std::string>(decode(std::move(*data), static_cast<Codec>(query.get<int64_t>(5))));
     }
 
     return std::make_pair(response, size);
@@ -403,7 +885,7 @@ std::optional<int64_t> OfflineDatabase::hasResource(const Resource& resource) {
 bool OfflineDatabase::putResource(const Resource& resource,
                                   const Response& response,
                                   const std::string& data,
-                                  bool compressed) {
+                                  Codec codec) {
     checkFlags();
 
     if (response.notModified) {
@@ -452,7 +934,7 @@ bool OfflineDatabase::putResource(const Resource& resource,
         updateQuery.bind(8, false);
     } else {
         updateQuery.bindBlob(7, data.data(), data.size(), false);
-        updateQuery.bind(8, compressed);
+        updateQuery.bind(8, static_cast<int64_t>(codec));
     }
 
     updateQuery.run();
@@ -479,7 +961,7 @@ bool OfflineDatabase::putResource(const Resource& resource,
         insertQuery.bind(9, false);
     } else {
         insertQuery.bindBlob(8, data.data(), data.size(), false);
-        insertQuery.bind(9, compressed);
+        insertQuery.bind(9, static_cast<int64_t>(codec));
     }
 
     insertQuery.run();
@@ -488,42 +970,12 @@ bool OfflineDatabase::putResource(const Resource& resource,
 }
 
 std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getTile(const Resource::TileData& tile) {
-    // Update accessed timestamp used for LRU eviction.
-    if (!readOnly) {
-        try {
-            // clang-format off
-            mapbox::sqlite::Query accessedQuery{ getStatement(
-                "UPDATE tiles "
-                "SET accessed       = ?1 "
-                "WHERE url_template = ?2 "
-                "  AND pixel_ratio  = ?3 "
-                "  AND x            = ?4 "
-                "  AND y            = ?5 "
-                "  AND z            = ?6 ") };
-            // clang-format on
-
-            accessedQuery.bind(1, util::now());
-            accessedQuery.bind(2, tile.urlTemplate);
-            accessedQuery.bind(3, tile.pixelRatio);
-            accessedQuery.bind(4, tile.x);
-            accessedQuery.bind(5, tile.y);
-            accessedQuery.bind(6, tile.z);
-            accessedQuery.run();
-        } catch (const mapbox::sqlite::Exception& ex) {
-            if (ex.code == mapbox::sqlite::ResultCode::NotADB || ex.code == mapbox::sqlite::ResultCode::Corrupt) {
-                throw;
-            }
-
-            // If we don't have any indication that the database is corrupt, continue as usual.
-            Log::Warning(Event::Database, static_cast<int>(ex.code), std::string("Can't update timestamp: ") + ex.what());
-        }
-    }
-
     // clang-format off
     mapbox::sqlite::Query query{ getStatement(
-        //        0      1           2,            3,      4,      5
-        "SELECT etag, expires, must_revalidate, modified, data, compressed "
-        "FROM tiles "
+        //        0      1           2,            3,                4,                             5,                   6
+        "SELECT etag, expires, must_revalidate, modified, IFNULL(d.data, t.data), IFNULL(d.compressed, t.compressed), t.id "
+        "FROM tiles t "
+        "LEFT JOIN tile_data d ON d.id = t.data_id "
         "WHERE url_template = ?1 "
         "  AND pixel_ratio  = ?2 "
         "  AND x            = ?3 "
@@ -541,6 +993,10 @@ std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getTile(const Reso
         return std::nullopt;
     }
 
+    return readTile(query);
+}
+
+std::pair<Response, uint64_t> OfflineDatabase::readTile(mapbox::sqlite::Query& query) {
     Response response;
     uint64_t size = 0;
 
@@ -549,25 +1005,29 @@ std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getTile(const Reso
     response.mustRevalidate  = query.get<bool>(2);
     response.modified        = query.get<std::optional<Timestamp>>(3);
 
+    // Update accessed timestamp used for LRU eviction.
+    if (!readOnly) {
+        recordAccess(accessedTiles, query.get<int64_t>(6));
+    }
+
     std::optional<std::string> data = query.get<std::optional<std::string>>(4);
     if (!data) {
         response.noContent = true;
-    } else if (query.get<bool>(5)) {
-        response.data = std::make_shared<std::string>(util::decompress(*data));
-        size = data->length();
     } else {
-        response.data = std::make_shared<std::string>(*data);
+        // The data is copied once out of the database, then moved into the response.
         size = data->length();
+        response.data = std::make_shared<std::string>(decode(std::move(*data), static_cast<Codec>(query.get<int64_t>(5))));
     }
 
-    return std::make_pair(response, size);
+    return std::make_pair(std::move(response), size);
 }
 
 std::optional<int64_t> OfflineDatabase::hasTile(const Resource::TileData& tile) {
     // clang-format off
     mapbox::sqlite::Query size{ getStatement(
-        "SELECT length(data) "
-        "FROM tiles "
+        "SELECT length(IFNULL(d.data, t.data)) "
+        "FROM tiles t "
+        "LEFT JOIN tile_data d ON d.id = t.data_id "
         "WHERE url_template = ?1 "
         "  AND pixel_ratio  = ?2 "
         "  AND x            = ?3 "
@@ -590,8 +1050,7 @@ std::optional<int64_t> OfflineDatabase::hasTile(const Resource::TileData& tile)
 
 bool OfflineDatabase::putTile(const Resource::TileData& tile,
                               const Response& response,
-                              const std::string& data,
-                              bool compressed) {
+                              std::optional<int64_t> dataID) {
     checkFlags();
 
     if (response.notModified) {
@@ -620,7 +1079,8 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
         return false;
     }
 
-    // We can't use REPLACE because it would change the id value.
+    // We can't use REPLACE because it would change the id value. The contents written inline
+    // by older versions are dropped in favor of tile_data.
 
     // clang-format off
     mapbox::sqlite::Query updateQuery{ getStatement(
@@ -630,13 +1090,14 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
         "    expires         = ?3, "
         "    must_revalidate = ?4, "
         "    accessed        = ?5, "
-        "    data            = ?6, "
-        "    compressed      = ?7 "
-        "WHERE url_template  = ?8 "
-        "  AND pixel_ratio   = ?9 "
-        "  AND x             = ?10 "
-        "  AND y             = ?11 "
-        "  AND z             = ?12 ") };
+        "    data_id         = ?6, "
+        "    data            = NULL, "
+        "    compressed      = 0 "
+        "WHERE url_template  = ?7 "
+        "  AND pixel_ratio   = ?8 "
+        "  AND x             = ?9 "
+        "  AND y             = ?10 "
+        "  AND z             = ?11 ") };
     // clang-format on
 
     updateQuery.bind(1, response.modified);
@@ -644,18 +1105,16 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
     updateQuery.bind(3, response.expires);
     updateQuery.bind(4, response.mustRevalidate);
     updateQuery.bind(5, util::now());
-    updateQuery.bind(8, tile.urlTemplate);
-    updateQuery.bind(9, tile.pixelRatio);
-    updateQuery.bind(10, tile.x);
-    updateQuery.bind(11, tile.y);
-    updateQuery.bind(12, tile.z);
-
-    if (response.noContent) {
-        updateQuery.bind(6, nullptr);
-        updateQuery.bind(7, false);
+    updateQuery.bind(7, tile.urlTemplate);
+    updateQuery.bind(8, tile.pixelRatio);
+    updateQuery.bind(9, tile.x);
+    updateQuery.bind(10, tile.y);
+    updateQuery.bind(11, tile.z);
+
+    if (dataID) {
+        updateQuery.bind(6, *dataID);
     } else {
-        updateQuery.bindBlob(6, data.data(), data.size(), false);
-        updateQuery.bind(7, compressed);
+        updateQuery.bind(6, nullptr);
     }
 
     updateQuery.run();
@@ -665,8 +1124,8 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
 
     // clang-format off
     mapbox::sqlite::Query insertQuery{ getStatement(
-        "INSERT INTO tiles (url_template, pixel_ratio, x,  y,  z,  modified, must_revalidate, etag, expires, accessed,  data, compressed) "
-        "VALUES            (?1,           ?2,          ?3, ?4, ?5, ?6,       ?7,              ?8,   ?9,      ?10,       ?11,  ?12)") };
+        "INSERT INTO tiles (url_template, pixel_ratio, x,  y,  z,  modified, must_revalidate, etag, expires, accessed,  data_id) "
+        "VALUES            (?1,           ?2,          ?3, ?4, ?5, ?6,       ?7,              ?8,   ?9,      ?10,       ?11)") };
     // clang-format on
 
     insertQuery.bind(1, tile.urlTemplate);
@@ -680,12 +1139,10 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
     insertQuery.bind(9, response.expires);
     insertQuery.bind(10, util::now());
 
-    if (response.noContent) {
-        insertQuery.bind(11, nullptr);
-        insertQuery.bind(12, false);
+    if (dataID) {
+        insertQuery.bind(11, *dataID);
     } else {
-        insertQuery.bindBlob(11, data.data(), data.size(), false);
-        insertQuery.bind(12, compressed);
+        insertQuery.bind(11, nullptr);
     }
 
     insertQuery.run();
@@ -693,6 +1150,56 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
     return true;
 }
 
+std::optional<std::pair<int64_t, uint64_t>> OfflineDatabase::findTileData(int64_t hash, const std::string& data) {
+    // clang-format off
+    mapbox::sqlite::Query query{ getStatement(
+        "SELECT id, data, compressed "
+        "FROM tile_data "
+        "WHERE hash = ?1") };
+    // clang-format on
+
+    query.bind(1, hash);
+
+    // Hashes may collide, so the contents are compared as well.
+    while (query.run()) {
+        std::string stored = query.get<std::string>(1);
+        const uint64_t size = stored.size();
+        if (decode(std::move(stored), static_cast<Codec>(query.get<int64_t>(2))) == data) {
+            return std::make_pair(query.get<int64_t>(0), size);
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool OfflineDatabase::hasTileData(int64_t dataID) {
+    // clang-format off
+    mapbox::sqlite::Query query{ getStatement(
+        "SELECT 1 FROM tile_data WHERE id = ?1") };
+    // clang-format on
+
+    query.bind(1, dataID);
+    return query.run();
+}
+
+int64_t OfflineDatabase::putTileData(int64_t hash, const std::string& data, Codec codec) {
+    checkFlags();
+
+    // The reference count is maintained by the triggers on the tiles table.
+    // clang-format off
+    mapbox::sqlite::Query query{ getStatement(
+        "INSERT INTO tile_data (hash, data, compressed) "
+        "VALUES                (?1,   ?2,   ?3)") };
+    // clang-format on
+
+    query.bind(1, hash);
+    query.bindBlob(2, data.data(), data.size(), false);
+    query.bind(3, static_cast<int64_t>(codec));
+    query.run();
+
+    return query.lastInsertRowId();
+}
+
 std::exception_ptr OfflineDatabase::invalidateAmbientCache() try {
     checkFlags();
 
@@ -700,9 +1207,7 @@ std::exception_ptr OfflineDatabase::invalidateAmbientCache() try {
     mapbox::sqlite::Query tileQuery{ getStatement(
         "UPDATE tiles "
         "SET expires = 0, must_revalidate = 1 "
-        "WHERE id NOT IN ("
-        "    SELECT tile_id FROM region_tiles"
-        ")"
+        "WHERE ambient = 1"
     ) };
     // clang-format on
 
@@ -712,9 +1217,7 @@ std::exception_ptr OfflineDatabase::invalidateAmbientCache() try {
     mapbox::sqlite::Query resourceQuery{ getStatement(
         "UPDATE resources "
         "SET expires = 0, must_revalidate = 1 "
-        "WHERE id NOT IN ("
-        "    SELECT resource_id FROM region_resources"
-        ")"
+        "WHERE ambient = 1"
     ) };
     // clang-format on
 
@@ -728,13 +1231,12 @@ std::exception_ptr OfflineDatabase::invalidateAmbientCache() try {
 
 std::exception_ptr OfflineDatabase::clearAmbientCache() try {
     checkFlags();
+    flushAccessedTimestamps();
 
     // clang-format off
     mapbox::sqlite::Query tileQuery{ getStatement(
         "DELETE FROM tiles "
-        "WHERE id NOT IN ("
-        "    SELECT tile_id FROM region_tiles"
-        ")"
+        "WHERE ambient = 1"
     ) };
     // clang-format on
 
@@ -743,9 +1245,7 @@ std::exception_ptr OfflineDatabase::clearAmbientCache() try {
     // clang-format off
     mapbox::sqlite::Query resourceQuery{ getStatement(
         "DELETE FROM resources "
-        "WHERE id NOT IN ("
-        "    SELECT resource_id FROM region_resources"
-        ")"
+        "WHERE ambient = 1"
     ) };
     // clang-format on
 
@@ -858,12 +1358,12 @@ OfflineDatabase::mergeDatabase(const std::string& sideDatabasePath) {
         return unexpected<std::exception_ptr>(std::current_exception());
     }
     try {
-        // Support sideloaded databases at user_version = 6. Future schema version
-        // changes will need to implement migration paths for sideloaded databases at
-        // version 6.
+        // Support sideloaded databases from user_version = 6 up to the version of the main
+        // database. The merge only reads columns that exist since version 6; the ambient flag
+        // of version 7 is derived from the regions on the main side.
         auto sideUserVersion = static_cast<int>(getPragma<int64_t>("PRAGMA side.user_version"));
         const auto mainUserVersion = getPragma<int64_t>("PRAGMA user_version");
-        if (sideUserVersion < 6 || sideUserVersion != mainUserVersion) {
+        if (sideUserVersion < 6 || sideUserVersion > mainUserVersion) {
             throw std::runtime_error("Merge database has incorrect user_version");
         }
 
@@ -890,9 +1390,26 @@ OfflineDatabase::mergeDatabase(const std::string& sideDatabasePath) {
         }
         queryTiles.reset();
 
+        // The merge reads the side tiles through a view with their contents inline, which
+        // databases since version 9 keep in tile_data. Merged tiles keep them inline until
+        // they are written again.
+        db->exec("DROP VIEW IF EXISTS temp.side_tiles");
+        if (sideUserVersion >= 9) {
+            db->exec(
+                "CREATE TEMPORARY VIEW side_tiles AS "
+                "SELECT st.id, st.url_template, st.pixel_ratio, st.z, st.x, st.y, st.expires, st.modified, st.etag, "
+                "       IFNULL(sd.data, st.data) AS data, IFNULL(sd.compressed, st.compressed) AS compressed, "
+                "       st.accessed, st.must_revalidate "
+                "FROM side.tiles st "
+                "LEFT JOIN side.tile_data sd ON sd.id = st.data_id");
+        } else {
+            db->exec("CREATE TEMPORARY VIEW side_tiles AS SELECT * FROM side.tiles");
+        }
+
         mapbox::sqlite::Transaction transaction(*db);
         db->exec(mergeSideloadedDatabaseSQL);
         transaction.commit();
+        db->exec("DROP VIEW temp.side_tiles");
 
         // clang-format off
         mapbox::sqlite::Query queryRegions{ getStatement(
@@ -913,6 +1430,7 @@ OfflineDatabase::mergeDatabase(const std::string& sideDatabasePath) {
         // Explicit move to avoid triggering the copy constructor.
         return { std::move(result) };
     } catch (const std::runtime_error& ex) {
+        db->exec("DROP VIEW IF EXISTS temp.side_tiles");
         db->exec("DETACH DATABASE side");
         Log::Error(Event::Database, std::string(ex.what()));
 
@@ -949,6 +1467,10 @@ std::exception_ptr OfflineDatabase::deleteRegion(OfflineRegion&& region) try {
         query.run();
     }
 
+    // Resources that were only used by this region are part of the ambient cache now.
+    currentAmbientCacheSize = std::nullopt;
+
+    flushAccessedTimestamps();
     DatabaseSizeChangeStats stats(this);
     evict(0, stats);
     assert(db);
@@ -964,7 +1486,11 @@ std::exception_ptr OfflineDatabase::deleteRegion(OfflineRegion&& region) try {
 }
 
 std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getRegionResource(const Resource& resource) try {
-    return getInternal(resource);
+    auto result = getInternal(resource);
+    if (accessedTimestampsPending()) {
+        flushAccessedTimestamps();
+    }
+    return result;
 } catch (...) {
     handleError("read region resource");
     return std::nullopt;
@@ -1188,10 +1714,11 @@ std::pair<int64_t, int64_t> OfflineDatabase::getCompletedResourceCountAndSize(in
 std::pair<int64_t, int64_t> OfflineDatabase::getCompletedTileCountAndSize(int64_t regionID) {
     // clang-format off
     mapbox::sqlite::Query query{ getStatement(
-        "SELECT COUNT(*), SUM(LENGTH(data)) "
-        "FROM region_tiles, tiles "
-        "WHERE region_id = ?1 "
-        "AND tile_id = tiles.id ") };
+        "SELECT COUNT(*), SUM(LENGTH(IFNULL(tile_data.data, tiles.data))) "
+        "FROM region_tiles "
+        "JOIN tiles ON tile_id = tiles.id "
+        "LEFT JOIN tile_data ON tile_data.id = tiles.data_id "
+        "WHERE region_id = ?1 ") };
     // clang-format on
     query.bind(1, regionID);
     query.run();
@@ -1215,28 +1742,38 @@ T OfflineDatabase::getPragma(const char* sql) {
 // and as it approaches to the hard limit (i.e. the actual file size) we
 // delete an arbitrary number of old cache entries. The free pages approach saves
 // us from calling VACUUM or keeping a running total, which can be costly.
-bool OfflineDatabase::evict(uint64_t neededFreeSize, DatabaseSizeChangeStats& stats) {
+bool OfflineDatabase::evict(uint64_t neededFreeSize, DatabaseSizeChangeStats& stats, Duration budget) {
     checkFlags();
     uint64_t ambientCacheSize =
         (initAmbientCacheSize() == nullptr) ? *currentAmbientCacheSize : maximumAmbientCacheSize;
     uint64_t newAmbientCacheSize = ambientCacheSize + neededFreeSize + stats.pageSize();
+    const TimePoint deadline = budget == Duration::max() ? TimePoint::max() : Clock::now() + budget;
+
+    evictionPending = false;
+
+    // Eviction picks the least recently accessed entries, so it has to see every access.
+    if (newAmbientCacheSize > maximumAmbientCacheSize) {
+        writeAccessedTimestamps();
+    }
 
     while (newAmbientCacheSize > maximumAmbientCacheSize) {
+        // Both subqueries walk the (ambient, accessed) indexes, so a round reads one batch of
+        // rows from each table, however large the regions are.
         // clang-format off
         mapbox::sqlite::Query accessedQuery{ getStatement(
             "SELECT max(accessed) "
             "FROM ( "
-            "    SELECT accessed "
-            "    FROM resources "
-            "    LEFT JOIN region_resources "
-            "    ON resource_id = resources.id "
-            "    WHERE resource_id IS NULL "
+            "    SELECT accessed FROM ( "
+            "        SELECT accessed FROM resources "
+            "        WHERE ambient = 1 "
+            "        ORDER BY accessed ASC LIMIT ?1 "
+            "    ) "
             "  UNION ALL "
-            "    SELECT accessed "
-            "    FROM tiles "
-            "    LEFT JOIN region_tiles "
-            "    ON tile_id = tiles.id "
-            "    WHERE tile_id IS NULL "
+            "    SELECT accessed FROM ( "
+            "        SELECT accessed FROM tiles "
+            "        WHERE ambient = 1 "
+            "        ORDER BY accessed ASC LIMIT ?1 "
+            "    ) "
             "  ORDER BY accessed ASC LIMIT ?1 "
             ") "
         ) };
@@ -1250,13 +1787,8 @@ bool OfflineDatabase::evict(uint64_t neededFreeSize, DatabaseSizeChangeStats& st
         // clang-format off
         mapbox::sqlite::Query resourceQuery{ getStatement(
             "DELETE FROM resources "
-            "WHERE id IN ( "
-            "  SELECT id FROM resources "
-            "  LEFT JOIN region_resources "
-            "  ON resource_id = resources.id "
-            "  WHERE resource_id IS NULL "
-            "  AND accessed <= ?1 "
-            ") ") };
+            "WHERE ambient = 1 "
+            "AND accessed <= ?1 ") };
         // clang-format on
         resourceQuery.bind(1, accessed);
         resourceQuery.run();
@@ -1265,13 +1797,8 @@ bool OfflineDatabase::evict(uint64_t neededFreeSize, DatabaseSizeChangeStats& st
         // clang-format off
         mapbox::sqlite::Query tileQuery{ getStatement(
             "DELETE FROM tiles "
-            "WHERE id IN ( "
-            "  SELECT id FROM tiles "
-            "  LEFT JOIN region_tiles "
-            "  ON tile_id = tiles.id "
-            "  WHERE tile_id IS NULL "
-            "  AND accessed <= ?1 "
-            ") ") };
+            "WHERE ambient = 1 "
+            "AND accessed <= ?1 ") };
         // clang-format on
         tileQuery.bind(1, accessed);
         tileQuery.run();
@@ -1286,14 +1813,44 @@ bool OfflineDatabase::evict(uint64_t neededFreeSize, DatabaseSizeChangeStats& st
         if (resourceChanges == 0 && tileChanges == 0) {
             return false;
         }
+
+        // Each round releases at least one batch, so an insert always makes some progress.
+        // Whatever is left once the budget is spent is evicted later by evictAmbientCache().
+        if (newAmbientCacheSize > maximumAmbientCacheSize && Clock::now() >= deadline) {
+            evictionPending = true;
+            return true;
+        }
     }
 
     return true;
 }
 
+bool OfflineDatabase::evictAmbientCache(Duration budget) try {
+    checkFlags();
+    if (!evictionPending) {
+        return false;
+    }
+
+    mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
+    DatabaseSizeChangeStats stats(this);
+    if (!evict(0, stats, budget)) {
+        evictionPending = false;
+    }
+    transaction.commit();
+    updateAmbientCacheSize(stats);
+
+    return evictionPending;
+} catch (...) {
+    evictionPending = false;
+    handleError("evict ambient cache");
+    return false;
+}
+
 std::exception_ptr OfflineDatabase::initAmbientCacheSize() {
     if (!currentAmbientCacheSize) {
         try {
+            // Tile contents that a region tile shares aren't released by eviction, so they
+            // aren't counted here.
             // clang-format off
             mapbox::sqlite::Query query{ getStatement(
             "SELECT SUM(data) "
@@ -1311,11 +1868,20 @@ std::exception_ptr OfflineDatabase::initAmbientCacheSize() {
             "               + IFNULL(LENGTH(compressed), 0) "
             "               + IFNULL(LENGTH(accessed), 0) "
             "               + IFNULL(LENGTH(must_revalidate), 0) "
+            "               + IFNULL(LENGTH(data_id), 0) "
             "               ) as data "
             "    FROM tiles "
-            "    LEFT JOIN region_tiles "
-            "    ON tile_id = tiles.id "
-            "    WHERE tile_id IS NULL "
+            "    WHERE ambient = 1 "
+            "  UNION ALL "
+            "    SELECT SUM(LENGTH(data) "
+            "               + IFNULL(LENGTH(id), 0) "
+            "               + IFNULL(LENGTH(hash), 0) "
+            "               + IFNULL(LENGTH(compressed), 0) "
+            "               + IFNULL(LENGTH(refcount), 0) "
+            "               ) as data "
+            "    FROM tile_data "
+            "    WHERE id IN (SELECT data_id FROM tiles WHERE ambient = 1) "
+            "    AND id NOT IN (SELECT data_id FROM tiles WHERE ambient = 0 AND data_id IS NOT NULL) "
             "  UNION ALL "
             "    SELECT SUM(IFNULL(LENGTH(data), 0) "
             "               + IFNULL(LENGTH(id), 0) "
@@ -1329,9 +1895,7 @@ std::exception_ptr OfflineDatabase::initAmbientCacheSize() {
             "               + IFNULL(LENGTH(must_revalidate), 0) "
             "               ) as data "
             "    FROM resources "
-            "    LEFT JOIN region_resources "
-            "    ON resource_id = resources.id "
-            "    WHERE resource_id IS NULL "
+            "    WHERE ambient = 1 "
             ") ") };
             // clang-format on
             query.run();
@@ -1356,6 +1920,7 @@ std::exception_ptr OfflineDatabase::setMaximumAmbientCacheSize(uint64_t size) {
         maximumAmbientCacheSize = size;
 
         if (*currentAmbientCacheSize > maximumAmbientCacheSize) {
+            flushAccessedTimestamps();
             DatabaseSizeChangeStats stats(this);
             evict(0, stats);
             if (autopack) vacuum();
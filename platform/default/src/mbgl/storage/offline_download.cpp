@@ -22,7 +22,10 @@
 
 namespace {
 
-const size_t kResourcesBatchSize = 64;
+// Downloaded resources are written in a single transaction once this many are pending, or
+// when the first pending one has waited for the batch interval.
+const size_t kResourcesBatchSize = 512;
+const mbgl::Duration kResourcesBatchInterval = mbgl::Seconds(1);
 const size_t kMarkBatchSize = 200;
 
 } // namespace
@@ -86,6 +89,62 @@ uint64_t tileCount(const OfflineRegionDefinition& definition, style::SourceType
     return result;
 }
 
+// Enumerates the tiles of a tileset over the zoom levels of a region, one tile ahead.
+class OfflineDownload::TileStream {
+public:
+    TileStream(const OfflineRegionDefinition& definition_,
+               style::SourceType type,
+               uint16_t tileSize,
+               const Tileset& tileset)
+        : definition(definition_),
+          urlTemplate(tileset.tiles[0]),
+          scheme(tileset.scheme),
+          zoomRange(definition.match([&](auto& reg) { return coveringZoomRange(reg, type, tileSize, tileset.zoomRange); })),
+          z(zoomRange.min) {
+        advance();
+    }
+
+    bool empty() const { return !upcoming; }
+
+    Resource next() {
+        assert(upcoming);
+        auto tileResource = Resource::tile(urlTemplate,
+                                           definition.match([](auto& def) { return def.pixelRatio; }),
+                                           upcoming->x,
+                                           upcoming->y,
+                                           upcoming->z,
+                                           scheme);
+        advance();
+        return tileResource;
+    }
+
+private:
+    void advance() {
+        upcoming = std::nullopt;
+        for (; z <= zoomRange.max; z++) {
+            if (!cover) {
+                const auto zoom = static_cast<uint8_t>(z);
+                cover = definition.match(
+                    [&](const OfflineTilePyramidRegionDefinition& reg) { return std::make_unique<util::TileCover>(reg.bounds, zoom); },
+                    [&](const OfflineGeometryRegionDefinition& reg) { return std::make_unique<util::TileCover>(reg.geometry, zoom); });
+            }
+            if (auto tile = cover->next()) {
+                upcoming = tile->canonical;
+                return;
+            }
+            cover.reset();
+        }
+    }
+
+    const OfflineRegionDefinition& definition;
+    const std::string urlTemplate;
+    const Tileset::Scheme scheme;
+    const Range<uint8_t> zoomRange;
+    unsigned z;
+    std::unique_ptr<util::TileCover> cover;
+    std::optional<CanonicalTileID> upcoming;
+};
+
 // OfflineDownload
 
 OfflineDownload::OfflineDownload(int64_t id_,
@@ -232,6 +291,12 @@ void OfflineDownload::activateDownload() {
     status.downloadState = OfflineRegionDownloadState::Active;
     status.requiredResourceCount++;
 
+    activationTime = Clock::now();
+    downloadedTileCount = 0;
+    downloadedSize = 0;
+    commitDuration = Duration::zero();
+    commitCount = 0;
+
     auto styleResource = Resource::style(definition.match([](auto& reg){ return reg.styleURL; }));
     styleResource.setPriority(Resource::Priority::Low);
     styleResource.setUsage(Resource::Usage::Offline);
@@ -367,7 +432,7 @@ void OfflineDownload::activateDownload() {
    the first few errors is fruitless anyway.
 */
 void OfflineDownload::continueDownload() {
-    if (resourcesRemaining.empty()) {
+    if (!hasRemainingResources()) {
         // Flush pending buffers.
         if (!flushResourcesBuffer()) return;
         if (status.complete()) {
@@ -385,24 +450,43 @@ void OfflineDownload::continueDownload() {
         maxConcurrentRequests = static_cast<uint32_t>(*maxRequests);
     }
 
-    while (!resourcesRemaining.empty() && requests.size() < maxConcurrentRequests) {
-        ensureResource(std::move(resourcesRemaining.front()));
-        resourcesRemaining.pop_front();
+    while (requests.size() < maxConcurrentRequests) {
+        auto resource = nextResource();
+        if (!resource) {
+            break;
+        }
+        ensureResource(std::move(*resource));
     }
 }
 
 void OfflineDownload::deactivateDownload() {
     requiredSourceURLs.clear();
     resourcesRemaining.clear();
+    tilesRemaining.clear();
     requests.clear();
-    buffer.clear();
+
+    // Keep what was downloaded, so that it isn't requested again once the download resumes.
+    bufferTimer.stop();
+    if (!buffer.empty()) {
+        try {
+            offlineDatabase.putRegionResources(id, buffer, status);
+        } catch (const MapboxTileLimitExceededException&) {
+            // The download is deactivated because of the limit, which was reported already.
+        }
+        buffer.clear();
+    }
 }
 
 bool OfflineDownload::flushResourcesBuffer() {
+    bufferTimer.stop();
     if (buffer.empty()) return true;
     try {
+        const TimePoint commitStart = Clock::now();
         offlineDatabase.putRegionResources(id, buffer, status);
+        commitDuration += Clock::now() - commitStart;
+        commitCount++;
         buffer.clear();
+        updateThroughput();
         observer->statusChanged(status);
         return true;
     } catch (const MapboxTileLimitExceededException&) {
@@ -421,20 +505,55 @@ void OfflineDownload::queueResource(Resource&& resource) {
     resourcesRemaining.push_front(std::move(resource));
 }
 
+void OfflineDownload::updateThroughput() {
+    const double seconds = std::chrono::duration<double>(Clock::now() - activationTime).count();
+    if (seconds > 0) {
+        status.downloadedTilesPerSecond = downloadedTileCount / seconds;
+        status.downloadedBytesPerSecond = downloadedSize / seconds;
+    }
+    if (commitCount > 0) {
+        status.averageCommitDuration = commitDuration / static_cast<Duration::rep>(commitCount);
+    }
+}
+
 void OfflineDownload::queueTiles(SourceType type, uint16_t tileSize, const Tileset& tileset) {
-    tileCover(definition, type, tileSize, tileset.zoomRange, [&](const auto& tile) {
-        status.requiredResourceCount++;
-        status.requiredTileCount++;
+    // Counting walks the cover without keeping the tiles, which are enumerated again as they
+    // are requested, so that the required counts are precise from the start.
+    uint64_t count = 0;
+    tileCover(definition, type, tileSize, tileset.zoomRange, [&](const auto&) { count++; });
+    if (count == 0) {
+        return;
+    }
 
-        auto tileResource = Resource::tile(
-                tileset.tiles[0], definition.match([](auto& def) { return def.pixelRatio; }),
-                tile.x, tile.y, tile.z, tileset.scheme);
+    status.requiredResourceCount += count;
+    status.requiredTileCount += count;
+    tilesRemaining.push_back(std::make_unique<TileStream>(definition, type, tileSize, tileset));
+}
 
-        tileResource.setPriority(Resource::Priority::Low);
-        tileResource.setUsage(Resource::Usage::Offline);
+bool OfflineDownload::hasRemainingResources() const {
+    return !resourcesRemaining.empty() || !tilesRemaining.empty();
+}
 
-        resourcesRemaining.push_back(std::move(tileResource));
-    });
+std::optional<Resource> OfflineDownload::nextResource() {
+    if (!resourcesRemaining.empty()) {
+        Resource resource = std::move(resourcesRemaining.front());
+        resourcesRemaining.pop_front();
+        return resource;
+    }
+
+    if (tilesRemaining.empty()) {
+        return std::nullopt;
+    }
+
+    auto& tiles = *tilesRemaining.front();
+    Resource tileResource = tiles.next();
+    if (tiles.empty()) {
+        tilesRemaining.pop_front();
+    }
+
+    tileResource.setPriority(Resource::Priority::Low);
+    tileResource.setUsage(Resource::Usage::Offline);
+    return tileResource;
 }
 
 void OfflineDownload::markPendingUsedResources() {
@@ -507,13 +626,23 @@ void OfflineDownload::ensureResource(Resource&& resource,
                 callback(onlineResponse);
             }
 
+            if (resource.kind == Resource::Kind::Tile) {
+                downloadedTileCount++;
+            }
+            if (onlineResponse.data) {
+                downloadedSize += onlineResponse.data->size();
+            }
+
             // Queue up for batched insertion
+            if (buffer.empty()) {
+                bufferTimer.start(kResourcesBatchInterval, Duration::zero(), [this] { flushResourcesBuffer(); });
+            }
             buffer.emplace_back(resource, onlineResponse);
 
             // Flush buffer periodically.
-            // Have to keep `resourcesRemaining.empty()` as the following condition would fail otherwise.
+            // Have to keep `hasRemainingResources()` as the following condition would fail otherwise.
             // TODO: Simplify the tile count limit check code path!
-            if ((buffer.size() == kResourcesBatchSize || resourcesRemaining.empty()) && !flushResourcesBuffer()) return;
+            if ((buffer.size() >= kResourcesBatchSize || !hasRemainingResources()) && !flushResourcesBuffer()) return;
 
             if (offlineDatabase.exceedsOfflineMapboxTileCountLimit(resource)) {
                 onMapboxTileCountLimitExceeded();
@@ -22,12 +22,14 @@
 #include <mbgl/util/run_loop.hpp>
 #include <mbgl/util/thread.hpp>
 #include <mbgl/util/timer.hpp>
+#include <mbgl/util/url.hpp>
 
 #include <algorithm>
 #include <cassert>
-#include <list>
+#include <limits>
 #include <map>
 #include <utility>
+#include <vector>
 
 namespace mbgl {
 
@@ -61,6 +63,13 @@ struct OnlineFileRequest {
     std::function<void()> cancelCallback = nullptr;
     std::shared_ptr<Mailbox> mailbox;
 
+    // Host the request is queued for or counts against while it is active.
+    std::string host;
+
+    // Position and insertion order of the request in the pending requests heap.
+    std::size_t pendingIndex = std::numeric_limits<std::size_t>::max();
+    uint64_t pendingSequence = 0;
+
     // Counts the number of times a response was already expired when received. We're using
     // this to add a delay when making a new request so we don't keep retrying immediately
     // in case of a server serving expired tiles.
@@ -95,6 +104,16 @@ public:
         tasks.erase(it);
     }
 
+    void setRank(AsyncRequest* req, double rank) {
+        auto it = tasks.find(req);
+        if (it == tasks.end()) {
+            return;
+        }
+        OnlineFileRequest* request = it->second.get();
+        request->resource.rank = rank;
+        pendingRequests.update(request);
+    }
+
     void add(OnlineFileRequest* req) {
         allRequests.insert(req);
         if (resourceTransform) {
@@ -111,8 +130,8 @@ public:
 
     void remove(OnlineFileRequest* req) {
         allRequests.erase(req);
-        if (activeRequests.erase(req)) {
-            activatePendingRequest();
+        if (deactivateRequest(req)) {
+            activatePendingRequests();
         } else {
             pendingRequests.remove(req);
         }
@@ -123,24 +142,38 @@ public:
         assert(activeRequests.find(req) == activeRequests.end());
         assert(!req->request);
 
-        if (activeRequests.size() >= getMaximumConcurrentRequests()) {
-            queueRequest(req);
-        } else {
+        req->host = hostOf(req->resource.url);
+        if (canActivate(req->host)) {
             activateRequest(req);
+        } else {
+            queueRequest(req);
         }
     }
 
     void queueRequest(OnlineFileRequest* req) { pendingRequests.insert(req); }
 
+    // Whether there is room for a request to the host in the active set, overall and for the host.
+    bool canActivate(const std::string& host) const {
+        if (activeRequests.size() >= getMaximumConcurrentRequests()) {
+            return false;
+        }
+        if (maximumConcurrentRequestsPerHost == 0) {
+            return true;
+        }
+        auto it = activeRequestsPerHost.find(host);
+        return it == activeRequestsPerHost.end() || it->second < maximumConcurrentRequestsPerHost;
+    }
+
     void activateRequest(OnlineFileRequest* req) {
         auto callback = [=](const Response& response) {
-            activeRequests.erase(req);
+            deactivateRequest(req);
             req->request.reset();
             req->completed(response);
-            activatePendingRequest();
+            activatePendingRequests();
         };
 
         activeRequests.insert(req);
+        activeRequestsPerHost[req->host]++;
 
         if (online) {
             req->request = httpFileSource.request(req->resource, callback);
@@ -152,15 +185,31 @@ public:
         }
     }
 
-    void activatePendingRequest() {
-        auto req = pendingRequests.pop();
+    bool deactivateRequest(OnlineFileRequest* req) {
+        if (!activeRequests.erase(req)) {
+            return false;
+        }
+        auto it = activeRequestsPerHost.find(req->host);
+        assert(it != activeRequestsPerHost.end());
+        if (--it->second == 0) {
+            activeRequestsPerHost.erase(it);
+        }
+        return true;
+    }
 
-        if (req) {
+    // Activates pending requests, in order, while there is room for them. Requests to a host
+    // that is at its limit stay queued without holding back the requests to other hosts.
+    void activatePendingRequests() {
+        while (activeRequests.size() < getMaximumConcurrentRequests()) {
+            auto req = pendingRequests.pop([&](const std::string& host) { return canActivate(host); });
+            if (!req) {
+                break;
+            }
             activateRequest(*req);
         }
     }
 
-    bool isPending(OnlineFileRequest* req) { return pendingRequests.contains(req); }
+    bool isPending(const OnlineFileRequest* req) const { return pendingRequests.contains(req); }
 
     bool isActive(OnlineFileRequest* req) { return activeRequests.find(req) != activeRequests.end(); }
 
@@ -195,8 +244,20 @@ public:
 
     void setMaximumConcurrentRequests(uint32_t maximumConcurrentRequests_) {
         maximumConcurrentRequests = maximumConcurrentRequests_;
+        activatePendingRequests();
     }
 
+    void setMaximumConcurrentRequestsPerHost(uint32_t maximumConcurrentRequestsPerHost_) {
+        maximumConcurrentRequestsPerHost = maximumConcurrentRequestsPerHost_;
+        activatePendingRequests();
+    }
+
+    void setHTTPProperty(const std::string& key, const mapbox::base::Value& value) {
+        httpFileSource.setProperty(key, value);
+    }
+
+    mapbox::base::Value getHTTPProperty(const std::string& key) const { return httpFileSource.getProperty(key); }
+
     void setAPIBaseURL(std::string t) {
         resourceOptions.withTileServerOptions(TileServerOptions().withBaseURL(std::move(t)));
     }
@@ -209,6 +270,11 @@ public:
 private:
     friend struct OnlineFileRequest;
 
+    static std::string hostOf(const std::string& url) {
+        const util::URL parsed(url);
+        return url.substr(parsed.domain.first, parsed.domain.second);
+    }
+
     void networkIsReachableAgain() {
         // Notify regular priority requests.
         for (auto& req : allRequests) {
@@ -225,66 +291,143 @@ private:
         }
     }
 
-    // Using Pending Requests as an priority queue which processes
-    // file requests in a FIFO manner but prefers regular requests
-    // over offline requests with a low priority such that low priority
-    // requests do not throttle regular requests.
+    // Pending requests wait in one binary heap per host. Regular requests go ahead of low
+    // priority ones, such that low priority requests do not throttle regular requests. Within a
+    // priority, requests with a lower rank go first, and requests of the same rank in FIFO order.
     //
-    // The order of a queue is therefore:
-    //
-    // hi0 -- hi1 -- hi2 -- hi3 -- lo0 -- lo1 --lo2
-    //                              ^
-    //                              firstLowPriorityRequest
+    // Each request keeps its position in the heap of its host, so that removing a request and
+    // changing its rank take O(log n). Taking the next request compares the first request of
+    // each host, so that the requests queued for a host at its limit are never looked at.
 
     struct PendingRequests {
-        PendingRequests() : firstLowPriorityRequest(queue.begin()) {}
-
-        std::list<OnlineFileRequest*> queue;
-        std::list<OnlineFileRequest*>::iterator firstLowPriorityRequest;
+        static constexpr std::size_t notQueued = std::numeric_limits<std::size_t>::max();
 
-        void remove(const OnlineFileRequest* request) {
-            auto it = std::find(queue.begin(), queue.end(), request);
-            if (it != queue.end()) {
-                if (it == firstLowPriorityRequest) {
-                    firstLowPriorityRequest++;
-                }
-                queue.erase(it);
+        void remove(OnlineFileRequest* request) {
+            if (!contains(request)) {
+                return;
+            }
+            auto it = heaps.find(request->host);
+            assert(it != heaps.end());
+            it->second.erase(request->pendingIndex);
+            if (it->second.empty()) {
+                heaps.erase(it);
             }
         }
 
         void insert(OnlineFileRequest* request) {
-            if (request->resource.priority == Resource::Priority::Regular) {
-                firstLowPriorityRequest = queue.insert(firstLowPriorityRequest, request);
-                firstLowPriorityRequest++;
+            assert(!contains(request));
+            request->pendingSequence = nextSequence++;
+            heaps[request->host].push(request);
+        }
+
+        // Restores the order after the rank of a queued request changed.
+        void update(OnlineFileRequest* request) {
+            if (contains(request)) {
+                heaps[request->host].update(request->pendingIndex);
             }
-            else {
-                if (firstLowPriorityRequest == queue.end()) {
-                    firstLowPriorityRequest = queue.insert(queue.end(), request);
-                }
-                else {
-                    queue.insert(queue.end(), request);
+        }
+
+        // Removes and returns the first request in the queue whose host the predicate accepts.
+        template <typename Predicate>
+        std::optional<OnlineFileRequest*> pop(Predicate&& acceptHost) {
+            auto next = heaps.end();
+            for (auto it = heaps.begin(); it != heaps.end(); ++it) {
+                if ((next == heaps.end() || before(it->second.front(), next->second.front())) &&
+                    acceptHost(it->first)) {
+                    next = it;
                 }
             }
+            if (next == heaps.end()) {
+                return std::nullopt;
+            }
+            OnlineFileRequest* request = next->second.front();
+            next->second.erase(0);
+            if (next->second.empty()) {
+                heaps.erase(next);
+            }
+            return request;
         }
 
-        std::optional<OnlineFileRequest*> pop() {
-            if (queue.empty()) {
-                return {};
+        bool contains(const OnlineFileRequest* request) const { return request->pendingIndex != notQueued; }
+
+    private:
+        static bool before(const OnlineFileRequest* a, const OnlineFileRequest* b) {
+            if (a->resource.priority != b->resource.priority) {
+                return a->resource.priority == Resource::Priority::Regular;
+            }
+            if (a->resource.rank != b->resource.rank) {
+                return a->resource.rank < b->resource.rank;
             }
+            return a->pendingSequence < b->pendingSequence;
+        }
+
+        class Heap {
+        public:
+            bool empty() const { return requests.empty(); }
+            OnlineFileRequest* front() const { return requests.front(); }
 
-            if (queue.begin() == firstLowPriorityRequest) {
-                firstLowPriorityRequest++;
+            void push(OnlineFileRequest* request) {
+                requests.push_back(request);
+                request->pendingIndex = requests.size() - 1;
+                siftUp(requests.size() - 1);
             }
 
-            OnlineFileRequest* next = queue.front();
-            queue.pop_front();
-            return {next};
-        }
+            void erase(std::size_t index) {
+                requests[index]->pendingIndex = notQueued;
+                OnlineFileRequest* last = requests.back();
+                requests.pop_back();
+                if (index < requests.size()) {
+                    place(index, last);
+                    update(index);
+                }
+            }
 
-        bool contains(OnlineFileRequest* request) const {
-            return (std::find(queue.begin(), queue.end(), request) != queue.end());
-        }
+            void update(std::size_t index) { siftDown(siftUp(index)); }
 
+        private:
+            void place(std::size_t index, OnlineFileRequest* request) {
+                requests[index] = request;
+                request->pendingIndex = index;
+            }
+
+            std::size_t siftUp(std::size_t index) {
+                OnlineFileRequest* request = requests[index];
+                while (index > 0) {
+                    const std::size_t parent = (index - 1) / 2;
+                    if (!before(request, requests[parent])) {
+                        break;
+                    }
+                    place(index, requests[parent]);
+                    index = parent;
+                }
+                place(index, request);
+                return index;
+            }
+
+            void siftDown(std::size_t index) {
+                OnlineFileRequest* request = requests[index];
+                while (true) {
+                    std::size_t child = 2 * index + 1;
+                    if (child >= requests.size()) {
+                        break;
+                    }
+                    if (child + 1 < requests.size() && before(requests[child + 1], requests[child])) {
+                        child++;
+                    }
+                    if (!before(requests[child], request)) {
+                        break;
+                    }
+                    place(index, requests[child]);
+                    index = child;
+                }
+                place(index, request);
+            }
+
+            std::vector<OnlineFileRequest*> requests;
+        };
+
+        std::map<std::string, Heap> heaps;
+        uint64_t nextSequence = 0;
     };
 
     ResourceTransform resourceTransform;
@@ -308,9 +451,11 @@ private:
     PendingRequests pendingRequests;
 
     std::set<OnlineFileRequest*> activeRequests;
+    std::map<std::string, uint32_t> activeRequestsPerHost;
 
     bool online = true;
     uint32_t maximumConcurrentRequests;
+    uint32_t maximumConcurrentRequestsPerHost = 0;
     HTTPFileSource httpFileSource;
     util::AsyncTask reachability{std::bind(&OnlineFileSourceThread::networkIsReachableAgain, this)};
     std::map<AsyncRequest*, std::unique_ptr<OnlineFileRequest>> tasks;
@@ -328,6 +473,9 @@ public:
         auto req = std::make_unique<FileSourceRequest>(std::move(callback));
         req->onCancel(
             [actorRef = thread->actor(), req = req.get()]() { actorRef.invoke(&OnlineFileSourceThread::cancel, req); });
+        req->onSetRank([actorRef = thread->actor(), req = req.get()](double rank) {
+            actorRef.invoke(&OnlineFileSourceThread::setRank, req, rank);
+        });
         thread->actor().invoke(&OnlineFileSourceThread::request, req.get(), std::move(res), req->actor());
         return req;
     }
@@ -387,6 +535,35 @@ public:
         return cachedMaximumConcurrentRequests;
     }
 
+    void setMaximumConcurrentRequestsPerHost(const mapbox::base::Value& value) {
+        if (auto* maximumConcurrentRequestsPerHost = value.getUint()) {
+            assert(*maximumConcurrentRequestsPerHost < std::numeric_limits<uint32_t>::max());
+            const auto maxConcurrentRequestsPerHost = static_cast<uint32_t>(*maximumConcurrentRequestsPerHost);
+            thread->actor().invoke(&OnlineFileSourceThread::setMaximumConcurrentRequestsPerHost,
+                                   maxConcurrentRequestsPerHost);
+            {
+                std::lock_guard<std::mutex> lock(maximumConcurrentRequestsMutex);
+                cachedMaximumConcurrentRequestsPerHost = maxConcurrentRequestsPerHost;
+            }
+        } else {
+            Log::Error(Event::General, "Invalid max-concurrent-requests-per-host property value type.");
+        }
+    }
+
+    uint32_t getMaximumConcurrentRequestsPerHost() const {
+        std::lock_guard<std::mutex> lock(maximumConcurrentRequestsMutex);
+        return cachedMaximumConcurrentRequestsPerHost;
+    }
+
+    void setHTTPProperty(const std::string& key, const mapbox::base::Value& value) {
+        thread->actor().invoke(&OnlineFileSourceThread::setHTTPProperty, key, value);
+    }
+
+    // Asks the network thread, since that is where the HTTP file source keeps its state.
+    mapbox::base::Value getHTTPProperty(const std::string& key) const {
+        return thread->actor().ask(&OnlineFileSourceThread::getHTTPProperty, key).get();
+    }
+
     void setApiKey(const mapbox::base::Value& value) {
         if (auto* apiKey = value.getString()) {
             thread->actor().invoke(&OnlineFileSourceThread::setApiKey, *apiKey);
@@ -429,6 +606,7 @@ private:
 
     mutable std::mutex maximumConcurrentRequestsMutex;
     uint32_t cachedMaximumConcurrentRequests = util::DEFAULT_MAXIMUM_CONCURRENT_REQUESTS;
+    uint32_t cachedMaximumConcurrentRequestsPerHost = 0;
     const std::unique_ptr<util::Thread<OnlineFileSourceThread>> thread;
 };
 
@@ -677,6 +855,10 @@ void OnlineFileSource::setProperty(const std::string& key, const mapbox::base::V
         impl->setAPIBaseURL(value);
     } else if (key == MAX_CONCURRENT_REQUESTS_KEY) {
         impl->setMaximumConcurrentRequests(value);
+    } else if (key == MAX_CONCURRENT_REQUESTS_PER_HOST_KEY) {
+        impl->setMaximumConcurrentRequestsPerHost(value);
+    } else if (key == HTTP2_MULTIPLEXING_KEY) {
+        impl->setHTTPProperty(key, value);
     } else if (key == ONLINE_STATUS_KEY) {
         // For testing only
         if (auto* boolValue = value.getBool()) {
@@ -695,6 +877,10 @@ mapbox::base::Value OnlineFileSource::getProperty(const std::string& key) const
         return impl->getAPIBaseURL();
     } else if (key == MAX_CONCURRENT_REQUESTS_KEY) {
         return impl->getMaximumConcurrentRequests();
+    } else if (key == MAX_CONCURRENT_REQUESTS_PER_HOST_KEY) {
+        return impl->getMaximumConcurrentRequestsPerHost();
+    } else if (key == HTTP2_MULTIPLEXING_KEY || key == HTTP_METRICS_KEY) {
+        return impl->getHTTPProperty(key);
     }
     std::string message = "Resource provider does not support property " + key;
     Log::Error(Event::General, message.c_str());
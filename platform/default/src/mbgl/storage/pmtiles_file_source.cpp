@@ -0,0 +1,565 @@
+#include <mbgl/platform/settings.hpp>
+#include <mbgl/storage/file_source_request.hpp>
+#include <mbgl/storage/pmtiles_file_source.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/compression.hpp>
+#include <mbgl/util/constants.hpp>
+#include <mbgl/util/thread.hpp>
+#include <mbgl/util/url.hpp>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool acceptsURL(const std::string& url) {
+    return 0 == url.rfind(mbgl::util::PMTILES_PROTOCOL, 0);
+}
+
+// Tile URLs carry the tile address as a query string, which isn't part of the path.
+std::string urlToPath(const std::string& url) {
+    const std::string path = url.substr(std::char_traits<char>::length(mbgl::util::PMTILES_PROTOCOL));
+    return mbgl::util::percentDecode(path.substr(0, path.find('?')));
+}
+
+// Modification time and size of a file, to tell when it was replaced or written to.
+std::pair<int64_t, int64_t> fileVersion(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) == -1) {
+        return {-1, -1};
+    }
+    return {static_cast<int64_t>(info.st_mtime), static_cast<int64_t>(info.st_size)};
+}
+
+// A read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("cannot read the size of " + path);
+        }
+        size_ = static_cast<std::size_t>(fileSize.QuadPart);
+        if (size_ > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            data_ = mapping ? static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+            if (!data_) {
+                if (mapping) CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::runtime_error("cannot map " + path);
+            }
+        }
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) == -1) {
+            close(fd);
+            throw std::runtime_error("cannot read the size of " + path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ > 0) {
+            void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("cannot map " + path);
+            }
+            data_ = static_cast<const char*>(mapped);
+        }
+        // The mapping stays valid once the descriptor is closed.
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+#else
+        if (data_) munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Values of the compression fields of the header.
+enum class Compression : uint8_t { Unknown = 0, None = 1, Gzip = 2, Brotli = 3, Zstd = 4 };
+
+// Values of the tile type field of the header.
+enum class TileType : uint8_t { Unknown = 0, MVT = 1, PNG = 2, JPEG = 3, WebP = 4, AVIF = 5 };
+
+template <typename T>
+T readLittleEndian(const char* data) {
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+uint64_t readVarint(const char*& data, const char* end) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        const auto byte = static_cast<uint8_t>(*data++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+    throw std::runtime_error("malformed directory");
+}
+
+// Position of a tile on the Hilbert curve of its zoom level, after all the tiles of the lower
+// zoom levels.
+uint64_t tileID(uint8_t z, uint32_t x, uint32_t y) {
+    uint64_t id = 0;
+    for (uint8_t i = 0; i < z; ++i) {
+        id += uint64_t(1) << (2 * i);
+    }
+    int64_t tx = x;
+    int64_t ty = y;
+    for (int64_t s = (int64_t(1) << z) / 2; s > 0; s /= 2) {
+        const int64_t rx = (tx & s) > 0;
+        const int64_t ry = (ty & s) > 0;
+        id += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                tx = s - 1 - tx;
+                ty = s - 1 - ty;
+            }
+            std::swap(tx, ty);
+        }
+    }
+    return id;
+}
+
+struct Entry {
+    uint64_t tileID;
+    uint64_t offset;
+    uint32_t length;
+    // Number of consecutive tiles with the same data; 0 for an entry pointing to a leaf directory.
+    uint32_t runLength;
+};
+
+std::vector<Entry> parseDirectory(const std::string& data) {
+    const char* position = data.data();
+    const char* const end = position + data.size();
+
+    const uint64_t count = readVarint(position, end);
+    // Every entry takes at least four bytes.
+    if (count > data.size() / 4) {
+        throw std::runtime_error("malformed directory");
+    }
+    std::vector<Entry> entries(count);
+
+    uint64_t lastID = 0;
+    for (auto& entry : entries) {
+        lastID += readVarint(position, end);
+        entry.tileID = lastID;
+    }
+    for (auto& entry : entries) {
+        entry.runLength = static_cast<uint32_t>(readVarint(position, end));
+    }
+    for (auto& entry : entries) {
+        entry.length = static_cast<uint32_t>(readVarint(position, end));
+    }
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const uint64_t value = readVarint(position, end);
+        if (value == 0 && i > 0) {
+            // Contiguous with the previous entry.
+            entries[i].offset = entries[i - 1].offset + entries[i - 1].length;
+        } else {
+            entries[i].offset = value - 1;
+        }
+    }
+
+    return entries;
+}
+
+// Returns the entry holding the tile, or the leaf directory that may hold it.
+const Entry* findEntry(const std::vector<Entry>& entries, uint64_t id) {
+    auto it = std::upper_bound(
+        entries.begin(), entries.end(), id, [](uint64_t value, const Entry& entry) { return value < entry.tileID; });
+    if (it == entries.begin()) {
+        return nullptr;
+    }
+    const Entry& entry = *std::prev(it);
+    if (entry.runLength == 0 || id - entry.tileID < entry.runLength) {
+        return &entry;
+    }
+    return nullptr;
+}
+
+class Archive {
+public:
+    Archive(const std::string& path, std::pair<int64_t, int64_t> version_)
+        : version(version_),
+          file(path) {
+        constexpr std::size_t headerSize = 127;
+        if (file.size() < headerSize || std::memcmp(file.data(), "PMTiles", 7) != 0) {
+            throw std::runtime_error("not a PMTiles archive: " + path);
+        }
+        const char* header = file.data();
+        if (static_cast<uint8_t>(header[7]) != 3) {
+            throw std::runtime_error("unsupported PMTiles version in " + path);
+        }
+
+        rootOffset = readLittleEndian<uint64_t>(header + 8);
+        rootLength = readLittleEndian<uint64_t>(header + 16);
+        metadataOffset = readLittleEndian<uint64_t>(header + 24);
+        metadataLength = readLittleEndian<uint64_t>(header + 32);
+        leafOffset = readLittleEndian<uint64_t>(header + 40);
+        tileDataOffset = readLittleEndian<uint64_t>(header + 56);
+        internalCompression = static_cast<Compression>(header[97]);
+        tileCompression = static_cast<Compression>(header[98]);
+        tileType = static_cast<TileType>(header[99]);
+        minZoom = static_cast<uint8_t>(header[100]);
+        maxZoom = static_cast<uint8_t>(header[101]);
+        // Coordinates are signed, in units of 10^-7 degrees.
+        for (std::size_t i = 0; i < 4; ++i) {
+            bounds[i] = static_cast<int32_t>(readLittleEndian<uint32_t>(header + 102 + 4 * i)) / 1e7;
+        }
+        centerZoom = static_cast<uint8_t>(header[118]);
+        center[0] = static_cast<int32_t>(readLittleEndian<uint32_t>(header + 119)) / 1e7;
+        center[1] = static_cast<int32_t>(readLittleEndian<uint32_t>(header + 123)) / 1e7;
+
+        root = parseDirectory(readInternal(rootOffset, rootLength));
+    }
+
+    // Returns the stored bytes of a tile, which point into the mapped file, or nullopt when
+    // the archive doesn't contain the tile.
+    std::optional<std::pair<const char*, std::size_t>> getTile(uint8_t z, uint32_t x, uint32_t y) {
+        const uint64_t id = tileID(z, x, y);
+        const std::vector<Entry>* directory = &root;
+        // The specification allows for up to three levels of leaf directories.
+        for (int depth = 0; depth < 4; ++depth) {
+            const Entry* entry = findEntry(*directory, id);
+            if (!entry) {
+                return std::nullopt;
+            }
+            if (entry->runLength > 0) {
+                return std::make_pair(range(tileDataOffset + entry->offset, entry->length), std::size_t(entry->length));
+            }
+            directory = &leaf(leafOffset + entry->offset, entry->length);
+        }
+        return std::nullopt;
+    }
+
+    std::string getMetadata() const {
+        return metadataLength ? readInternal(metadataOffset, metadataLength) : std::string();
+    }
+
+    const std::pair<int64_t, int64_t> version;
+    Compression tileCompression;
+    TileType tileType;
+    uint8_t minZoom;
+    uint8_t maxZoom;
+    double bounds[4];
+    uint8_t centerZoom;
+    double center[2];
+
+private:
+    const char* range(uint64_t offset, uint64_t length) const {
+        if (offset > file.size() || length > file.size() - offset) {
+            throw std::runtime_error("PMTiles archive is truncated");
+        }
+        return file.data() + offset;
+    }
+
+    std::string readInternal(uint64_t offset, uint64_t length) const {
+        const std::string data(range(offset, length), length);
+        switch (internalCompression) {
+            case Compression::None:
+                return data;
+            case Compression::Gzip:
+                return mbgl::util::decompress(data);
+            default:
+                throw std::runtime_error("unsupported PMTiles internal compression");
+        }
+    }
+
+    // Leaf directories are decompressed on first use, and the most recently used ones are kept.
+    const std::vector<Entry>& leaf(uint64_t offset, uint64_t length) {
+        for (auto it = leaves.begin(); it != leaves.end(); ++it) {
+            if (it->first == offset) {
+                leaves.splice(leaves.begin(), leaves, it);
+                return leaves.front().second;
+            }
+        }
+        leaves.emplace_front(offset, parseDirectory(readInternal(offset, length)));
+        if (leaves.size() > maxCachedLeaves) {
+            leaves.pop_back();
+        }
+        return leaves.front().second;
+    }
+
+    static constexpr std::size_t maxCachedLeaves = 64;
+
+    MappedFile file;
+    uint64_t rootOffset;
+    uint64_t rootLength;
+    uint64_t metadataOffset;
+    uint64_t metadataLength;
+    uint64_t leafOffset;
+    uint64_t tileDataOffset;
+    Compression internalCompression;
+    std::vector<Entry> root;
+    std::list<std::pair<uint64_t, std::vector<Entry>>> leaves;
+};
+
+} // namespace
+
+namespace mbgl {
+using namespace rapidjson;
+
+class PMTilesFileSource::Impl {
+public:
+    explicit Impl(const ActorRef<Impl>&, const ResourceOptions& resourceOptions_, const ClientOptions& clientOptions_)
+        : resourceOptions(resourceOptions_.clone()),
+          clientOptions(clientOptions_.clone()) {}
+
+    // Generate a TileJSON resource from the header and the metadata of the archive
+    void requestTileJSON(const Resource& resource, const ActorRef<FileSourceRequest>& req) {
+        Response response;
+
+        try {
+            Archive& archive = getArchive(urlToPath(resource.url));
+
+            Document doc;
+            const std::string metadata = archive.getMetadata();
+            if (!metadata.empty()) {
+                doc.Parse(metadata.c_str(), metadata.size());
+            }
+            if (!doc.IsObject()) {
+                doc.SetObject();
+            }
+            auto& allocator = doc.GetAllocator();
+
+            const auto set = [&](const char* name, rapidjson::Value value) {
+                doc.RemoveMember(name);
+                doc.AddMember(rapidjson::StringRef(name), value, allocator);
+            };
+
+            set("tilejson", rapidjson::Value("2.0.0"));
+            set("scheme", rapidjson::Value("xyz"));
+
+            // We use the file location with the tile address as a query parameter as URL for the tiles
+            rapidjson::Value tiles(kArrayType);
+            tiles.PushBack(rapidjson::Value(resource.url + "?file={z}/{x}/{y}", allocator), allocator);
+            set("tiles", std::move(tiles));
+
+            set("minzoom", rapidjson::Value(archive.minZoom));
+            set("maxzoom", rapidjson::Value(archive.maxZoom));
+
+            rapidjson::Value bounds(kArrayType);
+            for (double bound : archive.bounds) {
+                bounds.PushBack(bound, allocator);
+            }
+            set("bounds", std::move(bounds));
+
+            rapidjson::Value center(kArrayType);
+            center.PushBack(archive.center[0], allocator);
+            center.PushBack(archive.center[1], allocator);
+            center.PushBack(archive.centerZoom, allocator);
+            set("center", std::move(center));
+
+            StringBuffer buffer;
+            Writer<StringBuffer> writer(buffer);
+            doc.Accept(writer);
+            response.data = std::make_shared<std::string>(buffer.GetString(), buffer.GetSize());
+        } catch (const std::exception& ex) {
+            response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other, ex.what());
+        }
+
+        req.invoke(&FileSourceRequest::setResponse, response);
+    }
+
+    // Load data for specific tile
+    void requestTile(const Resource& resource, const ActorRef<FileSourceRequest>& req) {
+        Response response;
+        response.noContent = true;
+
+        try {
+            Archive& archive = getArchive(urlToPath(resource.url));
+            const auto& tile = *resource.tileData;
+            if (auto data = archive.getTile(tile.z, tile.x, tile.y)) {
+                // The data is copied once out of the mapped file, or inflated from it.
+                switch (archive.tileCompression) {
+                    case Compression::Unknown:
+                    case Compression::None:
+                        response.data = std::make_shared<std::string>(data->first, data->second);
+                        break;
+                    case Compression::Gzip:
+                        response.data = std::make_shared<std::string>(
+                            util::decompress(std::string(data->first, data->second)));
+                        break;
+                    default:
+                        throw std::runtime_error("unsupported PMTiles tile compression");
+                }
+                response.noContent = false;
+                response.expires = Timestamp::max();
+                response.etag = resource.url;
+            }
+        } catch (const std::exception& ex) {
+            response.noContent = false;
+            response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other, ex.what());
+        }
+
+        req.invoke(&FileSourceRequest::setResponse, response);
+    }
+
+    void setResourceOptions(ResourceOptions options) {
+        std::lock_guard<std::mutex> lock(resourceOptionsMutex);
+        resourceOptions = options;
+    }
+
+    ResourceOptions getResourceOptions() {
+        std::lock_guard<std::mutex> lock(resourceOptionsMutex);
+        return resourceOptions.clone();
+    }
+
+    void setClientOptions(ClientOptions options) {
+        std::lock_guard<std::mutex> lock(clientOptionsMutex);
+        clientOptions = options;
+    }
+
+    ClientOptions getClientOptions() {
+        std::lock_guard<std::mutex> lock(clientOptionsMutex);
+        return clientOptions.clone();
+    }
+
+private:
+    // Multiple archives open simultaneously, to effectively support multiple .pmtiles maps. An
+    // archive is mapped again once its file changes.
+    Archive& getArchive(const std::string& path) {
+        const auto version = fileVersion(path);
+        auto it = archives.find(path);
+        if (it != archives.end()) {
+            if (it->second->version == version) {
+                return *it->second;
+            }
+            archives.erase(it);
+        }
+        return *archives.emplace(path, std::make_unique<Archive>(path, version)).first->second;
+    }
+
+    std::map<std::string, std::unique_ptr<Archive>> archives;
+
+    mutable std::mutex resourceOptionsMutex;
+    mutable std::mutex clientOptionsMutex;
+    ResourceOptions resourceOptions;
+    ClientOptions clientOptions;
+};
+
+PMTilesFileSource::PMTilesFileSource(const ResourceOptions& resourceOptions, const ClientOptions& clientOptions)
+    : thread(std::make_unique<util::Thread<Impl>>(
+          util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_FILE),
+          "PMTilesFileSource",
+          resourceOptions.clone(),
+          clientOptions.clone())) {}
+
+PMTilesFileSource::~PMTilesFileSource() = default;
+
+std::unique_ptr<AsyncRequest> PMTilesFileSource::request(const Resource& resource, FileSource::Callback callback) {
+    auto req = std::make_unique<FileSourceRequest>(std::move(callback));
+
+    // assume if there is a tile request, that the archive has been validated
+    if (resource.kind == Resource::Tile && resource.tileData) {
+        thread->actor().invoke(&Impl::requestTile, resource, req->actor());
+        return req;
+    }
+
+    if (resource.url.find(":///") == std::string::npos) {
+        Response response;
+        response.noContent = true;
+        response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other,
+                                                           "PMTilesFileSource only supports absolute path urls");
+        req->actor().invoke(&FileSourceRequest::setResponse, response);
+        return req;
+    }
+
+    // file must exist
+    const auto path = urlToPath(resource.url);
+    struct stat buffer;
+    if (stat(path.c_str(), &buffer) == -1 && errno == ENOENT) {
+        Response response;
+        response.noContent = true;
+        response.error =
+            std::make_unique<Response::Error>(Response::Error::Reason::NotFound, "path not found: " + path);
+        req->actor().invoke(&FileSourceRequest::setResponse, response);
+        return req;
+    }
+
+    // return TileJSON
+    thread->actor().invoke(&Impl::requestTileJSON, resource, req->actor());
+    return req;
+}
+
+bool PMTilesFileSource::canRequest(const Resource& resource) const {
+    return acceptsURL(resource.url);
+}
+
+void PMTilesFileSource::setResourceOptions(ResourceOptions options) {
+    thread->actor().invoke(&Impl::setResourceOptions, options.clone());
+}
+
+ResourceOptions PMTilesFileSource::getResourceOptions() {
+    return thread->actor().ask(&Impl::getResourceOptions).get();
+}
+
+void PMTilesFileSource::setClientOptions(ClientOptions options) {
+    thread->actor().invoke(&Impl::setClientOptions, options.clone());
+}
+
+ClientOptions PMTilesFileSource::getClientOptions() {
+    return thread->actor().ask(&Impl::getClientOptions).get();
+}
+
+} // namespace mbgl
@@ -6,6 +6,7 @@
 #include <zlib.h>
 #endif
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
@@ -37,74 +38,159 @@ namespace util {
 // cause a link error.
 #undef compress
 
-std::string compress(const std::string &raw, int windowBits) {
-    z_stream deflate_stream;
-    memset(&deflate_stream, 0, sizeof(deflate_stream));
+namespace {
 
-    // TODO: reuse z_streams
-    if (deflateInit2(&deflate_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-        throw std::runtime_error("failed to initialize deflate");
+// Streams are expensive to set up, so every thread keeps one of each kind and resets it
+// between calls instead.
+class DeflateStream {
+public:
+    ~DeflateStream() {
+        if (initialized) {
+            deflateEnd(&stream);
+        }
     }
 
-    deflate_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(raw.data()));
-    deflate_stream.avail_in = uInt(raw.size());
+    // Returns a stream ready to compress a new input with the given format.
+    z_stream &reset(int windowBits_) {
+        if (initialized && windowBits == windowBits_) {
+            if (deflateReset(&stream) == Z_OK) {
+                return stream;
+            }
+        }
+        if (initialized) {
+            deflateEnd(&stream);
+            initialized = false;
+        }
+        memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits_, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("failed to initialize deflate");
+        }
+        initialized = true;
+        windowBits = windowBits_;
+        return stream;
+    }
 
-    std::string result;
-    char out[16384];
+private:
+    z_stream stream;
+    int windowBits = 0;
+    bool initialized = false;
+};
+
+class InflateStream {
+public:
+    ~InflateStream() {
+        if (initialized) {
+            inflateEnd(&stream);
+        }
+    }
 
-    int code;
-    do {
-        deflate_stream.next_out = reinterpret_cast<Bytef *>(out);
-        deflate_stream.avail_out = sizeof(out);
-        code = deflate(&deflate_stream, Z_FINISH);
-        if (result.size() < deflate_stream.total_out) {
-            // append the block to the output string
-            result.append(out, deflate_stream.total_out - result.size());
+    // Returns a stream ready to decompress a new input with the given format.
+    z_stream &reset(int windowBits) {
+        if (initialized) {
+            if (inflateReset2(&stream, windowBits) == Z_OK) {
+                return stream;
+            }
+            inflateEnd(&stream);
+            initialized = false;
         }
-    } while (code == Z_OK);
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, windowBits) != Z_OK) {
+            throw std::runtime_error("failed to initialize inflate");
+        }
+        initialized = true;
+        return stream;
+    }
+
+private:
+    z_stream stream;
+    bool initialized = false;
+};
+
+thread_local DeflateStream deflateStream;
+thread_local InflateStream inflateStream;
+
+std::string deflateString(const std::string &raw, int windowBits, const std::string *dictionary) {
+    z_stream &stream = deflateStream.reset(windowBits);
+
+    if (dictionary && deflateSetDictionary(&stream,
+                                           reinterpret_cast<const Bytef *>(dictionary->data()),
+                                           uInt(dictionary->size())) != Z_OK) {
+        throw std::runtime_error("failed to set deflate dictionary");
+    }
 
-    deflateEnd(&deflate_stream);
+    // The bound is large enough for the whole output, which is then written in a single call.
+    std::string result(deflateBound(&stream, uLong(raw.size())), '\0');
 
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(raw.data()));
+    stream.avail_in = uInt(raw.size());
+    stream.next_out = reinterpret_cast<Bytef *>(&result[0]);
+    stream.avail_out = uInt(result.size());
+
+    const int code = deflate(&stream, Z_FINISH);
     if (code != Z_STREAM_END) {
-        throw std::runtime_error(deflate_stream.msg);
+        throw std::runtime_error(stream.msg ? stream.msg : "compression error");
     }
 
+    // Results may be kept for a long time, e.g. in caches, so they don't keep the slack of the
+    // buffer alive.
+    result.resize(stream.total_out);
+    result.shrink_to_fit();
     return result;
 }
 
-std::string decompress(const std::string &raw, int windowBits) {
-    z_stream inflate_stream;
-    memset(&inflate_stream, 0, sizeof(inflate_stream));
+std::string inflateString(const std::string &raw, int windowBits, const std::string *dictionary) {
+    z_stream &stream = inflateStream.reset(windowBits);
 
-    // TODO: reuse z_streams
-    if (inflateInit2(&inflate_stream, windowBits) != Z_OK) {
-        throw std::runtime_error("failed to initialize inflate");
-    }
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(raw.data()));
+    stream.avail_in = uInt(raw.size());
 
-    inflate_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(raw.data()));
-    inflate_stream.avail_in = uInt(raw.size());
-
-    std::string result;
-    char out[15384];
+    // Inflate straight into the result, growing it as needed.
+    std::string result(std::max<std::size_t>(raw.size() * 4, 16384), '\0');
 
     int code;
     do {
-        inflate_stream.next_out = reinterpret_cast<Bytef *>(out);
-        inflate_stream.avail_out = sizeof(out);
-        code = inflate(&inflate_stream, 0);
-        // result.append(out, sizeof(out) - inflate_stream.avail_out);
-        if (result.size() < inflate_stream.total_out) {
-            result.append(out, inflate_stream.total_out - result.size());
+        if (stream.total_out == result.size()) {
+            result.resize(result.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<Bytef *>(&result[stream.total_out]);
+        stream.avail_out = uInt(result.size() - stream.total_out);
+        code = inflate(&stream, Z_NO_FLUSH);
+        if (code == Z_NEED_DICT) {
+            if (!dictionary) {
+                throw std::runtime_error("decompression requires a dictionary");
+            }
+            code = inflateSetDictionary(
+                &stream, reinterpret_cast<const Bytef *>(dictionary->data()), uInt(dictionary->size()));
         }
     } while (code == Z_OK);
 
-    inflateEnd(&inflate_stream);
-
     if (code != Z_STREAM_END) {
-        throw std::runtime_error(inflate_stream.msg ? inflate_stream.msg : "decompression error");
+        throw std::runtime_error(stream.msg ? stream.msg : "decompression error");
     }
 
+    // As in deflateString(); up to half of the buffer may be unused after the last doubling.
+    result.resize(stream.total_out);
+    result.shrink_to_fit();
     return result;
 }
+
+} // namespace
+
+std::string compress(const std::string &raw, int windowBits) {
+    return deflateString(raw, windowBits, nullptr);
+}
+
+std::string decompress(const std::string &raw, int windowBits) {
+    return inflateString(raw, windowBits, nullptr);
+}
+
+std::string compressWithDictionary(const std::string &raw, const std::string &dictionary) {
+    return deflateString(raw, CompressionFormat::ZLIB, &dictionary);
+}
+
+std::string decompressWithDictionary(const std::string &raw, const std::string &dictionary) {
+    return inflateString(raw, CompressionFormat::ZLIB, &dictionary);
+}
+
 } // namespace util
 } // namespace mbgl
@@ -8,57 +8,67 @@ namespace mbgl {
 
 Mailbox::Mailbox() = default;
 
-Mailbox::Mailbox(Scheduler& scheduler_) : weakScheduler(scheduler_.makeWeakPtr()) {}
+Mailbox::Mailbox(Scheduler& scheduler_) : weakScheduler(scheduler_.makeWeakPtr()), opened(true) {}
 
 void Mailbox::open(Scheduler& scheduler_) {
-    assert(!weakScheduler);
+    assert(!opened);
 
-    // As with close(), block until neither receive() nor push() are in progress, and acquire the two
-    // mutexes in the same order.
-    std::lock_guard<std::recursive_mutex> receivingLock(receivingMutex);
-    std::lock_guard<std::mutex> pushingLock(pushingMutex);
+    // Pushes to a holding mailbox take the opening mutex, so the messages counted here are
+    // exactly the ones that are not going to schedule a receive() themselves.
+    std::lock_guard<std::mutex> openingLock(openingMutex);
 
     weakScheduler = scheduler_.makeWeakPtr();
+    const bool pending = queueSize > 0;
+    opened = true;
 
     if (closed) {
         return;
     }
 
-    if (!queue.empty()) {
-        auto guard = weakScheduler.lock();
-        if (weakScheduler) weakScheduler->schedule(makeClosure(shared_from_this()));
+    if (pending) {
+        scheduleReceive();
     }
 }
 
 void Mailbox::close() {
-    // Block until neither receive() nor push() are in progress. Two mutexes are used because receive()
-    // must not block send(). Of the two, the receiving mutex must be acquired first, because that is
-    // the order that an actor will obtain them when it self-sends a message, and consistent lock
-    // acquisition order prevents deadlocks.
-    // The receiving mutex is recursive to allow a mailbox (and thus the actor) to close itself.
+    // Block until no receive() is in progress. Pushes don't need to be waited for: once the
+    // mailbox is closed, queued messages are never run. The receiving mutex is recursive to
+    // allow a mailbox (and thus the actor) to close itself.
     std::lock_guard<std::recursive_mutex> receivingLock(receivingMutex);
-    std::lock_guard<std::mutex> pushingLock(pushingMutex);
 
     closed = true;
 }
 
 bool Mailbox::isOpen() const {
-    return bool(weakScheduler);
+    return opened && bool(weakScheduler);
 }
 
-void Mailbox::push(std::unique_ptr<Message> message) {
-    std::lock_guard<std::mutex> pushingLock(pushingMutex);
+void Mailbox::setPriority(TaskPriority priority_) {
+    priority = priority_;
+}
 
+TaskPriority Mailbox::getPriority() const {
+    return priority;
+}
+
+void Mailbox::push(std::unique_ptr<Message> message) {
     if (closed) {
         return;
     }
 
-    std::lock_guard<std::mutex> queueLock(queueMutex);
-    bool wasEmpty = queue.empty();
+    if (!opened) {
+        std::lock_guard<std::mutex> openingLock(openingMutex);
+        if (!opened) {
+            // open() will schedule the receive for messages queued so far.
+            queue.push(std::move(message));
+            ++queueSize;
+            return;
+        }
+    }
+
     queue.push(std::move(message));
-    auto guard = weakScheduler.lock();
-    if (wasEmpty && weakScheduler) {
-        weakScheduler->schedule(makeClosure(shared_from_this()));
+    if (queueSize++ == 0) {
+        scheduleReceive();
     }
 }
 
@@ -73,20 +83,23 @@ void Mailbox::receive() {
     }
 
     std::unique_ptr<Message> message;
-    bool wasEmpty;
-
-    {
-        std::lock_guard<std::mutex> queueLock(queueMutex);
-        assert(!queue.empty());
-        message = std::move(queue.front());
-        queue.pop();
-        wasEmpty = queue.empty();
+    if (!queue.pop(message)) {
+        // The message has been counted but its producer is still linking it into the queue.
+        weakScheduler->scheduleWithPriority(priority, makeClosure(shared_from_this()));
+        return;
     }
 
     (*message)();
 
-    if (!wasEmpty) {
-        weakScheduler->schedule(makeClosure(shared_from_this()));
+    if (--queueSize > 0) {
+        weakScheduler->scheduleWithPriority(priority, makeClosure(shared_from_this()));
+    }
+}
+
+void Mailbox::scheduleReceive() {
+    auto guard = weakScheduler.lock();
+    if (weakScheduler) {
+        weakScheduler->scheduleWithPriority(priority, makeClosure(shared_from_this()));
     }
 }
 
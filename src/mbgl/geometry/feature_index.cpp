@@ -55,6 +55,18 @@ void FeatureIndex::insert(const GeometryCollection& geometries,
     }
 }
 
+void FeatureIndex::append(const FeatureIndex& other) {
+    for (const auto& element : other.grid.getBoxElements()) {
+        const IndexedSubfeature& feature = element.first;
+        grid.insert(IndexedSubfeature(feature.index,
+                                      feature.sourceLayerName,
+                                      feature.bucketLeaderID,
+                                      sortIndex + feature.sortIndex),
+                    element.second);
+    }
+    sortIndex += other.sortIndex;
+}
+
 void FeatureIndex::query(std::unordered_map<std::string, std::vector<Feature>>& result,
                          const GeometryCoordinates& queryGeometry, const TransformState& transformState,
                          const mat4& posMatrix, const double tileSize, const double scale,
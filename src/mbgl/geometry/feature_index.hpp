@@ -80,6 +80,10 @@ public:
     
     void insert(const GeometryCollection&, std::size_t index, const std::string& sourceLayerName, const std::string& bucketLeaderID);
 
+    // Inserts the features of the given index after the features of this one, with the
+    // same result as if they had been inserted into this index in the first place.
+    void append(const FeatureIndex&);
+
     void query(std::unordered_map<std::string, std::vector<Feature>>& result,
                const GeometryCoordinates& queryGeometry,
                const TransformState&,
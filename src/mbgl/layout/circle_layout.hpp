@@ -4,6 +4,7 @@
 #include <mbgl/renderer/bucket_parameters.hpp>
 #include <mbgl/renderer/buckets/circle_bucket.hpp>
 #include <mbgl/renderer/render_layer.hpp>
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/style/layers/circle_layer_impl.hpp>
 
 namespace mbgl {
@@ -28,13 +29,18 @@ public:
         }
 
         const size_t featureCount = sourceLayer->featureCount();
+        const style::CompiledFilter filter(leaderLayerProperties->layerImpl().filter);
+        auto cursor = sourceLayer->makeCursor();
         for (size_t i = 0; i < featureCount; ++i) {
-            auto feature = sourceLayer->getFeature(i);
-            if (!leaderLayerProperties->layerImpl().filter(style::expression::EvaluationContext(zoom, feature.get())
-                                                               .withCanonicalTileID(&parameters.tileID.canonical))) {
+            // Only the features that pass the filter are kept; they are moved out of the cursor
+            // without being decoded again.
+            if (!filter(style::expression::EvaluationContext(zoom, &cursor->seek(i))
+                            .withCanonicalTileID(&parameters.tileID.canonical))) {
                 continue;
             }
 
+            auto feature = cursor->take();
+
             if (!sortFeaturesByKey) {
                 features.push_back({i, std::move(feature), style::CircleSortKey::defaultValue()});
                 continue;
@@ -58,17 +64,33 @@ public:
                       const CanonicalTileID& canonical) override {
         auto bucket = std::make_shared<CircleBucket>(layerPropertiesMap, mode, zoom);
 
+        std::vector<const GeometryTileFeature*> added;
+        std::vector<std::size_t> lengths;
+        std::vector<std::size_t> indices;
+        added.reserve(features.size());
+        lengths.reserve(features.size());
+        indices.reserve(features.size());
+
         for (auto& circleFeature : features) {
             const auto i = circleFeature.i;
             const std::unique_ptr<GeometryTileFeature>& feature = circleFeature.feature;
             const GeometryCollection& geometries = feature->getGeometries();
 
-            addCircle(*bucket, *feature, geometries, i, circleFeature.sortKey, canonical);
+            addCircle(*bucket, geometries, circleFeature.sortKey);
+            added.push_back(feature.get());
+            lengths.push_back(bucket->vertices.elements());
+            indices.push_back(i);
 
             bucket->addFeature(*feature, geometries, {}, PatternLayerMap(), i, canonical);
             featureIndex->insert(geometries, i, sourceLayerID, bucketLeaderID);
         }
 
+        // The features are kept alive until the bucket is created, so the data-driven paint
+        // properties are evaluated for all of them at once.
+        for (auto& pair : bucket->paintPropertyBinders) {
+            pair.second.populateVertexVectors(added.data(), lengths.data(), indices.data(), added.size(), canonical);
+        }
+
         if (!bucket->hasData()) return;
 
         for (const auto& pair : layerPropertiesMap) {
@@ -85,12 +107,7 @@ private:
         float sortKey;
     };
 
-    void addCircle(CircleBucket& bucket,
-                   const GeometryTileFeature& feature,
-                   const GeometryCollection& geometry,
-                   std::size_t featureIndex,
-                   float sortKey,
-                   const CanonicalTileID& canonical) {
+    void addCircle(CircleBucket& bucket, const GeometryCollection& geometry, float sortKey) {
         constexpr const uint16_t vertexLength = 4;
 
         auto& segments = bucket.segments;
@@ -141,10 +158,6 @@ private:
                 segment.indexLength += 6;
             }
         }
-
-        for (auto& pair : bucket.paintPropertyBinders) {
-            pair.second.populateVertexVectors(feature, vertices.elements(), featureIndex, {}, {}, canonical);
-        }
     }
 
     std::map<std::string, Immutable<style::LayerProperties>> layerPropertiesMap;
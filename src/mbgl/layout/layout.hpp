@@ -3,6 +3,8 @@
 #include <mbgl/renderer/image_atlas.hpp>
 #include <mbgl/text/glyph_atlas.hpp>
 #include <mbgl/tile/geometry_tile_data.hpp>
+
+#include <atomic>
 #include <memory>
 
 namespace mbgl {
@@ -39,6 +41,9 @@ public:
     GlyphDependencies& glyphDependencies;
     ImageDependencies& imageDependencies;
     std::set<std::string>& availableImages;
+    // Set when the tile is no longer needed; layouts stop processing features as soon
+    // as they notice it and the caller discards the partial result.
+    const std::atomic<bool>& obsolete;
 };
 
 } // namespace mbgl
@@ -5,6 +5,7 @@
 #include <mbgl/renderer/bucket_parameters.hpp>
 #include <mbgl/renderer/render_layer.hpp>
 #include <mbgl/style/expression/image.hpp>
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/style/layer_properties.hpp>
 
 namespace mbgl {
@@ -83,7 +84,8 @@ public:
         : sourceLayer(std::move(sourceLayer_)),
           zoom(parameters.tileID.overscaledZ),
           overscaling(parameters.tileID.overscaleFactor()),
-          hasPattern(false) {
+          hasPattern(false),
+          obsolete(layoutParameters.obsolete) {
         assert(!group.empty());
         auto leaderLayerProperties = staticImmutableCast<LayerPropertiesType>(group.front());
         layout = leaderLayerProperties->layerImpl().layout.evaluate(PropertyEvaluationParameters(zoom));
@@ -108,13 +110,17 @@ public:
         }
 
         const size_t featureCount = sourceLayer->featureCount();
-        for (size_t i = 0; i < featureCount; ++i) {
-            auto feature = sourceLayer->getFeature(i);
-            if (!leaderLayerProperties->layerImpl().filter(
-                    style::expression::EvaluationContext(this->zoom, feature.get())
-                        .withCanonicalTileID(&parameters.tileID.canonical)))
+        const style::CompiledFilter filter(leaderLayerProperties->layerImpl().filter);
+        auto cursor = sourceLayer->makeCursor();
+        for (size_t i = 0; !obsolete && i < featureCount; ++i) {
+            // Only the features that pass the filter are kept; they are moved out of the cursor
+            // without being decoded again.
+            if (!filter(style::expression::EvaluationContext(this->zoom, &cursor->seek(i))
+                            .withCanonicalTileID(&parameters.tileID.canonical)))
                 continue;
 
+            auto feature = cursor->take();
+
             PatternLayerMap patternDependencyMap;
             if (hasPattern) {
                 for (const auto& layerProperties : group) {
@@ -172,6 +178,8 @@ public:
                       const CanonicalTileID& canonical) override {
         auto bucket = std::make_shared<BucketType>(layout, layerPropertiesMap, zoom, overscaling);
         for (auto & patternFeature : features) {
+            if (obsolete) return;
+
             const auto i = patternFeature.i;
             std::unique_ptr<GeometryTileFeature> feature = std::move(patternFeature.feature);
             const PatternLayerMap& patterns = patternFeature.patterns;
@@ -199,6 +207,7 @@ protected:
     const uint32_t overscaling;
     std::string sourceLayerID;
     bool hasPattern;
+    const std::atomic<bool>& obsolete;
 };
 
 } // namespace mbgl
@@ -4,6 +4,8 @@
 #include <mbgl/renderer/bucket_parameters.hpp>
 #include <mbgl/renderer/layers/render_symbol_layer.hpp>
 #include <mbgl/renderer/image_atlas.hpp>
+#include <mbgl/style/compiled_filter.hpp>
+#include <mbgl/style/expression/shared_subexpression.hpp>
 #include <mbgl/text/get_anchors.hpp>
 #include <mbgl/text/shaping.hpp>
 #include <mbgl/util/utf.hpp>
@@ -91,7 +93,8 @@ SymbolLayout::SymbolLayout(const BucketParameters& parameters,
       pixelRatio(parameters.pixelRatio),
       tileSize(static_cast<uint32_t>(util::tileSize_D * overscaling)),
       tilePixelRatio(static_cast<float>(util::EXTENT) / tileSize),
-      layout(createLayout(toSymbolLayerProperties(layers.at(0)).layerImpl().layout, zoom)) {
+      layout(createLayout(toSymbolLayerProperties(layers.at(0)).layerImpl().layout, zoom)),
+      obsolete(layoutParameters.obsolete) {
     const SymbolLayer::Impl& leader = toSymbolLayerProperties(layers.at(0)).layerImpl();
 
     textSize = leader.layout.get<TextSize>();
@@ -131,13 +134,18 @@ SymbolLayout::SymbolLayout(const BucketParameters& parameters,
 
     // Determine glyph dependencies
     const size_t featureCount = sourceLayer->featureCount();
-    for (size_t i = 0; i < featureCount; ++i) {
-        auto feature = sourceLayer->getFeature(i);
-        if (!leader.filter(expression::EvaluationContext(this->zoom, feature.get())
-                               .withCanonicalTileID(&parameters.tileID.canonical)))
+    const CompiledFilter filter(leader.filter);
+    expression::SubexpressionCache subexpressions;
+    auto cursor = sourceLayer->makeCursor();
+    for (size_t i = 0; !obsolete && i < featureCount; ++i) {
+        // Only the features that pass the filter are kept; they are moved out of the cursor
+        // without being decoded again.
+        if (!filter(expression::EvaluationContext(this->zoom, &cursor->seek(i))
+                        .withCanonicalTileID(&parameters.tileID.canonical)))
             continue;
 
-        SymbolFeature ft(std::move(feature));
+        SymbolFeature ft(cursor->take());
+        subexpressions.beginFeature(ft);
 
         ft.index = i;
 
@@ -349,7 +357,7 @@ void SymbolLayout::prepareSymbols(const GlyphMap& glyphMap,
     const bool isPointPlacement = layout->get<SymbolPlacement>() == SymbolPlacementType::Point;
     const bool textAlongLine = layout->get<TextRotationAlignment>() == AlignmentType::Map && !isPointPlacement;
 
-    for (auto it = features.begin(); it != features.end(); ++it) {
+    for (auto it = features.begin(); !obsolete && it != features.end(); ++it) {
         auto& feature = *it;
         if (feature.geometry.empty()) continue;
 
@@ -775,6 +783,8 @@ void SymbolLayout::createBucket(const ImagePositions&,
                                                  iconsInText);
 
     for (SymbolInstance &symbolInstance : bucket->symbolInstances) {
+        if (obsolete) return;
+
         const bool hasText = symbolInstance.hasText();
         const bool hasIcon = symbolInstance.hasIcon();
         const bool singleLine = symbolInstance.singleLine;
@@ -135,6 +135,9 @@ private:
     Immutable<style::SymbolLayoutProperties::PossiblyEvaluated> layout;
     std::vector<SymbolFeature> features;
 
+    // Owned by the tile; checked between features to abandon the layout of obsolete tiles.
+    const std::atomic<bool>& obsolete;
+
     BiDi bidi; // Consider moving this up to geometry tile worker to reduce reinstantiation costs; use of BiDi/ubiditransform object must be constrained to one thread
 };
 
@@ -16,6 +16,7 @@
 #include <mbgl/layout/pattern_layout.hpp>
 
 #include <bitset>
+#include <vector>
 
 namespace mbgl {
 
@@ -113,6 +114,20 @@ public:
                                       const CanonicalTileID& canonical,
                                       const style::expression::Value&) = 0;
 
+    // Populates the vertex vectors of `count` features without pattern dependencies at once;
+    // `lengths[i]` is the number of vertices once feature i is added, and `indices[i]` is its
+    // index in the source layer. Binders of numeric data-driven properties evaluate the whole
+    // batch at once.
+    virtual void populateVertexVectors(const GeometryTileFeature* const* features,
+                                       const std::size_t* lengths,
+                                       const std::size_t* indices,
+                                       std::size_t count,
+                                       const CanonicalTileID& canonical) {
+        for (std::size_t i = 0; i < count; ++i) {
+            populateVertexVector(*features[i], lengths[i], indices[i], {}, {}, canonical, {});
+        }
+    }
+
     virtual void updateVertexVectors(const FeatureStates&, const GeometryTileLayer&, const ImagePositions&) {}
 
     virtual void updateVertexVector(std::size_t, std::size_t, const GeometryTileFeature&, const FeatureState&) = 0;
@@ -229,15 +244,20 @@ public:
         auto evaluated = expression.evaluate(
             EvaluationContext(&feature).withFormattedSection(&formattedSection).withCanonicalTileID(&canonical),
             defaultValue);
-        this->statistics.add(evaluated);
-        auto value = attributeValue(evaluated);
-        auto elements = vertexVector.elements();
-        for (std::size_t i = elements; i < length; ++i) {
-            vertexVector.emplace_back(BaseVertex { value });
-        }
-        std::optional<std::string> idStr = featureIDtoString(feature.getID());
-        if (idStr) {
-            featureMap[*idStr].emplace_back(FeatureVertexRange{index, elements, length});
+        appendVertices(feature, length, index, evaluated);
+    }
+
+    void populateVertexVectors(const GeometryTileFeature* const* features,
+                               const std::size_t* lengths,
+                               const std::size_t* indices,
+                               std::size_t count,
+                               const CanonicalTileID& canonical) override {
+        using style::expression::EvaluationContext;
+        std::vector<T> evaluated(count);
+        expression.evaluate(
+            EvaluationContext().withCanonicalTileID(&canonical), features, count, evaluated.data(), defaultValue);
+        for (std::size_t i = 0; i < count; ++i) {
+            appendVertices(*features[i], lengths[i], indices[i], evaluated[i]);
         }
     }
 
@@ -298,6 +318,19 @@ public:
     }
 
 private:
+    void appendVertices(const GeometryTileFeature& feature, std::size_t length, std::size_t index, const T& evaluated) {
+        this->statistics.add(evaluated);
+        auto value = attributeValue(evaluated);
+        auto elements = vertexVector.elements();
+        for (std::size_t i = elements; i < length; ++i) {
+            vertexVector.emplace_back(BaseVertex { value });
+        }
+        std::optional<std::string> idStr = featureIDtoString(feature.getID());
+        if (idStr) {
+            featureMap[*idStr].emplace_back(FeatureVertexRange{index, elements, length});
+        }
+    }
+
     style::PropertyExpression<T> expression;
     T defaultValue;
     gfx::VertexVector<BaseVertex> vertexVector;
@@ -337,18 +370,23 @@ public:
                                     .withCanonicalTileID(&canonical),
                                 defaultValue),
         };
-        this->statistics.add(range.min);
-        this->statistics.add(range.max);
-        AttributeValue value = zoomInterpolatedAttributeValue(
-            attributeValue(range.min),
-            attributeValue(range.max));
-        auto elements = vertexVector.elements();
-        for (std::size_t i = elements; i < length; ++i) {
-            vertexVector.emplace_back(Vertex { value });
-        }
-        std::optional<std::string> idStr = featureIDtoString(feature.getID());
-        if (idStr) {
-            featureMap[*idStr].emplace_back(FeatureVertexRange{index, elements, length});
+        appendVertices(feature, length, index, range);
+    }
+
+    void populateVertexVectors(const GeometryTileFeature* const* features,
+                               const std::size_t* lengths,
+                               const std::size_t* indices,
+                               std::size_t count,
+                               const CanonicalTileID& canonical) override {
+        using style::expression::EvaluationContext;
+        std::vector<T> min(count);
+        std::vector<T> max(count);
+        expression.evaluate(
+            EvaluationContext(zoomRange.min).withCanonicalTileID(&canonical), features, count, min.data(), defaultValue);
+        expression.evaluate(
+            EvaluationContext(zoomRange.max).withCanonicalTileID(&canonical), features, count, max.data(), defaultValue);
+        for (std::size_t i = 0; i < count; ++i) {
+            appendVertices(*features[i], lengths[i], indices[i], Range<T>{min[i], max[i]});
         }
     }
 
@@ -416,6 +454,22 @@ public:
     }
 
 private:
+    void appendVertices(const GeometryTileFeature& feature, std::size_t length, std::size_t index, const Range<T>& range) {
+        this->statistics.add(range.min);
+        this->statistics.add(range.max);
+        AttributeValue value = zoomInterpolatedAttributeValue(
+            attributeValue(range.min),
+            attributeValue(range.max));
+        auto elements = vertexVector.elements();
+        for (std::size_t i = elements; i < length; ++i) {
+            vertexVector.emplace_back(Vertex { value });
+        }
+        std::optional<std::string> idStr = featureIDtoString(feature.getID());
+        if (idStr) {
+            featureMap[*idStr].emplace_back(FeatureVertexRange{index, elements, length});
+        }
+    }
+
     style::PropertyExpression<T> expression;
     T defaultValue;
     Range<float> zoomRange;
@@ -634,6 +688,17 @@ public:
                        0)...});
     }
 
+    // Populates the vertex vectors of a batch of features without pattern dependencies; see
+    // PaintPropertyBinder::populateVertexVectors().
+    void populateVertexVectors(const GeometryTileFeature* const* features,
+                               const std::size_t* lengths,
+                               const std::size_t* indices,
+                               std::size_t count,
+                               const CanonicalTileID& canonical) {
+        util::ignore({(binders.template get<Ps>()->populateVertexVectors(features, lengths, indices, count, canonical),
+                       0)...});
+    }
+
     void updateVertexVectors(const FeatureStates& states, const GeometryTileLayer& layer,
                              const ImagePositions& imagePositions) {
         util::ignore({(binders.template get<Ps>()->updateVertexVectors(states, layer, imagePositions), 0)...});
@@ -23,6 +23,7 @@
 #include <mbgl/style/transition_options.hpp>
 #include <mbgl/text/glyph_manager.hpp>
 #include <mbgl/tile/tile.hpp>
+#include <mbgl/tile/tile_parse_counters.hpp>
 #include <mbgl/util/math.hpp>
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/logging.hpp>
@@ -109,6 +110,7 @@ RenderOrchestrator::RenderOrchestrator(bool backgroundLayerAsColor_, const std::
       imageManager(std::make_unique<ImageManager>()),
       lineAtlas(std::make_unique<LineAtlas>()),
       patternAtlas(std::make_unique<PatternAtlas>()),
+      tileParseCounters(std::make_shared<TileParseCounters>()),
       imageImpls(makeMutable<std::vector<Immutable<style::Image::Impl>>>()),
       sourceImpls(makeMutable<std::vector<Immutable<style::Source::Impl>>>()),
       layerImpls(makeMutable<std::vector<Immutable<style::Layer::Impl>>>()),
@@ -172,7 +174,8 @@ std::unique_ptr<RenderTree> RenderOrchestrator::createRenderTree(
                                         updateParameters->annotationManager,
                                         *imageManager,
                                         *glyphManager,
-                                        updateParameters->prefetchZoomDelta};
+                                        updateParameters->prefetchZoomDelta,
+                                        tileParseCounters};
 
     glyphManager->setURL(updateParameters->glyphURL);
 
@@ -652,6 +655,10 @@ const std::vector<PlacedSymbolData>& RenderOrchestrator::getPlacedSymbolsData()
     return placementController.getPlacement()->getPlacedSymbolsData();
 }
 
+TileParseStatistics RenderOrchestrator::getTileParseStatistics() const {
+    return tileParseCounters->getStatistics();
+}
+
 RenderLayer* RenderOrchestrator::getRenderLayer(const std::string& id) {
     auto it = renderLayers.find(id);
     return it != renderLayers.end() ? it->second.get() : nullptr;
@@ -31,6 +31,7 @@ class LineAtlas;
 class PatternAtlas;
 class CrossTileSymbolIndex;
 class RenderTree;
+class TileParseCounters;
 
 namespace style {
     class LayerProperties;
@@ -74,6 +75,7 @@ public:
     void dumpDebugLogs();
     void collectPlacedSymbolData(bool);
     const std::vector<PlacedSymbolData>& getPlacedSymbolsData() const;
+    TileParseStatistics getTileParseStatistics() const;
     void clearData();
 
 private:
@@ -112,6 +114,7 @@ private:
     std::unique_ptr<ImageManager> imageManager;
     std::unique_ptr<LineAtlas> lineAtlas;
     std::unique_ptr<PatternAtlas> patternAtlas;
+    std::shared_ptr<TileParseCounters> tileParseCounters;
 
     Immutable<std::vector<Immutable<style::Image::Impl>>> imageImpls;
     Immutable<std::vector<Immutable<style::Source::Impl>>> sourceImpls;
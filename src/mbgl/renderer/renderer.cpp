@@ -133,6 +133,10 @@ const std::vector<PlacedSymbolData>& Renderer::getPlacedSymbolsData() const {
     return impl->orchestrator.getPlacedSymbolsData();
 }
 
+TileParseStatistics Renderer::getTileParseStatistics() const {
+    return impl->orchestrator.getTileParseStatistics();
+}
+
 void Renderer::reduceMemoryUse() {
     gfx::BackendScope guard { impl->backend };
     impl->reduceMemoryUse();
@@ -13,6 +13,7 @@ class FileSource;
 class AnnotationManager;
 class ImageManager;
 class GlyphManager;
+class TileParseCounters;
 
 class TileParameters {
 public:
@@ -25,6 +26,7 @@ public:
     ImageManager& imageManager;
     GlyphManager& glyphManager;
     const uint8_t prefetchZoomDelta;
+    std::shared_ptr<TileParseCounters> parseCounters = nullptr;
 };
 
 } // namespace mbgl
@@ -5,6 +5,7 @@
 #include <mbgl/renderer/query.hpp>
 #include <mbgl/map/transform.hpp>
 #include <mbgl/math/clamp.hpp>
+#include <mbgl/util/tile_coordinate.hpp>
 #include <mbgl/util/tile_cover.hpp>
 #include <mbgl/util/tile_range.hpp>
 #include <mbgl/util/enum.hpp>
@@ -16,6 +17,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <unordered_set>
 
 namespace mbgl {
 
@@ -72,6 +74,7 @@ void TilePyramid::update(const std::vector<Immutable<style::LayerProperties>>& l
                 // for them and thus suppress network requests on
                 // tiles expiration (see `OnlineFileRequest`).
                 entry.second->setNecessity(TileNecessity::Optional);
+                entry.second->setPriority(TaskPriority::Low);
                 cache.add(entry.first, std::move(entry.second));
             }
         }
@@ -138,6 +141,27 @@ void TilePyramid::update(const std::vector<Immutable<style::LayerProperties>>& l
     // we're actively using, e.g. as a replacement for tile that aren't loaded yet.
     std::set<OverscaledTileID> retain;
 
+    // Background work for the tiles covering the viewport is scheduled ahead of the work for
+    // tiles that are only retained as fallbacks, while prefetched tiles come last.
+    const std::unordered_set<OverscaledTileID> idealTileSet(idealTiles.begin(), idealTiles.end());
+    const std::unordered_set<OverscaledTileID> panTileSet(panTiles.begin(), panTiles.end());
+    auto tilePriorityFn = [&](const OverscaledTileID& tileID) -> TaskPriority {
+        if (idealTileSet.count(tileID)) return TaskPriority::High;
+        if (panTileSet.count(tileID)) return TaskPriority::Low;
+        return TaskPriority::Default;
+    };
+
+    // Network requests of the same priority are sent in order of rank: the distance, in tiles,
+    // between a tile and the center of the viewport plus the number of zoom levels it is away
+    // from the ideal zoom.
+    const TileCoordinate center = TileCoordinate::fromLatLng(0, parameters.transformState.getLatLng());
+    auto tileRankFn = [&](const OverscaledTileID& tileID) -> double {
+        const double scale = std::pow(2.0, tileID.canonical.z);
+        const double dx = tileID.canonical.x + tileID.wrap * scale + 0.5 - center.p.x * scale;
+        const double dy = tileID.canonical.y + 0.5 - center.p.y * scale;
+        return std::abs(tileZoom - tileID.overscaledZ) + std::sqrt(dx * dx + dy * dy);
+    };
+
     auto retainTileFn = [&](Tile& tile, TileNecessity necessity) -> void {
         if (retain.emplace(tile.id).second) {
             tile.setUpdateParameters({minimumUpdateInterval, isVolatile});
@@ -170,6 +194,8 @@ void TilePyramid::update(const std::vector<Immutable<style::LayerProperties>>& l
             tile = createTile(tileID);
             if (!tile) return nullptr;
             tile->setObserver(observer);
+            tile->setPriority(tilePriorityFn(tileID));
+            tile->setRank(tileRankFn(tileID));
             tile->setLayers(layers);
         }
 
@@ -229,6 +255,7 @@ void TilePyramid::update(const std::vector<Immutable<style::LayerProperties>>& l
             if (retainIt == retain.end() || tilesIt->first < *retainIt) {
                 if (!needsRelayout) {
                     tilesIt->second->setNecessity(TileNecessity::Optional);
+                    tilesIt->second->setPriority(TaskPriority::Low);
                     cache.add(tilesIt->first, std::move(tilesIt->second));
                 }
                 tiles.erase(tilesIt++);
@@ -243,6 +270,8 @@ void TilePyramid::update(const std::vector<Immutable<style::LayerProperties>>& l
 
     for (auto& pair : tiles) {
         pair.second->setShowCollisionBoxes(parameters.debugOptions & MapDebugOptions::Collision);
+        pair.second->setPriority(tilePriorityFn(pair.first));
+        pair.second->setRank(tileRankFn(pair.first));
     }
 
     // Initialize renderable tiles and update the contained layer render data.
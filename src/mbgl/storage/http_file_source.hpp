@@ -18,6 +18,11 @@ public:
         return resource.hasLoadingMethod(Resource::LoadingMethod::Network);
     }
 
+    // Supports HTTP2_MULTIPLEXING_KEY and HTTP_METRICS_KEY where the platform's HTTP stack
+    // exposes them.
+    void setProperty(const std::string&, const mapbox::base::Value&) override;
+    mapbox::base::Value getProperty(const std::string&) const override;
+
     void setResourceOptions(ResourceOptions) override;
     ResourceOptions getResourceOptions() override;
 
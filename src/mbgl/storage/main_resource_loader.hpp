@@ -19,6 +19,9 @@ public:
     void pause() override;
     void resume() override;
 
+    void setProperty(const std::string&, const mapbox::base::Value&) override;
+    mapbox::base::Value getProperty(const std::string&) const override;
+
     void setResourceOptions(ResourceOptions) override;
     ResourceOptions getResourceOptions() override;
 
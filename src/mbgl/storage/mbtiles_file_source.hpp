@@ -5,10 +5,13 @@
 #include <mbgl/util/client_options.hpp>
 #include <mbgl/util/thread.hpp>
 
+#include <atomic>
+#include <vector>
 
 namespace mbgl {
 // File source for supporting .mbtiles maps.
 // can only load resource URLS that are absolute paths to local files
+// tiles are read on a few reader threads, each keeping a connection per file
 class MBTilesFileSource : public FileSource {
 public:
     MBTilesFileSource(const ResourceOptions& resourceOptions, const ClientOptions& clientOptions);
@@ -25,7 +28,10 @@ public:
 
 private:
     class Impl;
+    class Reader;
     std::unique_ptr <util::Thread<Impl>> thread; //impl
+    std::vector<std::unique_ptr<util::Thread<Reader>>> readers;
+    std::atomic<std::size_t> nextReader{0};
 };
 
 } // namespace mbgl
@@ -0,0 +1,132 @@
+#include <mbgl/storage/response_cache.hpp>
+#include <mbgl/util/chrono.hpp>
+
+#include <iterator>
+
+namespace mbgl {
+
+namespace {
+
+std::string keyFor(const Resource& resource, const std::string& scope) {
+    return std::to_string(scope.size()) + ':' + scope + std::to_string(resource.kind) + ':' + resource.url;
+}
+
+} // namespace
+
+ResponseCache& ResponseCache::getInstance() {
+    static ResponseCache instance;
+    return instance;
+}
+
+ResponseCache::ResponseCache(uint64_t maximumSize_)
+    : maximumSize(maximumSize_) {
+}
+
+bool ResponseCache::accepts(const Resource& resource) {
+    if (resource.storagePolicy == Resource::StoragePolicy::Volatile) {
+        return false;
+    }
+
+    switch (resource.kind) {
+        case Resource::Kind::Style:
+        case Resource::Kind::Source:
+        case Resource::Kind::Glyphs:
+        case Resource::Kind::SpriteImage:
+        case Resource::Kind::SpriteJSON:
+        case Resource::Kind::Image:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::optional<Response> ResponseCache::get(const Resource& resource, const std::string& scope) {
+    if (!accepts(resource) || !resource.hasLoadingMethod(Resource::LoadingMethod::Cache)) {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(keyFor(resource, scope));
+    if (it == index.end()) {
+        misses++;
+        return std::nullopt;
+    }
+
+    if (*it->second->expires <= util::now()) {
+        erase(it->second);
+        misses++;
+        return std::nullopt;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+
+    const Entry& entry = *it->second;
+    Response response;
+    response.data = entry.data;
+    response.modified = entry.modified;
+    response.expires = entry.expires;
+    response.etag = entry.etag;
+    response.mustRevalidate = entry.mustRevalidate;
+    return response;
+}
+
+void ResponseCache::put(const Resource& resource, const Response& response, const std::string& scope) {
+    if (!accepts(resource) || response.error || response.noContent || response.notModified || !response.data ||
+        !response.expires || *response.expires <= util::now()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::string key = keyFor(resource, scope);
+    if (auto it = index.find(key); it != index.end()) {
+        erase(it->second);
+    }
+
+    if (response.data->size() > maximumSize) {
+        return;
+    }
+
+    entries.push_front(
+        {key, response.data, response.modified, response.expires, response.etag, response.mustRevalidate});
+    index.emplace(key, entries.begin());
+    size += response.data->size();
+    evict();
+}
+
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    size = 0;
+}
+
+void ResponseCache::setMaximumSize(uint64_t maximumSize_) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maximumSize = maximumSize_;
+    evict();
+}
+
+uint64_t ResponseCache::getMaximumSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return maximumSize;
+}
+
+ResponseCache::Statistics ResponseCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {hits, misses, entries.size(), size};
+}
+
+void ResponseCache::erase(std::list<Entry>::iterator it) {
+    size -= it->data->size();
+    index.erase(it->key);
+    entries.erase(it);
+}
+
+void ResponseCache::evict() {
+    while (size > maximumSize) {
+        erase(std::prev(entries.end()));
+    }
+}
+
+} // namespace mbgl
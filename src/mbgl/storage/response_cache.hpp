@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/constants.hpp>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace mbgl {
+
+// Size-bounded, least recently used cache of fresh responses, kept in memory in front of the
+// database and network file sources. A single instance is shared by all resource loaders of the
+// process, so that maps using the same style don't each read its glyphs and sprites again.
+// Responses are kept per scope, which identifies the options they were loaded with, such that
+// loaders with a different API key or tile server never see each other's responses.
+// Tiles are left to the renderer's tile cache.
+class ResponseCache {
+public:
+    struct Statistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t entries = 0;
+        uint64_t size = 0;
+    };
+
+    static ResponseCache& getInstance();
+
+    explicit ResponseCache(uint64_t maximumSize = util::DEFAULT_RESPONSE_CACHE_SIZE);
+
+    // Returns whether responses for the resource may be kept in this cache.
+    static bool accepts(const Resource&);
+
+    // Returns the cached response if it hasn't expired yet.
+    std::optional<Response> get(const Resource&, const std::string& scope);
+
+    // Keeps the response if it carries data and an expiration time in the future.
+    void put(const Resource&, const Response&, const std::string& scope);
+
+    void clear();
+
+    void setMaximumSize(uint64_t);
+    uint64_t getMaximumSize() const;
+
+    Statistics getStatistics() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> data;
+        std::optional<Timestamp> modified;
+        std::optional<Timestamp> expires;
+        std::optional<std::string> etag;
+        bool mustRevalidate;
+    };
+
+    void erase(std::list<Entry>::iterator);
+    void evict();
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    uint64_t maximumSize;
+    uint64_t size = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+} // namespace mbgl
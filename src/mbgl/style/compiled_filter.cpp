@@ -0,0 +1,269 @@
+#include <mbgl/style/compiled_filter.hpp>
+#include <mbgl/style/expression/literal.hpp>
+#include <mbgl/tile/geometry_tile_data.hpp>
+
+#include <algorithm>
+#include <optional>
+
+namespace mbgl {
+namespace style {
+
+using namespace expression;
+
+namespace {
+
+std::vector<const Expression*> argumentsOf(const Expression& expression) {
+    std::vector<const Expression*> arguments;
+    expression.eachChild([&](const Expression& child) { arguments.push_back(&child); });
+    return arguments;
+}
+
+std::optional<Value> literalValue(const Expression& expression) {
+    if (expression.getKind() != Kind::Literal) {
+        return std::nullopt;
+    }
+    return static_cast<const Literal&>(expression).getValue();
+}
+
+std::optional<std::string> literalString(const Expression& expression) {
+    auto value = literalValue(expression);
+    if (!value || !value->is<std::string>()) {
+        return std::nullopt;
+    }
+    return value->get<std::string>();
+}
+
+// Values a feature property can be compared with without converting the property.
+std::optional<Value> literalScalar(const Expression& expression) {
+    auto value = literalValue(expression);
+    if (!value ||
+        !(value->is<NullValue>() || value->is<bool>() || value->is<double>() || value->is<std::string>())) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Returns the key of a ["get", key] expression reading a feature property.
+std::optional<std::string> propertyKey(const Expression& expression) {
+    if (expression.getKind() != Kind::CompoundExpression || expression.getOperator() != "get") {
+        return std::nullopt;
+    }
+    const auto arguments = argumentsOf(expression);
+    return arguments.size() == 1 ? literalString(*arguments[0]) : std::nullopt;
+}
+
+uint8_t typeBit(FeatureType type) {
+    return static_cast<uint8_t>(1u << static_cast<uint8_t>(type));
+}
+
+std::optional<uint8_t> typeBit(const std::string& type) {
+    if (type == "Point") return typeBit(FeatureType::Point);
+    if (type == "LineString") return typeBit(FeatureType::LineString);
+    if (type == "Polygon") return typeBit(FeatureType::Polygon);
+    if (type == "Unknown") return typeBit(FeatureType::Unknown);
+    return std::nullopt;
+}
+
+// Same as toExpressionValue(property) == expected, without copying the property.
+bool equals(const mbgl::Value& property, const Value& expected) {
+    return property.match(
+        [&](const NullValue&) { return expected.is<NullValue>(); },
+        [&](bool value) { return expected.is<bool>() && expected.get<bool>() == value; },
+        [&](uint64_t value) { return expected.is<double>() && expected.get<double>() == static_cast<double>(value); },
+        [&](int64_t value) { return expected.is<double>() && expected.get<double>() == static_cast<double>(value); },
+        [&](double value) { return expected.is<double>() && expected.get<double>() == value; },
+        [&](const std::string& value) { return expected.is<std::string>() && expected.get<std::string>() == value; },
+        [&](const auto&) { return toExpressionValue(property) == expected; });
+}
+
+} // namespace
+
+CompiledFilter::CompiledFilter(const Filter& filter) {
+    if (filter.expression) {
+        root = *filter.expression;
+        compile(*root);
+    }
+}
+
+std::size_t CompiledFilter::compile(const Expression& expression) {
+    Node node;
+    node.op = Op::Fallback;
+    node.expression = &expression;
+
+    const auto arguments = argumentsOf(expression);
+    const auto setChildren = [&](Op op) {
+        std::vector<std::size_t> indices;
+        indices.reserve(arguments.size());
+        for (const auto* argument : arguments) {
+            indices.push_back(compile(*argument));
+        }
+        node.op = op;
+        node.first = children.size();
+        node.count = indices.size();
+        children.insert(children.end(), indices.begin(), indices.end());
+    };
+
+    switch (expression.getKind()) {
+    case Kind::Literal: {
+        auto value = literalValue(expression);
+        if (value->is<bool>()) {
+            node.op = Op::Constant;
+            node.result = value->get<bool>() ? Result::True : Result::False;
+        }
+        break;
+    }
+    case Kind::All:
+        setChildren(Op::All);
+        break;
+    case Kind::Any:
+        setChildren(Op::Any);
+        break;
+    case Kind::Comparison: {
+        // ["==", ["get", key], literal] and ["!=", ["get", key], literal], in either order.
+        const std::string op = expression.getOperator();
+        if ((op != "==" && op != "!=") || arguments.size() != 2) {
+            break;
+        }
+        auto key = propertyKey(*arguments[0]);
+        auto value = literalScalar(*arguments[1]);
+        if (!key || !value) {
+            key = propertyKey(*arguments[1]);
+            value = literalScalar(*arguments[0]);
+        }
+        if (key && value) {
+            // A missing property reads as null.
+            const bool missingEquals = value->is<NullValue>();
+            node.op = op == "==" ? Op::PropertyEquals : Op::PropertyNotEquals;
+            node.result = (op == "==") == missingEquals ? Result::True : Result::False;
+            node.key = std::move(*key);
+            node.values.push_back(std::move(*value));
+        }
+        break;
+    }
+    case Kind::CompoundExpression: {
+        const std::string op = expression.getOperator();
+        if (op == "!" && arguments.size() == 1) {
+            setChildren(Op::Not);
+        } else if (op == "filter-==" && arguments.size() == 2) {
+            auto key = literalString(*arguments[0]);
+            auto value = literalScalar(*arguments[1]);
+            if (key && value) {
+                node.op = Op::PropertyEquals;
+                node.key = std::move(*key);
+                node.values.push_back(std::move(*value));
+            }
+        } else if (op == "filter-in" && !arguments.empty()) {
+            auto key = literalString(*arguments[0]);
+            std::vector<Value> values;
+            for (std::size_t i = 1; key && i < arguments.size(); ++i) {
+                auto value = literalScalar(*arguments[i]);
+                if (!value) {
+                    key = std::nullopt;
+                    break;
+                }
+                values.push_back(std::move(*value));
+            }
+            if (key) {
+                node.op = Op::PropertyEquals;
+                node.key = std::move(*key);
+                node.values = std::move(values);
+            }
+        } else if ((op == "filter-has" || op == "has") && arguments.size() == 1) {
+            auto key = literalString(*arguments[0]);
+            if (key) {
+                node.op = Op::Has;
+                node.key = std::move(*key);
+            }
+        } else if (op == "filter-type-==" || op == "filter-type-in") {
+            uint8_t mask = 0;
+            bool compiled = true;
+            for (const auto* argument : arguments) {
+                auto type = literalString(*argument);
+                if (!type) {
+                    compiled = false;
+                    break;
+                }
+                mask |= typeBit(*type).value_or(0);
+            }
+            if (compiled) {
+                node.op = Op::TypeIn;
+                node.typeMask = mask;
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    nodes.push_back(std::move(node));
+    return nodes.size() - 1;
+}
+
+bool CompiledFilter::operator()(const EvaluationContext& context) const {
+    if (!root) {
+        return true;
+    }
+    // The root expression is compiled last.
+    return evaluate(nodes.size() - 1, context) == Result::True;
+}
+
+CompiledFilter::Result CompiledFilter::evaluate(std::size_t index, const EvaluationContext& context) const {
+    const Node& node = nodes[index];
+    switch (node.op) {
+    case Op::Constant:
+        return node.result;
+    case Op::All:
+        for (std::size_t i = node.first; i < node.first + node.count; ++i) {
+            const Result result = evaluate(children[i], context);
+            if (result != Result::True) return result;
+        }
+        return Result::True;
+    case Op::Any:
+        for (std::size_t i = node.first; i < node.first + node.count; ++i) {
+            const Result result = evaluate(children[i], context);
+            if (result != Result::False) return result;
+        }
+        return Result::False;
+    case Op::Not: {
+        const Result result = evaluate(children[node.first], context);
+        if (result == Result::Error) return result;
+        return result == Result::True ? Result::False : Result::True;
+    }
+    case Op::PropertyEquals: {
+        if (!context.feature) return Result::Error;
+        const auto property = context.feature->getValue(node.key);
+        if (!property) return node.result;
+        for (const auto& value : node.values) {
+            if (equals(*property, value)) return Result::True;
+        }
+        return Result::False;
+    }
+    case Op::PropertyNotEquals: {
+        if (!context.feature) return Result::Error;
+        const auto property = context.feature->getValue(node.key);
+        if (!property) return node.result;
+        return equals(*property, node.values.front()) ? Result::False : Result::True;
+    }
+    case Op::Has:
+        if (!context.feature) return Result::Error;
+        return context.feature->getValue(node.key) ? Result::True : Result::False;
+    case Op::TypeIn:
+        if (!context.feature) return Result::False;
+        return (node.typeMask & typeBit(context.feature->getType())) ? Result::True : Result::False;
+    case Op::Fallback: {
+        const EvaluationResult result = node.expression->evaluate(context);
+        if (!result) return Result::Error;
+        const std::optional<bool> typed = fromExpressionValue<bool>(*result);
+        return typed && *typed ? Result::True : Result::False;
+    }
+    }
+    return Result::Error;
+}
+
+std::size_t CompiledFilter::getFallbackCount() const {
+    return std::count_if(nodes.begin(), nodes.end(), [](const Node& node) { return node.op == Op::Fallback; });
+}
+
+} // namespace style
+} // namespace mbgl
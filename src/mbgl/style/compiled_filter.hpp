@@ -0,0 +1,77 @@
+#pragma once
+
+#include <mbgl/style/filter.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mbgl {
+namespace style {
+
+/**
+ * @brief CompiledFilter evaluates a Filter against many features, faster than Filter itself
+ *
+ * The filter expression is flattened once into a vector of nodes. The following forms are
+ * evaluated directly on the feature, comparing property values in place without converting
+ * them to expression values and without evaluating the literals:
+ *
+ * - "all", "any", "!" and boolean literals,
+ * - the legacy "==", "!=", "in", "!in", "has" and "!has" filters on a feature property, and
+ *   the legacy "==", "!=", "in" and "!in" filters on "$type",
+ * - ["==", ["get", key], literal] and ["!=", ["get", key], literal], in either order, and
+ *   ["has", key].
+ *
+ * Any other subexpression, including the expression syntax of "in" and comparisons with
+ * ["geometry-type"], is evaluated as part of the original expression.
+ *
+ * The result is the same as the one of Filter::operator() for any evaluation context.
+ */
+class CompiledFilter {
+public:
+    explicit CompiledFilter(const Filter&);
+
+    bool operator()(const expression::EvaluationContext&) const;
+
+    // Returns the number of subexpressions that are not compiled and have to be evaluated as
+    // part of the original expression.
+    std::size_t getFallbackCount() const;
+
+private:
+    enum class Result : uint8_t { False, True, Error };
+
+    enum class Op : uint8_t {
+        Constant,          // `result`
+        All,
+        Any,
+        Not,
+        PropertyEquals,    // `key` equals one of `values`; `result` if the property is missing
+        PropertyNotEquals, // `key` differs from `values[0]`; `result` if the property is missing
+        Has,               // `key` is present
+        TypeIn,            // the geometry type is in `typeMask`
+        Fallback,          // evaluates `expression`
+    };
+
+    struct Node {
+        Op op;
+        Result result = Result::False;
+        uint8_t typeMask = 0;
+        // Range of `children` holding the indices of the child nodes.
+        std::size_t first = 0;
+        std::size_t count = 0;
+        std::string key;
+        std::vector<expression::Value> values;
+        const expression::Expression* expression = nullptr;
+    };
+
+    std::size_t compile(const expression::Expression&);
+    Result evaluate(std::size_t index, const expression::EvaluationContext&) const;
+
+    std::shared_ptr<const expression::Expression> root;
+    std::vector<Node> nodes;
+    std::vector<std::size_t> children;
+};
+
+} // namespace style
+} // namespace mbgl
@@ -2,6 +2,7 @@
 #include <mbgl/style/conversion/constant.hpp>
 #include <mbgl/style/conversion/filter.hpp>
 #include <mbgl/style/conversion_impl.hpp>
+#include <mbgl/style/expression/shared_subexpression.hpp>
 
 #include <mbgl/layermanager/layer_manager.hpp>
 
@@ -72,6 +73,9 @@ std::optional<std::unique_ptr<Layer>> Converter<std::unique_ptr<Layer>>::operato
         if (!setObjectMember(layer, value, "source-layer", error)) return std::nullopt;
     }
 
+    // Equal subexpressions of the layout and paint properties are evaluated once per feature.
+    expression::SubexpressionPool subexpressions;
+
     auto layoutValue = objectMember(value, "layout");
     if (layoutValue) {
         if (!isObject(*layoutValue)) {
@@ -107,13 +107,40 @@ EvaluationResult Assertion::evaluate(const EvaluationContext& params) const {
     return EvaluationError { "Unreachable" };
 };
 
+void Assertion::evaluateNumbers(const EvaluationContext& params,
+                                const GeometryTileFeature* const* features,
+                                std::size_t count,
+                                double* values,
+                                bool* valid) const {
+    if (getType() != type::Number) {
+        Expression::evaluateNumbers(params, features, count, values, valid);
+        return;
+    }
+
+    inputs.front()->evaluateNumbers(params, features, count, values, valid);
+    if (inputs.size() == 1) {
+        return;
+    }
+
+    // Features whose first input isn't a number fall back to the other inputs.
+    EvaluationContext context = params;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!valid[i]) {
+            context.feature = features[i];
+            const EvaluationResult result = evaluate(context);
+            valid[i] = result && result->is<double>();
+            values[i] = valid[i] ? result->get<double>() : 0.0;
+        }
+    }
+}
+
 void Assertion::eachChild(const std::function<void(const Expression&)>& visit) const {
     for(const std::unique_ptr<Expression>& input : inputs) {
         visit(*input);
     }
 };
 
-bool Assertion::operator==(const Expression& e) const {
+bool Assertion::equals(const Expression& e) const {
     if (e.getKind() == Kind::Assertion) {
         auto rhs = static_cast<const Assertion*>(&e);
         return getType() == rhs->getType() && Expression::childrenEqual(inputs, rhs->inputs);
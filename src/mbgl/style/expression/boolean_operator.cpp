@@ -20,7 +20,7 @@ void Any::eachChild(const std::function<void(const Expression&)>& visit) const {
     }
 }
 
-bool Any::operator==(const Expression& e) const {
+bool Any::equals(const Expression& e) const {
     if (e.getKind() == Kind::Any) {
         auto rhs = static_cast<const Any*>(&e);
         return Expression::childrenEqual(inputs, rhs->inputs);
@@ -48,7 +48,7 @@ void All::eachChild(const std::function<void(const Expression&)>& visit) const {
     }
 }
 
-bool All::operator==(const Expression& e) const {
+bool All::equals(const Expression& e) const {
     if (e.getKind() == Kind::All) {
         auto rhs = static_cast<const All*>(&e);
         return Expression::childrenEqual(inputs, rhs->inputs);
@@ -1,4 +1,5 @@
 #include <mbgl/style/expression/case.hpp>
+#include <mbgl/style/expression/literal.hpp>
 #include <mbgl/style/conversion_impl.hpp>
 #include <mbgl/util/string.hpp>
 
@@ -6,18 +7,39 @@ namespace mbgl {
 namespace style {
 namespace expression {
 
-EvaluationResult Case::evaluate(const EvaluationContext& params) const {
+Case::Case(type::Type type_, std::vector<Branch> branches_, std::unique_ptr<Expression> otherwise_)
+    : Expression(Kind::Case, std::move(type_)),
+      branches(std::move(branches_)),
+      otherwise(std::move(otherwise_)),
+      fallback(otherwise.get()) {
+    // Tests that are constant are resolved once here rather than for every evaluation.
     for (const auto& branch : branches) {
-        const EvaluationResult evaluatedTest = branch.first->evaluate(params);
+        if (branch.first->getKind() == Kind::Literal) {
+            const Value test = static_cast<const Literal&>(*branch.first).getValue();
+            if (test.is<bool>() && !test.get<bool>()) {
+                continue;
+            }
+            if (test.is<bool>() && test.get<bool>()) {
+                fallback = branch.second.get();
+                break;
+            }
+        }
+        liveBranches.push_back(&branch);
+    }
+}
+
+EvaluationResult Case::evaluate(const EvaluationContext& params) const {
+    for (const Branch* branch : liveBranches) {
+        const EvaluationResult evaluatedTest = branch->first->evaluate(params);
         if (!evaluatedTest) {
             return evaluatedTest.error();
         }
         if (evaluatedTest->get<bool>()) {
-            return branch.second->evaluate(params);
+            return branch->second->evaluate(params);
         }
     }
     
-    return otherwise->evaluate(params);
+    return fallback->evaluate(params);
 }
 
 void Case::eachChild(const std::function<void(const Expression&)>& visit) const {
@@ -28,7 +50,7 @@ void Case::eachChild(const std::function<void(const Expression&)>& visit) const
     visit(*otherwise);
 }
 
-bool Case::operator==(const Expression& e) const {
+bool Case::equals(const Expression& e) const {
     if (e.getKind() == Kind::Case) {
         auto rhs = static_cast<const Case*>(&e);
         return *otherwise == *(rhs->otherwise) && Expression::childrenEqual(branches, rhs->branches);
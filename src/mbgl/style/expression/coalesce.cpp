@@ -1,4 +1,5 @@
 #include <mbgl/style/expression/coalesce.hpp>
+#include <mbgl/style/expression/literal.hpp>
 #include <mbgl/style/expression/check_subtype.hpp>
 #include <mbgl/style/conversion_impl.hpp>
 
@@ -6,11 +7,26 @@ namespace mbgl {
 namespace style {
 namespace expression {
 
+Coalesce::Coalesce(const type::Type& type_, Args args_)
+    : Expression(Kind::Coalesce, type_), args(std::move(args_)) {
+    for (const auto& arg : args) {
+        // Images have to be checked for availability at evaluation time, so they are never skipped.
+        if (getType() != type::Image && arg->getKind() == Kind::Literal) {
+            if (static_cast<const Literal&>(*arg).getValue() == Null) {
+                continue;
+            }
+            liveArgs.push_back(arg.get());
+            break;
+        }
+        liveArgs.push_back(arg.get());
+    }
+}
+
 EvaluationResult Coalesce::evaluate(const EvaluationContext& params) const {
     EvaluationResult result = Null;
-    std::size_t argsCount = args.size();
+    std::size_t argsCount = liveArgs.size();
     std::optional<Image> requestedImage;
-    for (const auto& arg : args) {
+    for (const Expression* arg : liveArgs) {
         --argsCount;
         result = arg->evaluate(params);
         // We need to keep track of the first requested image in a coalesce statement.
@@ -35,7 +51,7 @@ void Coalesce::eachChild(const std::function<void(const Expression&)>& visit) co
     }
 }
 
-bool Coalesce::operator==(const Expression& e) const {
+bool Coalesce::equals(const Expression& e) const {
     if (e.getKind() == Kind::Coalesce) {
         auto rhs = static_cast<const Coalesce*>(&e);
         return Expression::childrenEqual(args, rhs->args);
@@ -199,7 +199,7 @@ void Coercion::eachChild(const std::function<void(const Expression&)>& visit) co
     }
 };
 
-bool Coercion::operator==(const Expression& e) const {
+bool Coercion::equals(const Expression& e) const {
     if (e.getKind() == Kind::Coercion) {
         auto rhs = static_cast<const Coercion*>(&e);
         return getType() == rhs->getType() && Expression::childrenEqual(inputs, rhs->inputs);
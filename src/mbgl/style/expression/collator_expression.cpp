@@ -73,7 +73,7 @@ void CollatorExpression::eachChild(const std::function<void(const Expression&)>&
     }
 }
     
-bool CollatorExpression::operator==(const Expression& e) const {
+bool CollatorExpression::equals(const Expression& e) const {
     if (e.getKind() == Kind::CollatorExpression) {
         auto rhs = static_cast<const CollatorExpression*>(&e);
         if ((locale && (!rhs->locale || **locale != **(rhs->locale))) ||
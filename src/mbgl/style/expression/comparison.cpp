@@ -146,7 +146,7 @@ void BasicComparison::eachChild(const std::function<void(const Expression&)>& vi
 
 std::string BasicComparison::getOperator() const { return op; }
 
-bool BasicComparison::operator==(const Expression& e) const {
+bool BasicComparison::equals(const Expression& e) const {
     if (e.getKind() == Kind::Comparison) {
         auto comp = static_cast<const BasicComparison*>(&e);
         return comp->op == op &&
@@ -206,7 +206,7 @@ void CollatorComparison::eachChild(const std::function<void(const Expression&)>&
 
 std::string CollatorComparison::getOperator() const { return op; }
 
-bool CollatorComparison::operator==(const Expression& e) const {
+bool CollatorComparison::equals(const Expression& e) const {
     if (e.getKind() == Kind::Comparison) {
         auto comp = static_cast<const CollatorComparison*>(&e);
         return comp->op == op &&
@@ -1174,7 +1174,7 @@ void CompoundExpression::eachChild(const std::function<void(const Expression&)>&
     }
 }
 
-bool CompoundExpression::operator==(const Expression& e) const {
+bool CompoundExpression::equals(const Expression& e) const {
     if (e.getKind() == Kind::CompoundExpression) {
         auto rhs = static_cast<const CompoundExpression*>(&e);
         return signature.name == rhs->signature.name &&
@@ -862,7 +862,7 @@ mbgl::Value Distance::serialize() const {
     return std::vector<mbgl::Value>{{getOperator(), serialized}};
 }
 
-bool Distance::operator==(const Expression& e) const {
+bool Distance::equals(const Expression& e) const {
     if (e.getKind() == Kind::Distance) {
         auto rhs = static_cast<const Distance*>(&e);
         return geoJSONSource == rhs->geoJSONSource && geometries == rhs->geometries;
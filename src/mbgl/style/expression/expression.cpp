@@ -1,6 +1,10 @@
 #include <mbgl/style/expression/compound_expression.hpp>
 #include <mbgl/style/expression/expression.hpp>
+#include <mbgl/style/expression/shared_subexpression.hpp>
 #include <mbgl/tile/geometry_tile_data.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include <utility>
 
 namespace mbgl {
@@ -42,6 +46,24 @@ private:
     FeatureType getTypeImpl() const { return apply_visitor(ToFeatureType(), feature.geometry); }
 };
 
+namespace {
+
+const Expression& unwrap(const Expression& expression) {
+    if (expression.getKind() == Kind::SharedSubexpression) {
+        return static_cast<const SharedSubexpression&>(expression).getExpression();
+    }
+    return expression;
+}
+
+} // namespace
+
+bool Expression::operator==(const Expression& rhs) const {
+    const Expression& left = unwrap(*this);
+    const Expression& right = unwrap(rhs);
+    // Occurrences of a shared subexpression unwrap to the same node.
+    return &left == &right || left.equals(right);
+}
+
 EvaluationResult Expression::evaluate(std::optional<float> zoom,
                                       const Feature& feature,
                                       std::optional<double> colorRampParameter) const {
@@ -74,6 +96,72 @@ EvaluationResult Expression::evaluate(std::optional<mbgl::Value> accumulated, co
     return this->evaluate(EvaluationContext(std::move(accumulated), &f));
 }
 
+void Expression::evaluateNumbers(const EvaluationContext& params,
+                                 const GeometryTileFeature* const* features,
+                                 std::size_t count,
+                                 double* values,
+                                 bool* valid) const {
+    EvaluationContext context = params;
+    for (std::size_t i = 0; i < count; ++i) {
+        context.feature = features[i];
+        const EvaluationResult result = evaluate(context);
+        valid[i] = result && result->is<double>();
+        values[i] = valid[i] ? result->get<double>() : 0.0;
+    }
+}
+
+void Expression::evaluateSelectedNumbers(const EvaluationContext& params,
+                                         const GeometryTileFeature* const* features,
+                                         std::size_t count,
+                                         const Expression* const* outputs,
+                                         double* values,
+                                         bool* valid) {
+    if (count == 0) {
+        return;
+    }
+
+    // Most batches select the same output for every feature, e.g. when the selection depends
+    // on the zoom level only.
+    const Expression* first = outputs[0];
+    if (first && std::all_of(outputs, outputs + count, [&](const Expression* output) { return output == first; })) {
+        first->evaluateNumbers(params, features, count, values, valid);
+        return;
+    }
+
+    // The outputs are among the few stops or branches of the selecting expression, so a linear
+    // search finds the distinct ones.
+    std::vector<const Expression*> distinct;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!outputs[i]) {
+            valid[i] = false;
+            values[i] = 0.0;
+        } else if (std::find(distinct.begin(), distinct.end(), outputs[i]) == distinct.end()) {
+            distinct.push_back(outputs[i]);
+        }
+    }
+
+    std::vector<std::size_t> indices;
+    std::vector<const GeometryTileFeature*> groupFeatures;
+    std::vector<double> groupValues;
+    std::unique_ptr<bool[]> groupValid = std::make_unique<bool[]>(count);
+    for (const Expression* output : distinct) {
+        indices.clear();
+        groupFeatures.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (outputs[i] == output) {
+                indices.push_back(i);
+                groupFeatures.push_back(features[i]);
+            }
+        }
+        groupValues.resize(indices.size());
+        output->evaluateNumbers(params, groupFeatures.data(), indices.size(), groupValues.data(), groupValid.get());
+        for (std::size_t j = 0; j < indices.size(); ++j) {
+            values[indices[j]] = groupValues[j];
+            valid[indices[j]] = groupValid[j];
+        }
+    }
+}
+
 } // namespace expression
 } // namespace style
 } // namespace mbgl
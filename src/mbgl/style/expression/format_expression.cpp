@@ -111,7 +111,7 @@ void FormatExpression::eachChild(const std::function<void(const Expression&)>& f
     }
 }
 
-bool FormatExpression::operator==(const Expression& e) const {
+bool FormatExpression::equals(const Expression& e) const {
     if (e.getKind() == Kind::FormatExpression) {
         auto rhs = static_cast<const FormatExpression*>(&e);
         if (sections.size() != rhs->sections.size()) {
@@ -34,7 +34,7 @@ void ImageExpression::eachChild(const std::function<void(const Expression&)>& fn
     fn(*imageID);
 }
 
-bool ImageExpression::operator==(const Expression& e) const {
+bool ImageExpression::equals(const Expression& e) const {
     if (e.getKind() == Kind::ImageExpression) {
         auto rhs = static_cast<const ImageExpression*>(&e);
         return *imageID == *rhs->imageID;
@@ -1,5 +1,6 @@
 #include <mbgl/style/conversion_impl.hpp>
 #include <mbgl/style/expression/in.hpp>
+#include <mbgl/style/expression/literal.hpp>
 #include <mbgl/style/expression/type.hpp>
 #include <mbgl/util/string.hpp>
 
@@ -32,14 +33,25 @@ In::In(std::unique_ptr<Expression> needle_, std::unique_ptr<Expression> haystack
     : Expression(Kind::In, type::Boolean), needle(std::move(needle_)), haystack(std::move(haystack_)) {
     assert(isComparableType(needle->getType()));
     assert(isSearchableType(haystack->getType()));
+    if (haystack->getKind() == Kind::Literal) {
+        constantHaystack = static_cast<const Literal&>(*haystack).getValue();
+    }
 }
 
 EvaluationResult In::evaluate(const EvaluationContext& params) const {
+    if (constantHaystack) {
+        return search(*constantHaystack, params);
+    }
+
     const EvaluationResult evaluatedHaystack = haystack->evaluate(params);
     if (!evaluatedHaystack) {
         return evaluatedHaystack.error();
     }
 
+    return search(*evaluatedHaystack, params);
+}
+
+EvaluationResult In::search(const Value& haystackValue, const EvaluationContext& params) const {
     const EvaluationResult evaluatedNeedle = needle->evaluate(params);
     if (!evaluatedNeedle) {
         return evaluatedNeedle.error();
@@ -51,7 +63,7 @@ EvaluationResult In::evaluate(const EvaluationContext& params) const {
                                toString(evaluatedNeedleType) + " instead."};
     }
 
-    type::Type evaluatedHaystackType = typeOf(*evaluatedHaystack);
+    type::Type evaluatedHaystackType = typeOf(haystackValue);
     if (!isSearchableRuntimeType(evaluatedHaystackType)) {
         return EvaluationError{"Expected second argument to be of type array or string, but found " +
                                toString(evaluatedHaystackType) + " instead."};
@@ -62,11 +74,11 @@ EvaluationResult In::evaluate(const EvaluationContext& params) const {
     }
 
     if (evaluatedHaystackType == type::String) {
-        const auto haystackString = evaluatedHaystack->get<std::string>();
+        const auto& haystackString = haystackValue.get<std::string>();
         const auto needleString = toString(*evaluatedNeedle);
         return EvaluationResult(haystackString.find(needleString) != std::string::npos);
     } else {
-        const auto haystackArray = evaluatedHaystack->get<std::vector<Value>>();
+        const auto& haystackArray = haystackValue.get<std::vector<Value>>();
         return EvaluationResult(std::find(haystackArray.begin(), haystackArray.end(), *evaluatedNeedle) !=
                                 haystackArray.end());
     }
@@ -110,7 +122,7 @@ ParseResult In::parse(const Convertible& value, ParsingContext& ctx) {
     return ParseResult(std::make_unique<In>(std::move(*needle), std::move(*haystack)));
 }
 
-bool In::operator==(const Expression& e) const {
+bool In::equals(const Expression& e) const {
     if (e.getKind() == Kind::In) {
         auto rhs = static_cast<const In*>(&e);
         return *needle == *(rhs->needle) && *haystack == *(rhs->haystack);
@@ -2,6 +2,8 @@
 #include <mbgl/style/conversion_impl.hpp>
 #include <mbgl/util/string.hpp>
 
+#include <algorithm>
+
 namespace mbgl {
 namespace style {
 namespace expression {
@@ -272,6 +274,77 @@ Interpolate::Interpolate(const type::Type& type_,
     assert(input->getType() == type::Number);
 }
 
+void Interpolate::evaluateNumbers(const EvaluationContext& params,
+                                  const GeometryTileFeature* const* features,
+                                  std::size_t count,
+                                  double* values,
+                                  bool* valid) const {
+    if (getType() != type::Number || stops.empty()) {
+        Expression::evaluateNumbers(params, features, count, values, valid);
+        return;
+    }
+
+    std::vector<double> labels;
+    std::vector<const Expression*> outputs;
+    labels.reserve(stops.size());
+    outputs.reserve(stops.size());
+    for (const auto& stop : stops) {
+        labels.push_back(stop.first);
+        outputs.push_back(stop.second.get());
+    }
+
+    std::vector<double> inputs(count);
+    std::unique_ptr<bool[]> inputValid = std::make_unique<bool[]>(count);
+    input->evaluateNumbers(params, features, count, inputs.data(), inputValid.get());
+
+    // The stops to blend for each feature, and the factor to blend them with. Features that
+    // fall on or outside a stop only have a lower stop.
+    std::vector<const Expression*> lower(count, nullptr);
+    std::vector<const Expression*> upper(count, nullptr);
+    std::vector<double> factors(count, 0.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!inputValid[i]) {
+            continue;
+        }
+        const float x = static_cast<float>(inputs[i]);
+        if (std::isnan(x)) {
+            continue;
+        }
+        const std::size_t k = std::upper_bound(labels.begin(), labels.end(), x) - labels.begin();
+        if (k == labels.size()) {
+            lower[i] = outputs.back();
+        } else if (k == 0) {
+            lower[i] = outputs.front();
+        } else {
+            const double t = interpolationFactor({labels[k - 1], labels[k]}, x);
+            if (t == 0.0) {
+                lower[i] = outputs[k - 1];
+            } else if (t == 1.0) {
+                lower[i] = outputs[k];
+            } else {
+                lower[i] = outputs[k - 1];
+                upper[i] = outputs[k];
+                factors[i] = t;
+            }
+        }
+    }
+
+    evaluateSelectedNumbers(params, features, count, lower.data(), values, valid);
+    if (std::none_of(upper.begin(), upper.end(), [](const Expression* output) { return output != nullptr; })) {
+        return;
+    }
+
+    std::vector<double> upperValues(count);
+    std::unique_ptr<bool[]> upperValid = std::make_unique<bool[]>(count);
+    evaluateSelectedNumbers(params, features, count, upper.data(), upperValues.data(), upperValid.get());
+    for (std::size_t i = 0; i < count; ++i) {
+        if (upper[i]) {
+            valid[i] = valid[i] && upperValid[i];
+            values[i] = valid[i] ? util::interpolate(values[i], upperValues[i], factors[i]) : 0.0;
+        }
+    }
+}
+
 std::vector<std::optional<Value>> Interpolate::possibleOutputs() const {
     std::vector<std::optional<Value>> result;
     for (const auto& stop : stops) {
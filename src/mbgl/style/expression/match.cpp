@@ -18,7 +18,7 @@ void Match<T>::eachChild(const std::function<void(const Expression&)>& visit) co
 }
 
 template <typename T>
-bool Match<T>::operator==(const Expression& e) const {
+bool Match<T>::equals(const Expression& e) const {
     if (e.getKind() == Kind::Match) {
         auto rhs = static_cast<const Match*>(&e);
         return (*input == *(rhs->input) &&
@@ -79,44 +79,66 @@ mbgl::Value Match<T>::serialize() const {
 }
     
 
-template<> EvaluationResult Match<std::string>::evaluate(const EvaluationContext& params) const {
-    const EvaluationResult inputValue = input->evaluate(params);
-    if (!inputValue) {
-        return inputValue.error();
+template <>
+const Expression& Match<std::string>::findOutput(const Value& inputValue) const {
+    if (!inputValue.is<std::string>()) {
+        return *otherwise;
     }
 
-    if (!inputValue->is<std::string>()) {
-        return otherwise->evaluate(params);
+    auto it = branches.find(inputValue.get<std::string>());
+    if (it != branches.end()) {
+        return *(*it).second;
     }
 
-    auto it = branches.find(inputValue->get<std::string>());
-    if (it != branches.end()) {
-        return (*it).second->evaluate(params);
+    return *otherwise;
+}
+
+template <>
+const Expression& Match<int64_t>::findOutput(const Value& inputValue) const {
+    if (!inputValue.is<double>()) {
+        return *otherwise;
+    }
+
+    const auto numeric = inputValue.get<double>();
+    const auto rounded = static_cast<int64_t>(std::floor(numeric));
+    if (numeric == rounded) {
+        auto it = branches.find(rounded);
+        if (it != branches.end()) {
+            return *(*it).second;
+        }
     }
 
-    return otherwise->evaluate(params);
+    return *otherwise;
 }
 
-template<> EvaluationResult Match<int64_t>::evaluate(const EvaluationContext& params) const {
+template <typename T>
+EvaluationResult Match<T>::evaluate(const EvaluationContext& params) const {
     const EvaluationResult inputValue = input->evaluate(params);
     if (!inputValue) {
         return inputValue.error();
     }
 
-    if (!inputValue->is<double>()) {
-        return otherwise->evaluate(params);
-    }
+    return findOutput(*inputValue).evaluate(params);
+}
 
-    const auto numeric = inputValue->get<double>();
-    const auto rounded = static_cast<int64_t>(std::floor(numeric));
-    if (numeric == rounded) {
-        auto it = branches.find(rounded);
-        if (it != branches.end()) {
-            return (*it).second->evaluate(params);
+template <typename T>
+void Match<T>::evaluateNumbers(const EvaluationContext& params,
+                               const GeometryTileFeature* const* features,
+                               std::size_t count,
+                               double* values,
+                               bool* valid) const {
+    // The input is evaluated per feature, the selected outputs in batches.
+    std::vector<const Expression*> selected(count, nullptr);
+    EvaluationContext context = params;
+    for (std::size_t i = 0; i < count; ++i) {
+        context.feature = features[i];
+        const EvaluationResult inputValue = input->evaluate(context);
+        if (inputValue) {
+            selected[i] = &findOutput(*inputValue);
         }
     }
-    
-    return otherwise->evaluate(params);
+
+    evaluateSelectedNumbers(params, features, count, selected.data(), values, valid);
 }
 
 template class Match<int64_t>;
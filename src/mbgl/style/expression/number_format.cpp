@@ -86,7 +86,7 @@ void NumberFormat::eachChild(const std::function<void(const Expression&)>& visit
     if (maxFractionDigits) visit(*maxFractionDigits);
 }
 
-bool NumberFormat::operator==(const Expression& e) const {
+bool NumberFormat::equals(const Expression& e) const {
     if (e.getKind() == Kind::NumberFormat) {
         auto rhs = static_cast<const NumberFormat*>(&e);
         if ((locale && (!rhs->locale || *locale != *rhs->locale)) ||
@@ -23,6 +23,7 @@
 #include <mbgl/style/expression/literal.hpp>
 #include <mbgl/style/expression/match.hpp>
 #include <mbgl/style/expression/number_format.hpp>
+#include <mbgl/style/expression/shared_subexpression.hpp>
 #include <mbgl/style/expression/step.hpp>
 #include <mbgl/style/expression/within.hpp>
 
@@ -183,6 +184,10 @@ ParseResult ParsingContext::parse(const Convertible& value,
         return parsed;
     }
 
+    // Shared before any type annotation, so that the same subexpression is found wherever it
+    // occurs, whatever type is expected there.
+    parsed = SubexpressionPool::share(std::move(*parsed));
+
     auto annotate = [](std::unique_ptr<Expression> expression,
                        const type::Type& type,
                        TypeAnnotationOption typeAnnotation) -> std::unique_ptr<Expression> {
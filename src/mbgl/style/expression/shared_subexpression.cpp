@@ -0,0 +1,207 @@
+#include <mbgl/style/expression/shared_subexpression.hpp>
+#include <mbgl/style/expression/is_constant.hpp>
+#include <mbgl/style/expression/literal.hpp>
+#include <mbgl/util/hash.hpp>
+#include <mbgl/util/thread_local.hpp>
+
+namespace mbgl {
+namespace style {
+namespace expression {
+
+namespace {
+
+util::ThreadLocal<SubexpressionPool>& currentPool() {
+    static util::ThreadLocal<SubexpressionPool> pool;
+    return pool;
+}
+
+util::ThreadLocal<SubexpressionCache>& currentCache() {
+    static util::ThreadLocal<SubexpressionCache> cache;
+    return cache;
+}
+
+// Whether the expression reads nothing but the feature itself: not the zoom level, the
+// feature state, the tile, the available images or a formatted section, and no bindings.
+bool dependsOnFeatureOnly(const Expression& expression) {
+    switch (expression.getKind()) {
+    case Kind::Within:
+    case Kind::Distance:
+    case Kind::FormatSectionOverride:
+    case Kind::ImageExpression:
+    case Kind::Let:
+    case Kind::Var:
+    case Kind::Error:
+        return false;
+    case Kind::CompoundExpression: {
+        const std::string op = expression.getOperator();
+        if (op == "zoom" || op == "heatmap-density" || op == "line-progress" || op == "accumulated" ||
+            op == "feature-state" || op == "error") {
+            return false;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    bool result = true;
+    expression.eachChild([&](const Expression& child) { result = result && dependsOnFeatureOnly(child); });
+    return result;
+}
+
+// Expressions that are worth sharing: evaluating them costs more than looking up a result.
+bool isShareable(const Expression& expression) {
+    switch (expression.getKind()) {
+    case Kind::Coalesce:
+    case Kind::Case:
+    case Kind::Match:
+    case Kind::Comparison:
+    case Kind::Coercion:
+    case Kind::In:
+    case Kind::At:
+    case Kind::Length:
+    case Kind::NumberFormat:
+        break;
+    case Kind::CompoundExpression: {
+        const std::string op = expression.getOperator();
+        if (op == "get" || op == "has" || op == "id" || op == "geometry-type" || op == "properties") {
+            return false;
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+
+    const type::Type type = expression.getType();
+    return type != type::Image && type != type::Formatted && !isFeatureConstant(expression) &&
+           dependsOnFeatureOnly(expression);
+}
+
+std::size_t valueHash(const Value& value) {
+    return value.match(
+        [](const NullValue&) -> std::size_t { return 0; },
+        [](bool b) -> std::size_t { return std::hash<bool>()(b); },
+        // 0 and -0 compare equal.
+        [](double d) -> std::size_t { return d == 0 ? 0 : std::hash<double>()(d); },
+        [](const std::string& string) -> std::size_t { return std::hash<std::string>()(string); },
+        [](const std::vector<Value>& values) -> std::size_t {
+            std::size_t seed = values.size();
+            for (const auto& element : values) {
+                util::hash_combine(seed, valueHash(element));
+            }
+            return seed;
+        },
+        [](const auto&) -> std::size_t { return 1; });
+}
+
+// Hashes the operators and literals of an expression tree, so that equal expressions have equal
+// hashes. Data that isn't a child expression, e.g. the labels of match branches, is left out, so
+// unequal expressions may still collide.
+std::size_t structuralHash(const Expression& expression) {
+    if (expression.getKind() == Kind::SharedSubexpression) {
+        return static_cast<const SharedSubexpression&>(expression).getHash();
+    }
+
+    std::size_t seed = std::hash<std::string>()(expression.getOperator());
+    if (expression.getKind() == Kind::Literal) {
+        util::hash_combine(seed, valueHash(static_cast<const Literal&>(expression).getValue()));
+    }
+    expression.eachChild([&](const Expression& child) { util::hash_combine(seed, structuralHash(child)); });
+    return seed;
+}
+
+} // namespace
+
+SharedSubexpression::SharedSubexpression(std::shared_ptr<Node> node_)
+    : Expression(Kind::SharedSubexpression, node_->expression->getType()), node(std::move(node_)) {}
+
+EvaluationResult SharedSubexpression::evaluate(const EvaluationContext& params) const {
+    SubexpressionCache* cache = node->repeated ? currentCache().get() : nullptr;
+    if (!cache || !params.feature || params.feature != cache->feature) {
+        return node->expression->evaluate(params);
+    }
+
+    for (const auto& entry : cache->results) {
+        if (entry.first == node.get()) {
+            return entry.second;
+        }
+    }
+
+    EvaluationResult result = node->expression->evaluate(params);
+    cache->results.emplace_back(node.get(), result);
+    return result;
+}
+
+void SharedSubexpression::evaluateNumbers(const EvaluationContext& params,
+                                          const GeometryTileFeature* const* features,
+                                          std::size_t count,
+                                          double* values,
+                                          bool* valid) const {
+    // A batch spans many features, so the per-feature cache doesn't apply.
+    node->expression->evaluateNumbers(params, features, count, values, valid);
+}
+
+void SharedSubexpression::eachChild(const std::function<void(const Expression&)>& visit) const {
+    visit(*node->expression);
+}
+
+bool SharedSubexpression::equals(const Expression& e) const {
+    return *node->expression == e;
+}
+
+std::vector<std::optional<Value>> SharedSubexpression::possibleOutputs() const {
+    return node->expression->possibleOutputs();
+}
+
+mbgl::Value SharedSubexpression::serialize() const {
+    return node->expression->serialize();
+}
+
+std::string SharedSubexpression::getOperator() const {
+    return node->expression->getOperator();
+}
+
+SubexpressionPool::SubexpressionPool() : previous(currentPool().get()) {
+    currentPool().set(this);
+}
+
+SubexpressionPool::~SubexpressionPool() {
+    currentPool().set(previous);
+}
+
+std::unique_ptr<Expression> SubexpressionPool::share(std::unique_ptr<Expression> expression) {
+    SubexpressionPool* pool = currentPool().get();
+    if (!pool || !isShareable(*expression)) {
+        return expression;
+    }
+
+    const std::size_t hash = structuralHash(*expression);
+    auto& candidates = pool->nodes[hash];
+    for (const auto& candidate : candidates) {
+        if (*candidate->expression == *expression) {
+            candidate->repeated = true;
+            return std::make_unique<SharedSubexpression>(candidate);
+        }
+    }
+
+    candidates.push_back(std::make_shared<SharedSubexpression::Node>(std::move(expression), hash));
+    return std::make_unique<SharedSubexpression>(candidates.back());
+}
+
+SubexpressionCache::SubexpressionCache() : previous(currentCache().get()) {
+    currentCache().set(this);
+}
+
+SubexpressionCache::~SubexpressionCache() {
+    currentCache().set(previous);
+}
+
+void SubexpressionCache::beginFeature(const GeometryTileFeature& feature_) {
+    feature = &feature_;
+    results.clear();
+}
+
+} // namespace expression
+} // namespace style
+} // namespace mbgl
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <mbgl/style/expression/expression.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mbgl {
+namespace style {
+namespace expression {
+
+/**
+ * @brief SharedSubexpression stands for a subexpression that only depends on the feature
+ *
+ * While a SubexpressionPool is active on the parsing thread, ParsingContext replaces such
+ * subexpressions with a SharedSubexpression, and all the occurrences of equal subexpressions
+ * among the properties of a layer refer to the same node. While a SubexpressionCache is
+ * active on the evaluating thread, nodes that occur more than once are evaluated once per
+ * feature, and every other occurrence reuses the result.
+ *
+ * Serialization and equality see through the wrapper, so styles round-trip unchanged.
+ */
+class SharedSubexpression final : public Expression {
+public:
+    struct Node {
+        Node(std::unique_ptr<Expression> expression_, std::size_t hash_)
+            : expression(std::move(expression_)), hash(hash_) {}
+
+        const std::unique_ptr<Expression> expression;
+        // Structural hash of the expression, equal for equal expressions.
+        const std::size_t hash;
+        // Set once the subexpression is found a second time, while parsing.
+        bool repeated = false;
+    };
+
+    explicit SharedSubexpression(std::shared_ptr<Node>);
+
+    EvaluationResult evaluate(const EvaluationContext& params) const override;
+    void evaluateNumbers(const EvaluationContext& params,
+                         const GeometryTileFeature* const* features,
+                         std::size_t count,
+                         double* values,
+                         bool* valid) const override;
+    void eachChild(const std::function<void(const Expression&)>& visit) const override;
+
+    bool equals(const Expression& e) const override;
+
+    std::vector<std::optional<Value>> possibleOutputs() const override;
+
+    mbgl::Value serialize() const override;
+    std::string getOperator() const override;
+
+    const Expression& getExpression() const { return *node->expression; }
+    bool isRepeated() const { return node->repeated; }
+    std::size_t getHash() const { return node->hash; }
+
+private:
+    const std::shared_ptr<Node> node;
+};
+
+/**
+ * @brief SubexpressionPool collects the shareable subexpressions parsed on this thread
+ *
+ * The pool is active from construction to destruction; pools nest.
+ */
+class SubexpressionPool {
+public:
+    SubexpressionPool();
+    ~SubexpressionPool();
+
+    SubexpressionPool(const SubexpressionPool&) = delete;
+    SubexpressionPool& operator=(const SubexpressionPool&) = delete;
+
+    // Returns the given expression, or a SharedSubexpression standing for it if a pool is
+    // active and the expression only depends on the feature.
+    static std::unique_ptr<Expression> share(std::unique_ptr<Expression>);
+
+private:
+    SubexpressionPool* const previous;
+    // Keyed by structural hash; expressions are only compared in depth when their hashes match.
+    std::unordered_map<std::size_t, std::vector<std::shared_ptr<SharedSubexpression::Node>>> nodes;
+};
+
+/**
+ * @brief SubexpressionCache keeps the results of repeated subexpressions for one feature
+ *
+ * The cache is active from construction to destruction on the thread that constructs it.
+ * Results are only reused for evaluations of the feature passed to the last call of
+ * beginFeature().
+ */
+class SubexpressionCache {
+public:
+    SubexpressionCache();
+    ~SubexpressionCache();
+
+    SubexpressionCache(const SubexpressionCache&) = delete;
+    SubexpressionCache& operator=(const SubexpressionCache&) = delete;
+
+    void beginFeature(const GeometryTileFeature&);
+
+private:
+    friend class SharedSubexpression;
+
+    SubexpressionCache* const previous;
+    const GeometryTileFeature* feature = nullptr;
+    // Few subexpressions are repeated within a layer, so a linear search beats hashing.
+    std::vector<std::pair<const SharedSubexpression::Node*, EvaluationResult>> results;
+};
+
+} // namespace expression
+} // namespace style
+} // namespace mbgl
@@ -3,6 +3,7 @@
 #include <mbgl/style/conversion_impl.hpp>
 #include <mbgl/util/string.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 namespace mbgl {
@@ -44,6 +45,45 @@ EvaluationResult Step::evaluate(const EvaluationContext& params) const {
     }
 }
 
+void Step::evaluateNumbers(const EvaluationContext& params,
+                           const GeometryTileFeature* const* features,
+                           std::size_t count,
+                           double* values,
+                           bool* valid) const {
+    if (stops.empty()) {
+        Expression::evaluateNumbers(params, features, count, values, valid);
+        return;
+    }
+
+    std::vector<double> labels;
+    std::vector<const Expression*> outputs;
+    labels.reserve(stops.size());
+    outputs.reserve(stops.size());
+    for (const auto& stop : stops) {
+        labels.push_back(stop.first);
+        outputs.push_back(stop.second.get());
+    }
+
+    std::vector<double> inputs(count);
+    std::unique_ptr<bool[]> inputValid = std::make_unique<bool[]>(count);
+    input->evaluateNumbers(params, features, count, inputs.data(), inputValid.get());
+
+    std::vector<const Expression*> selected(count, nullptr);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!inputValid[i]) {
+            continue;
+        }
+        const float x = static_cast<float>(inputs[i]);
+        if (std::isnan(x)) {
+            continue;
+        }
+        const std::size_t k = std::upper_bound(labels.begin(), labels.end(), x) - labels.begin();
+        selected[i] = outputs[k == 0 ? 0 : k - 1];
+    }
+
+    evaluateSelectedNumbers(params, features, count, selected.data(), values, valid);
+}
+
 void Step::eachChild(const std::function<void(const Expression&)>& visit) const {
     visit(*input);
     for (const auto& stop : stops) {
@@ -57,7 +97,7 @@ void Step::eachStop(const std::function<void(double, const Expression&)>& visit)
     }
 }
 
-bool Step::operator==(const Expression& e) const {
+bool Step::equals(const Expression& e) const {
     if (e.getKind() == Kind::Step) {
         auto rhs = static_cast<const Step*>(&e);
         return *input == *(rhs->input) && Expression::childrenEqual(stops, rhs->stops);
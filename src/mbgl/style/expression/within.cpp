@@ -310,7 +310,7 @@ mbgl::Value Within::serialize() const {
     return std::vector<mbgl::Value>{{getOperator(), serialized}};
 }
 
-bool Within::operator==(const Expression& e) const {
+bool Within::equals(const Expression& e) const {
     if (e.getKind() == Kind::Within) {
         auto rhs = static_cast<const Within*>(&e);
         return geoJSONSource == rhs->geoJSONSource && geometries == rhs->geometries;
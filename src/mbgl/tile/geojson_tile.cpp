@@ -36,15 +36,16 @@ void GeoJSONTile::querySourceFeatures(
     if (auto tileData = getData()) {
         if (auto layer = tileData->getLayer({})) {
             auto featureCount = layer->featureCount();
+            auto cursor = layer->makeCursor();
             for (std::size_t i = 0; i < featureCount; i++) {
-                auto feature = layer->getFeature(i);
+                const GeometryTileFeature& feature = cursor->seek(i);
 
                 // Apply filter, if any
-                if (options.filter && !(*options.filter)(style::expression::EvaluationContext { static_cast<float>(this->id.overscaledZ), feature.get() })) {
+                if (options.filter && !(*options.filter)(style::expression::EvaluationContext { static_cast<float>(this->id.overscaledZ), &feature })) {
                     continue;
                 }
 
-                result.push_back(convertFeature(*feature, id.canonical));
+                result.push_back(convertFeature(feature, id.canonical));
             }
         }
     }
@@ -64,11 +64,35 @@ public:
         return std::make_unique<GeoJSONTileFeature>((*features)[i]);
     }
 
+    std::unique_ptr<GeometryTileFeatureCursor> makeCursor() const override {
+        return std::make_unique<Cursor>(*features);
+    }
+
     std::string getName() const override {
         return "";
     }
 
 private:
+    class Cursor final : public GeometryTileFeatureCursor {
+    public:
+        explicit Cursor(const mapbox::feature::feature_collection<int16_t>& features_) : features(features_) {}
+
+        const GeometryTileFeature& seek(std::size_t i) override {
+            feature.reset();
+            return feature.emplace(features[i]);
+        }
+
+        std::unique_ptr<GeometryTileFeature> take() override {
+            auto result = std::make_unique<GeoJSONTileFeature>(std::move(*feature));
+            feature.reset();
+            return result;
+        }
+
+    private:
+        const mapbox::feature::feature_collection<int16_t>& features;
+        std::optional<GeoJSONTileFeature> feature;
+    };
+
     std::shared_ptr<const mapbox::feature::feature_collection<int16_t>> features;
 };
 
@@ -152,9 +152,11 @@ GeometryTile::GeometryTile(const OverscaledTileID& id_,
              id_,
              sourceID,
              obsolete,
+             priority,
              parameters.mode,
              parameters.pixelRatio,
-             parameters.debugOptions & MapDebugOptions::Collision),
+             parameters.debugOptions & MapDebugOptions::Collision,
+             parameters.parseCounters),
       fileSource(parameters.fileSource),
       glyphManager(parameters.glyphManager),
       imageManager(parameters.imageManager),
@@ -175,6 +177,11 @@ void GeometryTile::markObsolete() {
     obsolete = true;
 }
 
+void GeometryTile::setPriority(TaskPriority priority_) {
+    priority = priority_;
+    worker.setPriority(priority_);
+}
+
 void GeometryTile::setError(std::exception_ptr err) {
     loaded = true;
     observer->onTileError(*this, std::move(err));
@@ -360,15 +367,16 @@ void GeometryTile::querySourceFeatures(
         
         if (layer) {
             auto featureCount = layer->featureCount();
+            auto cursor = layer->makeCursor();
             for (std::size_t i = 0; i < featureCount; i++) {
-                auto feature = layer->getFeature(i);
+                const GeometryTileFeature& feature = cursor->seek(i);
 
                 // Apply filter, if any
-                if (options.filter && !(*options.filter)(style::expression::EvaluationContext { static_cast<float>(this->id.overscaledZ), feature.get() })) {
+                if (options.filter && !(*options.filter)(style::expression::EvaluationContext { static_cast<float>(this->id.overscaledZ), &feature })) {
                     continue;
                 }
 
-                result.emplace_back(convertFeature(*feature, id.canonical));
+                result.emplace_back(convertFeature(feature, id.canonical));
             }
         }
     }
@@ -42,6 +42,7 @@ public:
     std::unique_ptr<TileRenderData> createRenderData() override;
     void setLayers(const std::vector<Immutable<style::LayerProperties>>&) override;
     void setShowCollisionBoxes(bool showCollisionBoxes) override;
+    void setPriority(TaskPriority) override;
 
     void onGlyphsAvailable(GlyphMap) override;
     void onImagesAvailable(ImageMap, ImageMap, ImageVersionMap versionMap, uint64_t imageCorrelationID) override;
@@ -106,6 +107,9 @@ private:
 
     // Used to signal the worker that it should abandon parsing this tile as soon as possible.
     std::atomic<bool> obsolete { false };
+    // Priority of the tile's work on the background scheduler, read by the worker when it
+    // fans a parse out.
+    std::atomic<TaskPriority> priority { TaskPriority::Default };
 
     std::shared_ptr<Mailbox> mailbox;
     Actor<GeometryTileWorker> worker;
@@ -15,6 +15,30 @@
 
 namespace mbgl {
 
+namespace {
+
+class GeometryTileLayerCursor final : public GeometryTileFeatureCursor {
+public:
+    explicit GeometryTileLayerCursor(const GeometryTileLayer& layer_) : layer(layer_) {}
+
+    const GeometryTileFeature& seek(std::size_t i) override {
+        feature = layer.getFeature(i);
+        return *feature;
+    }
+
+    std::unique_ptr<GeometryTileFeature> take() override { return std::move(feature); }
+
+private:
+    const GeometryTileLayer& layer;
+    std::unique_ptr<GeometryTileFeature> feature;
+};
+
+} // namespace
+
+std::unique_ptr<GeometryTileFeatureCursor> GeometryTileLayer::makeCursor() const {
+    return std::make_unique<GeometryTileLayerCursor>(*this);
+}
+
 static double signedArea(const GeometryCoordinates& ring) {
     double sum = 0;
 
@@ -54,6 +54,21 @@ public:
     virtual const GeometryCollection& getGeometries() const;
 };
 
+// Sequential access to the features of a layer without allocating a feature object per
+// feature. The cursor owns the feature it points to, which is only valid until the cursor is
+// moved again, and may *not* outlive the layer object.
+class GeometryTileFeatureCursor {
+public:
+    virtual ~GeometryTileFeatureCursor() = default;
+
+    // Points the cursor at the feature at the given position within the layer and returns it.
+    virtual const GeometryTileFeature& seek(std::size_t) = 0;
+
+    // Moves the feature the cursor points to into an object of its own, keeping whatever was
+    // decoded already. The cursor has to be moved again before it is used.
+    virtual std::unique_ptr<GeometryTileFeature> take() = 0;
+};
+
 class GeometryTileLayer {
 public:
     virtual ~GeometryTileLayer() = default;
@@ -63,6 +78,10 @@ public:
     // object may *not* outlive the layer object.
     virtual std::unique_ptr<GeometryTileFeature> getFeature(std::size_t) const = 0;
 
+    // Returns a cursor over the features of this layer. Layers that can reuse feature storage
+    // override this; the default cursor falls back to getFeature().
+    virtual std::unique_ptr<GeometryTileFeatureCursor> makeCursor() const;
+
     virtual std::string getName() const = 0;
 };
 
@@ -0,0 +1,208 @@
+#include <mbgl/tile/geometry_tile_layer_cache.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace mbgl {
+
+struct GeometryTileLayerCache::Budget {
+    explicit Budget(std::size_t maximumSize_) : maximumSize(maximumSize_) {}
+
+    bool isExhausted() const { return size >= maximumSize; }
+
+    std::atomic<std::size_t> size{0};
+    const std::size_t maximumSize;
+};
+
+namespace {
+
+using Budget = GeometryTileLayerCache::Budget;
+
+// Approximate bookkeeping cost of a heap allocation and of a hash map node on top of its value.
+constexpr std::size_t allocationOverhead = 2 * sizeof(void*);
+constexpr std::size_t nodeOverhead = allocationOverhead + 2 * sizeof(void*);
+
+std::size_t sizeOf(const GeometryCollection& geometries) {
+    std::size_t size = geometries.capacity() * sizeof(GeometryCoordinates) + allocationOverhead;
+    for (const auto& ring : geometries) {
+        size += allocationOverhead + ring.capacity() * sizeof(GeometryCoordinate);
+    }
+    return size;
+}
+
+std::size_t sizeOf(const PropertyMap& properties) {
+    std::size_t size = 0;
+    for (const auto& property : properties) {
+        size += sizeof(PropertyMap::value_type) + nodeOverhead + property.first.capacity();
+        if (property.second.is<std::string>()) {
+            size += property.second.get<std::string>().capacity();
+        }
+    }
+    return size;
+}
+
+} // namespace
+
+class GeometryTileLayerCache::SharedLayer {
+public:
+    SharedLayer(std::unique_ptr<GeometryTileLayer> layer_, std::shared_ptr<Budget> budget_)
+        : layer(std::move(layer_)),
+          budget(std::move(budget_)),
+          slots(std::make_unique<Slot[]>(layer->featureCount())) {
+        budget->size += layer->featureCount() * sizeof(Slot) + allocationOverhead;
+    }
+
+    // Returns the decoded data of the feature at the given position. The first reader decodes
+    // it into a feature object owned by the cache, while any other reader of the same feature
+    // waits for it. Once the budget is exhausted, data that isn't cached yet is returned from
+    // the reader's own feature object.
+    const GeometryCollection& getGeometries(std::size_t i, const GeometryTileFeature& feature) {
+        Slot& slot = slots[i];
+        std::call_once(slot.geometriesDecoded, [&] {
+            if (const GeometryTileFeature* cached = getCachedFeature(slot, i)) {
+                slot.geometries = &cached->getGeometries();
+                budget->size += sizeOf(*slot.geometries);
+            }
+        });
+        return slot.geometries ? *slot.geometries : feature.getGeometries();
+    }
+
+    const PropertyMap& getProperties(std::size_t i, const GeometryTileFeature& feature) {
+        Slot& slot = slots[i];
+        std::call_once(slot.propertiesDecoded, [&] {
+            if (const GeometryTileFeature* cached = getCachedFeature(slot, i)) {
+                slot.properties = &cached->getProperties();
+                budget->size += sizeOf(*slot.properties);
+            }
+        });
+        return slot.properties ? *slot.properties : feature.getProperties();
+    }
+
+    const std::unique_ptr<GeometryTileLayer> layer;
+
+private:
+    // Decoded data points into the feature object, which lives as long as the layer, so the
+    // references handed out stay valid.
+    struct Slot {
+        std::once_flag created;
+        std::unique_ptr<GeometryTileFeature> feature;
+        std::once_flag geometriesDecoded;
+        const GeometryCollection* geometries = nullptr;
+        std::once_flag propertiesDecoded;
+        const PropertyMap* properties = nullptr;
+    };
+
+    // Returns the cache's own object for the feature, or nullptr if the budget is exhausted, in
+    // which case data that isn't decoded yet is no longer cached.
+    const GeometryTileFeature* getCachedFeature(Slot& slot, std::size_t i) {
+        std::call_once(slot.created, [&] {
+            if (!budget->isExhausted()) {
+                slot.feature = layer->getFeature(i);
+                budget->size += allocationOverhead;
+            }
+        });
+        return slot.feature && !budget->isExhausted() ? slot.feature.get() : nullptr;
+    }
+
+    const std::shared_ptr<Budget> budget;
+    const std::unique_ptr<Slot[]> slots;
+};
+
+namespace {
+
+using SharedLayer = GeometryTileLayerCache::SharedLayer;
+
+// A feature of a shared layer. Type, identifier and single values are read from the underlying
+// feature, while its geometry and properties are decoded once and shared by all readers.
+class CachedFeature final : public GeometryTileFeature {
+public:
+    CachedFeature(SharedLayer& shared_, std::size_t index_, const GeometryTileFeature& feature_)
+        : shared(shared_), index(index_), feature(&feature_) {}
+
+    CachedFeature(SharedLayer& shared_, std::size_t index_, std::unique_ptr<GeometryTileFeature> owned_)
+        : shared(shared_), index(index_), feature(owned_.get()), owned(std::move(owned_)) {}
+
+    FeatureType getType() const override { return feature->getType(); }
+    std::optional<Value> getValue(const std::string& key) const override { return feature->getValue(key); }
+    FeatureIdentifier getID() const override { return feature->getID(); }
+    const PropertyMap& getProperties() const override { return shared.getProperties(index, *feature); }
+    const GeometryCollection& getGeometries() const override { return shared.getGeometries(index, *feature); }
+
+private:
+    SharedLayer& shared;
+    const std::size_t index;
+    const GeometryTileFeature* feature;
+    const std::unique_ptr<GeometryTileFeature> owned;
+};
+
+// Moves an allocation-free cursor over the underlying layer and wraps the current feature in
+// storage the cursor owns, so that moving it doesn't allocate either.
+class CachedLayerCursor final : public GeometryTileFeatureCursor {
+public:
+    explicit CachedLayerCursor(SharedLayer& shared_) : shared(shared_), cursor(shared.layer->makeCursor()) {}
+
+    const GeometryTileFeature& seek(std::size_t i) override {
+        index = i;
+        current.reset();
+        return current.emplace(shared, i, cursor->seek(i));
+    }
+
+    std::unique_ptr<GeometryTileFeature> take() override {
+        current.reset();
+        return std::make_unique<CachedFeature>(shared, index, cursor->take());
+    }
+
+private:
+    SharedLayer& shared;
+    const std::unique_ptr<GeometryTileFeatureCursor> cursor;
+    std::size_t index = 0;
+    std::optional<CachedFeature> current;
+};
+
+class CachedLayer final : public GeometryTileLayer {
+public:
+    explicit CachedLayer(std::shared_ptr<SharedLayer> shared_) : shared(std::move(shared_)) {}
+
+    std::size_t featureCount() const override { return shared->layer->featureCount(); }
+
+    std::unique_ptr<GeometryTileFeature> getFeature(std::size_t i) const override {
+        return std::make_unique<CachedFeature>(*shared, i, shared->layer->getFeature(i));
+    }
+
+    std::unique_ptr<GeometryTileFeatureCursor> makeCursor() const override {
+        return std::make_unique<CachedLayerCursor>(*shared);
+    }
+
+    std::string getName() const override { return shared->layer->getName(); }
+
+private:
+    const std::shared_ptr<SharedLayer> shared;
+};
+
+} // namespace
+
+GeometryTileLayerCache::GeometryTileLayerCache(const GeometryTileData& data_, std::size_t maximumSize)
+    : data(data_), budget(std::make_shared<Budget>(maximumSize)) {}
+
+GeometryTileLayerCache::~GeometryTileLayerCache() = default;
+
+std::unique_ptr<GeometryTileLayer> GeometryTileLayerCache::getLayer(const std::string& name) {
+    auto it = layers.find(name);
+    if (it == layers.end()) {
+        auto layer = data.getLayer(name);
+        if (!layer) {
+            return nullptr;
+        }
+        it = layers.emplace(name, std::make_shared<SharedLayer>(std::move(layer), budget)).first;
+    }
+
+    return std::make_unique<CachedLayer>(it->second);
+}
+
+std::size_t GeometryTileLayerCache::getSize() const {
+    return budget->size;
+}
+
+} // namespace mbgl
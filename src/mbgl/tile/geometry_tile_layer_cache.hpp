@@ -0,0 +1,48 @@
+#pragma once
+
+#include <mbgl/tile/geometry_tile_data.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace mbgl {
+
+/**
+ * @brief GeometryTileLayerCache shares decoded features between the readers of a source layer
+ *
+ * Layer groups that read the same source layer each get their own layer object from
+ * getLayer(), but the features of all those objects are backed by the same storage: the
+ * geometry and properties of each feature are decoded at most once, the first time any of
+ * the readers asks for them, and the readers get references to the same decoded data. Features
+ * may be read from several threads concurrently; a reader that asks for a feature being
+ * decoded by another thread waits for it.
+ *
+ * Each layer holds one small slot per feature, allocated with the layer, while readers move
+ * allocation-free cursors over the underlying layer. Once the decoded data, including the
+ * slots and the bookkeeping overhead of its objects, reaches the size limit, features that
+ * aren't cached yet are read directly from the underlying layer again.
+ */
+class GeometryTileLayerCache {
+public:
+    GeometryTileLayerCache(const GeometryTileData&, std::size_t maximumSize);
+    ~GeometryTileLayerCache();
+
+    // Returns a view of the named layer, or nullptr if the tile has no such layer. The returned
+    // layer object *may* outlive the cache.
+    std::unique_ptr<GeometryTileLayer> getLayer(const std::string& name);
+
+    // Returns the approximate size, in bytes, of the data decoded so far.
+    std::size_t getSize() const;
+
+    // Shared with the layer objects handed out, which keep them alive.
+    struct Budget;
+    class SharedLayer;
+
+private:
+    const GeometryTileData& data;
+    const std::shared_ptr<Budget> budget;
+    std::unordered_map<std::string, std::shared_ptr<SharedLayer>> layers;
+};
+
+} // namespace mbgl
@@ -1,13 +1,17 @@
 #include <mbgl/tile/geometry_tile_worker.hpp>
 #include <mbgl/tile/geometry_tile_data.hpp>
 #include <mbgl/tile/geometry_tile.hpp>
+#include <mbgl/tile/geometry_tile_layer_cache.hpp>
+#include <mbgl/tile/tile_parse_counters.hpp>
 #include <mbgl/layermanager/layer_manager.hpp>
 #include <mbgl/layout/layout.hpp>
 #include <mbgl/layout/symbol_layout.hpp>
 #include <mbgl/layout/pattern_layout.hpp>
+#include <mbgl/platform/settings.hpp>
 #include <mbgl/renderer/bucket_parameters.hpp>
 #include <mbgl/renderer/group_by_layout.hpp>
-#include <mbgl/style/filter.hpp>
+#include <mbgl/style/compiled_filter.hpp>
+#include <mbgl/style/expression/shared_subexpression.hpp>
 #include <mbgl/style/layers/symbol_layer_impl.hpp>
 #include <mbgl/renderer/layers/render_fill_layer.hpp>
 #include <mbgl/renderer/layers/render_fill_extrusion_layer.hpp>
@@ -18,8 +22,13 @@
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/exception.hpp>
+#include <mbgl/util/monotonic_timer.hpp>
 #include <mbgl/util/stopwatch.hpp>
+#include <mbgl/util/thread_pool.hpp>
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <unordered_set>
 #include <utility>
 
@@ -27,24 +36,76 @@ namespace mbgl {
 
 using namespace style;
 
+namespace {
+
+// Shared by the worker and the helper tasks it schedules. Helpers only run groups they
+// claim through `next`, which all happens before the worker stops waiting for them, so a
+// helper starting late only touches this object and returns.
+struct ParallelParseState {
+    explicit ParallelParseState(std::vector<std::size_t> indices_) : indices(std::move(indices_)), remaining(indices.size()) {}
+
+    const std::vector<std::size_t> indices;
+    std::function<void(std::size_t)> parseGroup;
+    std::atomic<std::size_t> next{0};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t remaining;
+
+    // Parses unclaimed groups until there are none left.
+    void help() {
+        for (std::size_t i = next++; i < indices.size(); i = next++) {
+            parseGroup(indices[i]);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) {
+                cv.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return remaining == 0; });
+    }
+};
+
+bool isParallelParsingEnabled() {
+    auto value = platform::Settings::getInstance().get(platform::EXPERIMENTAL_PARALLEL_TILE_PARSING);
+    auto* enabled = value.getBool();
+    return enabled && *enabled;
+}
+
+} // namespace
+
 GeometryTileWorker::GeometryTileWorker(ActorRef<GeometryTileWorker> self_,
                                        ActorRef<GeometryTile> parent_,
                                        OverscaledTileID id_,
                                        std::string sourceID_,
                                        const std::atomic<bool>& obsolete_,
+                                       const std::atomic<TaskPriority>& priority_,
                                        const MapMode mode_,
                                        const float pixelRatio_,
-                                       const bool showCollisionBoxes_)
+                                       const bool showCollisionBoxes_,
+                                       std::shared_ptr<TileParseCounters> parseCounters_)
     : self(std::move(self_)),
       parent(std::move(parent_)),
       id(id_),
       sourceID(std::move(sourceID_)),
       obsolete(obsolete_),
+      priority(priority_),
       mode(mode_),
       pixelRatio(pixelRatio_),
+      parseCounters(std::move(parseCounters_)),
+      parallelParsing(isParallelParsingEnabled()),
       showCollisionBoxes(showCollisionBoxes_) {}
 
-GeometryTileWorker::~GeometryTileWorker() = default;
+GeometryTileWorker::~GeometryTileWorker() {
+    // A parse still waiting for glyphs or images when the tile goes away is abandoned as well.
+    if (hasPendingParseResult()) {
+        countAbandonedParse();
+    }
+}
 
 /*
    GeometryTileWorker is a state machine. This is its transition diagram.
@@ -333,14 +394,47 @@ void GeometryTileWorker::requestNewImages(const ImageDependencies& imageDependen
     }
 }
 
+// One layer group of a tile parsed in parallel mode. The results are staged here and merged
+// into the tile's results in group order once all groups are done.
+struct GeometryTileWorker::ParallelGroup {
+    ParallelGroup(const std::vector<Immutable<style::LayerProperties>>& group_,
+                  std::unique_ptr<GeometryTileLayer> geometryLayer_,
+                  bool independent_)
+        : group(group_),
+          geometryLayer(std::move(geometryLayer_)),
+          independent(independent_),
+          featureIndex(std::make_unique<FeatureIndex>(nullptr)) {}
+
+    const std::vector<Immutable<style::LayerProperties>>& group;
+    std::unique_ptr<GeometryTileLayer> geometryLayer;
+    // Whether the group may be parsed on another thread. Symbol groups stay on the worker.
+    const bool independent;
+
+    std::unique_ptr<FeatureIndex> featureIndex;
+    std::unordered_map<std::string, LayerRenderData> renderData;
+    std::vector<std::unique_ptr<Layout>> layouts;
+    GlyphDependencies glyphDependencies;
+    ImageDependencies imageDependencies;
+    std::exception_ptr error;
+};
+
 void GeometryTileWorker::parse() {
     if (!data || !layers) {
         return;
     }
 
-    MBGL_TIMING_START(watch)
+    // The results of an obsolete tile are never used, so it isn't parsed again once a parse of
+    // it was abandoned.
+    if (obsolete && abandonedCorrelationID) {
+        return;
+    }
 
-    std::unordered_map<std::string, std::unique_ptr<SymbolLayout>> symbolLayoutMap;
+    MBGL_TIMING_START(watch)
+    const auto parseStart = util::MonotonicTimer::now();
+    parseTime = std::chrono::duration<double>::zero();
+    if (parseCounters) {
+        parseCounters->parseStarted();
+    }
 
     renderData.clear();
     layouts.clear();
@@ -356,9 +450,24 @@ void GeometryTileWorker::parse() {
         groupMap[layoutKey(*layer->baseImpl)].push_back(std::move(layer));
     }
 
+    // Source layers read by several layer groups are decoded once and shared between them.
+    std::unordered_map<std::string, std::size_t> sourceLayerReaders;
+    for (const auto& pair : groupMap) {
+        ++sourceLayerReaders[pair.second.at(0)->baseImpl->sourceLayer];
+    }
+
+    std::optional<GeometryTileLayerCache> layerCache;
+    if (*data) {
+        layerCache.emplace(**data, util::DEFAULT_DECODED_LAYER_CACHE_SIZE);
+    }
+
+    std::vector<ParallelGroup> parallelGroups;
+    std::size_t independentGroupCount = 0;
+
     for (auto& pair : groupMap) {
         const auto& group = pair.second;
         if (obsolete) {
+            cancelParse(parseStart);
             return;
         }
 
@@ -367,9 +476,10 @@ void GeometryTileWorker::parse() {
         }
 
         const style::Layer::Impl& leaderImpl = *(group.at(0)->baseImpl);
-        BucketParameters parameters { id, mode, pixelRatio, leaderImpl.getTypeInfo() };
 
-        auto geometryLayer = (*data)->getLayer(leaderImpl.sourceLayer);
+        auto geometryLayer = sourceLayerReaders[leaderImpl.sourceLayer] > 1
+                                 ? layerCache->getLayer(leaderImpl.sourceLayer)
+                                 : (*data)->getLayer(leaderImpl.sourceLayer);
         if (!geometryLayer) {
             continue;
         }
@@ -381,48 +491,74 @@ void GeometryTileWorker::parse() {
 
         featureIndex->setBucketLayerIDs(leaderImpl.id, layerIDs);
 
-        // Symbol layers and layers that support pattern properties have an extra step at layout time to figure out what images/glyphs
-        // are needed to render the layer. They use the intermediate Layout data structure to accomplish this,
-        // and either immediately create a bucket if no images/glyphs are used, or the Layout is stored until
-        // the images/glyphs are available to add the features to the buckets.
-        if (leaderImpl.getTypeInfo()->layout == LayerTypeInfo::Layout::Required) {
-            std::unique_ptr<Layout> layout = LayerManager::get()->createLayout(
-                {parameters, glyphDependencies, imageDependencies, availableImages}, std::move(geometryLayer), group);
-            if (layout->hasDependencies()) {
-                layouts.push_back(std::move(layout));
-            } else {
-                layout->createBucket({}, featureIndex, renderData, firstLoad, showCollisionBoxes, id.canonical);
-            }
+        if (parallelParsing) {
+            // Only symbol layers depend on glyphs and take part in cross-tile placement.
+            const bool independent =
+                leaderImpl.getTypeInfo()->crossTileIndex == LayerTypeInfo::CrossTileIndex::NotRequired;
+            independentGroupCount += independent ? 1 : 0;
+            parallelGroups.emplace_back(group, std::move(geometryLayer), independent);
         } else {
-            const Filter& filter = leaderImpl.filter;
-            const std::string& sourceLayerID = leaderImpl.sourceLayer;
-            std::shared_ptr<Bucket> bucket = LayerManager::get()->createBucket(parameters, group);
+            parseGroup(group,
+                       std::move(geometryLayer),
+                       featureIndex,
+                       renderData,
+                       layouts,
+                       glyphDependencies,
+                       imageDependencies);
+        }
+    }
 
-            for (std::size_t i = 0; !obsolete && i < geometryLayer->featureCount(); i++) {
-                std::unique_ptr<GeometryTileFeature> feature = geometryLayer->getFeature(i);
+    if (independentGroupCount > 1) {
+        parseInParallel(parallelGroups);
 
-                if (!filter(expression::EvaluationContext(static_cast<float>(this->id.overscaledZ), feature.get())
-                                .withCanonicalTileID(&id.canonical)))
-                    continue;
+        if (!obsolete) {
+            // Merge in group order, so that the results match the ones of a sequential parse.
+            for (auto& parallelGroup : parallelGroups) {
+                if (parallelGroup.error) {
+                    std::rethrow_exception(parallelGroup.error);
+                }
 
-                const GeometryCollection& geometries = feature->getGeometries();
-                bucket->addFeature(*feature, geometries, {}, PatternLayerMap(), i, id.canonical);
-                featureIndex->insert(geometries, i, sourceLayerID, leaderImpl.id);
+                featureIndex->append(*parallelGroup.featureIndex);
+                for (auto& entry : parallelGroup.renderData) {
+                    renderData.emplace(entry.first, std::move(entry.second));
+                }
+                for (auto& layout : parallelGroup.layouts) {
+                    layouts.push_back(std::move(layout));
+                }
+                for (const auto& dependency : parallelGroup.glyphDependencies) {
+                    glyphDependencies[dependency.first].insert(dependency.second.begin(), dependency.second.end());
+                }
+                imageDependencies.insert(parallelGroup.imageDependencies.begin(),
+                                         parallelGroup.imageDependencies.end());
             }
-
-            if (!bucket->hasData()) {
-                continue;
+        }
+    } else {
+        // Not worth fanning out; parse the groups in place.
+        for (auto& parallelGroup : parallelGroups) {
+            if (obsolete) {
+                break;
             }
 
-            for (const auto& layer : group) {
-                renderData.emplace(layer->baseImpl->id, LayerRenderData{bucket, layer});
-            }
+            parseGroup(parallelGroup.group,
+                       std::move(parallelGroup.geometryLayer),
+                       featureIndex,
+                       renderData,
+                       layouts,
+                       glyphDependencies,
+                       imageDependencies);
         }
     }
 
+    if (obsolete) {
+        cancelParse(parseStart);
+        return;
+    }
+
     requestNewGlyphs(glyphDependencies);
     requestNewImages(imageDependencies);
 
+    parseTime += util::MonotonicTimer::now() - parseStart;
+
     MBGL_TIMING_FINISH(watch,
                        " Action: " << "Parsing," <<
                        " SourceID: " << sourceID.c_str() <<
@@ -431,6 +567,129 @@ void GeometryTileWorker::parse() {
     finalizeLayout();
 }
 
+void GeometryTileWorker::parseInParallel(std::vector<ParallelGroup>& groups) {
+    std::vector<std::size_t> independent;
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (groups[i].independent) {
+            independent.push_back(i);
+        }
+    }
+
+    auto state = std::make_shared<ParallelParseState>(std::move(independent));
+    state->parseGroup = [this, &groups](std::size_t i) {
+        auto& group = groups[i];
+        try {
+            parseGroup(group.group,
+                       std::move(group.geometryLayer),
+                       group.featureIndex,
+                       group.renderData,
+                       group.layouts,
+                       group.glyphDependencies,
+                       group.imageDependencies);
+        } catch (...) {
+            group.error = std::current_exception();
+        }
+    };
+
+    // The worker keeps one group for itself and helps out once done with the symbol groups,
+    // so the parse completes even if no other thread is available. Helpers beyond the pool's
+    // other threads would only queue up behind this worker.
+    std::shared_ptr<Scheduler> scheduler = Scheduler::GetBackground();
+    const auto* pool = dynamic_cast<const ThreadedSchedulerBase*>(scheduler.get());
+    const std::size_t poolSize = pool ? pool->getThreadCount() : 1;
+    const auto helperCount = std::min<std::size_t>(state->indices.size() - 1, std::max<std::size_t>(1, poolSize - 1));
+    // Helpers run at the tile's priority, so that parsing Low tiles doesn't hold back High ones.
+    for (std::size_t i = 0; i < helperCount; ++i) {
+        scheduler->scheduleWithPriority(priority, [state] { state->help(); });
+    }
+
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (!groups[i].independent) {
+            state->parseGroup(i);
+        }
+    }
+
+    state->help();
+    state->wait();
+}
+
+void GeometryTileWorker::parseGroup(const std::vector<Immutable<style::LayerProperties>>& group,
+                                    std::unique_ptr<GeometryTileLayer> geometryLayer,
+                                    std::unique_ptr<FeatureIndex>& featureIndex_,
+                                    std::unordered_map<std::string, LayerRenderData>& renderData_,
+                                    std::vector<std::unique_ptr<Layout>>& layouts_,
+                                    GlyphDependencies& glyphDependencies,
+                                    ImageDependencies& imageDependencies) {
+    const style::Layer::Impl& leaderImpl = *(group.at(0)->baseImpl);
+    BucketParameters parameters { id, mode, pixelRatio, leaderImpl.getTypeInfo() };
+
+    // Symbol layers and layers that support pattern properties have an extra step at layout time to figure out what images/glyphs
+    // are needed to render the layer. They use the intermediate Layout data structure to accomplish this,
+    // and either immediately create a bucket if no images/glyphs are used, or the Layout is stored until
+    // the images/glyphs are available to add the features to the buckets.
+    if (leaderImpl.getTypeInfo()->layout == LayerTypeInfo::Layout::Required) {
+        std::unique_ptr<Layout> layout = LayerManager::get()->createLayout(
+            {parameters, glyphDependencies, imageDependencies, availableImages, obsolete},
+            std::move(geometryLayer),
+            group);
+        if (obsolete) {
+            // The layout was abandoned half-way; don't build a bucket from it.
+            return;
+        }
+
+        if (layout->hasDependencies()) {
+            layouts_.push_back(std::move(layout));
+        } else {
+            layout->createBucket({}, featureIndex_, renderData_, firstLoad, showCollisionBoxes, id.canonical);
+        }
+    } else {
+        const CompiledFilter filter(leaderImpl.filter);
+        const std::string& sourceLayerID = leaderImpl.sourceLayer;
+        std::shared_ptr<Bucket> bucket = LayerManager::get()->createBucket(parameters, group);
+
+        expression::SubexpressionCache subexpressions;
+        auto cursor = geometryLayer->makeCursor();
+        for (std::size_t i = 0; !obsolete && i < geometryLayer->featureCount(); i++) {
+            const GeometryTileFeature& feature = cursor->seek(i);
+            subexpressions.beginFeature(feature);
+
+            if (!filter(expression::EvaluationContext(static_cast<float>(this->id.overscaledZ), &feature)
+                            .withCanonicalTileID(&id.canonical)))
+                continue;
+
+            const GeometryCollection& geometries = feature.getGeometries();
+            bucket->addFeature(feature, geometries, {}, PatternLayerMap(), i, id.canonical);
+            featureIndex_->insert(geometries, i, sourceLayerID, leaderImpl.id);
+        }
+
+        if (obsolete || !bucket->hasData()) {
+            return;
+        }
+
+        for (const auto& layer : group) {
+            renderData_.emplace(layer->baseImpl->id, LayerRenderData{bucket, layer});
+        }
+    }
+}
+
+void GeometryTileWorker::cancelParse(std::chrono::duration<double> start) {
+    parseTime += util::MonotonicTimer::now() - start;
+    countAbandonedParse();
+
+    // Drop the partial results so that they are never handed to the tile.
+    featureIndex.reset();
+    renderData.clear();
+    layouts.clear();
+}
+
+void GeometryTileWorker::countAbandonedParse() {
+    if (parseCounters && abandonedCorrelationID != correlationID) {
+        parseCounters->parseCancelled(parseTime);
+    }
+    abandonedCorrelationID = correlationID;
+    parseTime = std::chrono::duration<double>::zero();
+}
+
 bool GeometryTileWorker::hasPendingDependencies() const {
     for (auto& glyphDependency : pendingGlyphDependencies) {
         if (!glyphDependency.second.empty()) {
@@ -450,6 +709,7 @@ void GeometryTileWorker::finalizeLayout() {
     }
     
     MBGL_TIMING_START(watch)
+    const auto layoutStart = util::MonotonicTimer::now();
     std::optional<AlphaImage> glyphAtlasImage;
     ImageAtlas iconAtlas = makeImageAtlas(imageMap, patternMap, versionMap);
     if (!layouts.empty()) {
@@ -458,11 +718,17 @@ void GeometryTileWorker::finalizeLayout() {
 
         for (auto& layout : layouts) {
             if (obsolete) {
+                cancelParse(layoutStart);
                 return;
             }
 
             layout->prepareSymbols(glyphMap, glyphAtlas.positions, imageMap, iconAtlas.iconPositions);
 
+            if (obsolete) {
+                cancelParse(layoutStart);
+                return;
+            }
+
             if (!layout->hasSymbolInstances()) {
                 continue;
             }
@@ -471,6 +737,11 @@ void GeometryTileWorker::finalizeLayout() {
             layout->createBucket(
                 iconAtlas.patternPositions, featureIndex, renderData, firstLoad, showCollisionBoxes, id.canonical);
         }
+
+        if (obsolete) {
+            cancelParse(layoutStart);
+            return;
+        }
     }
 
     layouts.clear();
@@ -13,13 +13,17 @@
 #include <mbgl/tile/tile.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
 
 namespace mbgl {
 
 class GeometryTile;
 class GeometryTileData;
+class GeometryTileLayer;
 class Layout;
+class TileParseCounters;
 
 namespace style {
 class Layer;
@@ -32,9 +36,11 @@ public:
                        OverscaledTileID,
                        std::string,
                        const std::atomic<bool>&,
+                       const std::atomic<TaskPriority>&,
                        MapMode,
                        float pixelRatio,
-                       bool showCollisionBoxes_);
+                       bool showCollisionBoxes_,
+                       std::shared_ptr<TileParseCounters> parseCounters_ = nullptr);
     ~GeometryTileWorker();
 
     void setLayers(std::vector<Immutable<style::LayerProperties>>,
@@ -55,7 +61,20 @@ public:
 private:
     void coalesced();
     void parse();
+    void parseGroup(const std::vector<Immutable<style::LayerProperties>>&,
+                    std::unique_ptr<GeometryTileLayer>,
+                    std::unique_ptr<FeatureIndex>&,
+                    std::unordered_map<std::string, LayerRenderData>&,
+                    std::vector<std::unique_ptr<Layout>>&,
+                    GlyphDependencies&,
+                    ImageDependencies&);
+
+    struct ParallelGroup;
+    void parseInParallel(std::vector<ParallelGroup>&);
     void finalizeLayout();
+    void cancelParse(std::chrono::duration<double> start);
+    // Counts the current parse as abandoned, once per correlation ID.
+    void countAbandonedParse();
     
     void coalesce();
 
@@ -74,9 +93,18 @@ private:
     const OverscaledTileID id;
     const std::string sourceID;
     const std::atomic<bool>& obsolete;
+    const std::atomic<TaskPriority>& priority;
     const MapMode mode;
     const float pixelRatio;
-    
+    const std::shared_ptr<TileParseCounters> parseCounters;
+    // Whether independent layer groups may be parsed concurrently on the background scheduler.
+    const bool parallelParsing;
+
+    // Time spent on the current parse so far, across parse() and finalizeLayout().
+    std::chrono::duration<double> parseTime{0};
+    // Correlation ID of the last parse counted as abandoned.
+    std::optional<uint64_t> abandonedCorrelationID;
+
     std::unique_ptr<FeatureIndex> featureIndex;
     std::unordered_map<std::string, LayerRenderData> renderData;
 
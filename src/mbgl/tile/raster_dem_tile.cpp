@@ -122,8 +122,16 @@ void RasterDEMTile::setNecessity(TileNecessity necessity) {
     loader.setNecessity(necessity);
 }
 
+void RasterDEMTile::setPriority(TaskPriority priority) {
+    worker.setPriority(priority);
+}
+
 void RasterDEMTile::setUpdateParameters(const TileUpdateParameters& params) {
     loader.setUpdateParameters(params);
 }
 
+void RasterDEMTile::setRank(double rank) {
+    loader.setRank(rank);
+}
+
 } // namespace mbgl
@@ -78,8 +78,16 @@ void RasterTile::setNecessity(TileNecessity necessity) {
     loader.setNecessity(necessity);
 }
 
+void RasterTile::setPriority(TaskPriority priority) {
+    worker.setPriority(priority);
+}
+
 void RasterTile::setUpdateParameters(const TileUpdateParameters& params) {
     loader.setUpdateParameters(params);
 }
 
+void RasterTile::setRank(double rank) {
+    loader.setRank(rank);
+}
+
 } // namespace mbgl
@@ -24,7 +24,9 @@ public:
 
     std::unique_ptr<TileRenderData> createRenderData() override;
     void setNecessity(TileNecessity) override;
+    void setPriority(TaskPriority) override;
     void setUpdateParameters(const TileUpdateParameters&) override;
+    void setRank(double) override;
 
     void setError(std::exception_ptr);
     void setMetadata(std::optional<Timestamp> modified, std::optional<Timestamp> expires);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mbgl/actor/scheduler.hpp>
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/util/feature.hpp>
@@ -65,8 +66,15 @@ public:
 
     virtual void setNecessity(TileNecessity) {}
 
+    // Sets the priority of the tile's background work (e.g. parsing) relative to other tiles.
+    virtual void setPriority(TaskPriority) {}
+
     virtual void setUpdateParameters(const TileUpdateParameters&) {}
 
+    // Sets the rank of the tile's pending network request relative to other tiles: tiles closer
+    // to the center of the viewport get lower ranks and are requested first.
+    virtual void setRank(double) {}
+
     // Mark this tile as no longer needed and cancel any pending work.
     virtual void cancel();
 
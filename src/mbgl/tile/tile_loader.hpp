@@ -24,6 +24,7 @@ public:
 
     void setNecessity(TileNecessity newNecessity);
     void setUpdateParameters(const TileUpdateParameters&);
+    void setRank(double);
 
 private:
     // called when the tile is one of the ideal tiles that we want to show definitely. the tile source
@@ -7,6 +7,7 @@
 #include <mbgl/util/tileset.hpp>
 
 #include <cassert>
+#include <cmath>
 
 namespace mbgl {
 
@@ -68,6 +69,18 @@ void TileLoader<T>::setNecessity(TileNecessity newNecessity) {
     }
 }
 
+template <typename T>
+void TileLoader<T>::setRank(double rank) {
+    // Small changes hardly reorder the queue and aren't worth a message to the file source.
+    if (std::abs(rank - resource.rank) < 0.5) {
+        return;
+    }
+    resource.setRank(rank);
+    if (request) {
+        request->setRank(rank);
+    }
+}
+
 template <typename T>
 void TileLoader<T>::setUpdateParameters(const TileUpdateParameters& params) {
     if (updateParameters != params) {
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <mbgl/renderer/renderer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mbgl {
+
+// Collects statistics about the tile parses performed by the tile workers of
+// one renderer. Updated concurrently from the worker threads.
+class TileParseCounters {
+public:
+    void parseStarted() { ++started; }
+
+    void parseCancelled(std::chrono::duration<double> wasted) {
+        ++cancelled;
+        wastedWallNanoseconds += static_cast<uint64_t>(std::chrono::duration<double, std::nano>(wasted).count());
+    }
+
+    TileParseStatistics getStatistics() const {
+        TileParseStatistics statistics;
+        statistics.parsesStarted = started;
+        statistics.parsesCancelled = cancelled;
+        statistics.wastedParseWallTime = static_cast<double>(wastedWallNanoseconds) / 1e6;
+        return statistics;
+    }
+
+private:
+    std::atomic<uint64_t> started{0};
+    std::atomic<uint64_t> cancelled{0};
+    std::atomic<uint64_t> wastedWallNanoseconds{0};
+};
+
+} // namespace mbgl
@@ -17,6 +17,7 @@ public:
 
     void setNecessity(TileNecessity) final;
     void setUpdateParameters(const TileUpdateParameters&) final;
+    void setRank(double) final;
     void setMetadata(std::optional<Timestamp> modified, std::optional<Timestamp> expires);
     void setData(const std::shared_ptr<const std::string>& data);
 
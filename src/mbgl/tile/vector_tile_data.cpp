@@ -70,6 +70,35 @@ std::unique_ptr<GeometryTileFeature> VectorTileLayer::getFeature(std::size_t i)
     return std::make_unique<VectorTileFeature>(layer, layer.getFeature(i));
 }
 
+namespace {
+
+// Constructs each feature in place, so that moving the cursor only decodes the feature header.
+class VectorTileFeatureCursor final : public GeometryTileFeatureCursor {
+public:
+    explicit VectorTileFeatureCursor(const mapbox::vector_tile::layer& layer_) : layer(layer_) {}
+
+    const GeometryTileFeature& seek(std::size_t i) override {
+        feature.reset();
+        return feature.emplace(layer, layer.getFeature(i));
+    }
+
+    std::unique_ptr<GeometryTileFeature> take() override {
+        auto result = std::make_unique<VectorTileFeature>(std::move(*feature));
+        feature.reset();
+        return result;
+    }
+
+private:
+    const mapbox::vector_tile::layer& layer;
+    std::optional<VectorTileFeature> feature;
+};
+
+} // namespace
+
+std::unique_ptr<GeometryTileFeatureCursor> VectorTileLayer::makeCursor() const {
+    return std::make_unique<VectorTileFeatureCursor>(layer);
+}
+
 std::string VectorTileLayer::getName() const {
     return layer.getName();
 }
@@ -42,6 +42,7 @@ public:
 
     std::size_t featureCount() const override;
     std::unique_ptr<GeometryTileFeature> getFeature(std::size_t i) const override;
+    std::unique_ptr<GeometryTileFeatureCursor> makeCursor() const override;
     std::string getName() const override;
 
 private:
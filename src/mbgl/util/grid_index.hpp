@@ -72,6 +72,9 @@ public:
     
     bool empty() const;
 
+    // Returns the inserted box elements, in insertion order.
+    const std::vector<std::pair<T, BBox>>& getBoxElements() const { return boxElements; }
+
 private:
     bool noIntersection(const BBox& queryBBox) const;
     bool completeIntersection(const BBox& queryBBox) const;
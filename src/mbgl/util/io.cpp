@@ -4,7 +4,6 @@
 #include <cerrno>
 #include <cstring>
 #include <iostream>
-#include <sstream>
 #include <fstream>
 
 #ifdef __GNUC__
@@ -16,6 +15,30 @@
 namespace mbgl {
 namespace util {
 
+namespace {
+
+// Reads the rest of the file into a string that is sized up front, so that large files aren't
+// copied out of a growing stream buffer once they have been read.
+std::string readStream(std::ifstream& file) {
+    std::string data;
+    if (file.seekg(0, std::ios::end)) {
+        const std::streamoff size = file.tellg();
+        if (size > 0) {
+            data.reserve(static_cast<std::size_t>(size));
+        }
+        file.seekg(0, std::ios::beg);
+    }
+    file.clear();
+
+    char buffer[64 * 1024];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        data.append(buffer, static_cast<std::size_t>(file.gcount()));
+    }
+    return data;
+}
+
+} // namespace
+
 IOException::IOException(int err, const std::string& msg)
     : std::runtime_error(msg + ": " + std::strerror(errno)), code(err) {
 }
@@ -33,9 +56,7 @@ void write_file(const std::string &filename, const std::string &data) {
 std::string read_file(const std::string &filename) {
     std::ifstream file(filename, std::ios::binary);
     if (file.good()) {
-        std::stringstream data;
-        data << file.rdbuf();
-        return data.str();
+        return readStream(file);
     } else {
         throw std::runtime_error(std::string("Cannot read file ") + filename);
     }
@@ -44,9 +65,7 @@ std::string read_file(const std::string &filename) {
 std::optional<std::string> readFile(const std::string &filename) {
     std::ifstream file(filename, std::ios::binary);
     if (file.good()) {
-        std::stringstream data;
-        data << file.rdbuf();
-        return data.str();
+        return readStream(file);
     }
     return {};
 }
@@ -5,8 +5,17 @@
 #include <mbgl/util/platform.hpp>
 #include <mbgl/util/string.hpp>
 
+#include <algorithm>
+
 namespace mbgl {
 
+ThreadedSchedulerBase::ThreadedSchedulerBase(std::size_t threadCount) {
+    queues.reserve(threadCount);
+    for (std::size_t i = 0u; i < threadCount; ++i) {
+        queues.emplace_back(std::make_unique<WorkQueue>());
+    }
+}
+
 ThreadedSchedulerBase::~ThreadedSchedulerBase() = default;
 
 void ThreadedSchedulerBase::terminate() {
@@ -17,6 +26,84 @@ void ThreadedSchedulerBase::terminate() {
     cv.notify_all();
 }
 
+std::function<void()> ThreadedSchedulerBase::next(std::size_t index, bool leastUrgentFirst) {
+    for (std::size_t i = 0u; i < kPriorityCount; ++i) {
+        const std::size_t lane = leastUrgentFirst ? kPriorityCount - 1 - i : i;
+        if (pending[lane] == 0) {
+            continue;
+        }
+
+        auto function = pop(index, lane);
+        if (!function) {
+            function = steal(index, lane);
+        }
+
+        if (function) {
+            return function;
+        }
+    }
+
+    return {};
+}
+
+std::function<void()> ThreadedSchedulerBase::pop(std::size_t index, std::size_t lane) {
+    auto& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    auto& tasks = queue.tasks[lane];
+    if (tasks.empty()) {
+        return {};
+    }
+
+    auto function = std::move(tasks.front());
+    tasks.pop_front();
+    --pending[lane];
+    return function;
+}
+
+std::function<void()> ThreadedSchedulerBase::steal(std::size_t index, std::size_t lane) {
+    // Skip the queues that are busy at first. If none of the others had a task, wait for the
+    // busy ones rather than returning to the loop, which would spin against them while the
+    // pending counter says there is work.
+    bool contended = false;
+    for (bool blocking : {false, true}) {
+        for (std::size_t i = 1u; i < queues.size(); ++i) {
+            auto& queue = *queues[(index + i) % queues.size()];
+            std::unique_lock<std::mutex> lock(queue.mutex, std::defer_lock);
+            if (blocking) {
+                lock.lock();
+            } else if (!lock.try_lock()) {
+                contended = true;
+                continue;
+            }
+
+            auto& tasks = queue.tasks[lane];
+            if (tasks.empty()) {
+                continue;
+            }
+
+            auto function = std::move(tasks.back());
+            tasks.pop_back();
+            --pending[lane];
+            return function;
+        }
+
+        if (!contended) {
+            break;
+        }
+    }
+
+    return {};
+}
+
+bool ThreadedSchedulerBase::hasPending() const {
+    for (const auto& count : pending) {
+        if (count > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 std::thread ThreadedSchedulerBase::makeSchedulerThread(size_t index) {
     return std::thread([this, index] {
         auto& settings = platform::Settings::getInstance();
@@ -27,33 +114,66 @@ std::thread ThreadedSchedulerBase::makeSchedulerThread(size_t index) {
 
         platform::setCurrentThreadName(std::string{"Worker "} + util::toString(index + 1));
         platform::attachThread();
+        currentQueue.set(queues[index].get());
 
-        while (true) {
-            std::unique_lock<std::mutex> lock(mutex);
-
-            cv.wait(lock, [this] { return !queue.empty() || terminated; });
-
-            if (terminated) {
-                platform::detachThread();
-                return;
+        std::size_t taken = 0;
+        while (!terminated) {
+            if (auto function = next(index, ++taken % kAgingInterval == 0)) {
+                function();
+                continue;
             }
 
-            auto function = std::move(queue.front());
-            queue.pop();
-            lock.unlock();
-            if (function) function();
+            // Nothing to run. The idle counter is raised while holding the mutex so that
+            // schedule() either observes it and wakes us up, or we observe its task.
+            std::unique_lock<std::mutex> lock(mutex);
+            ++idle;
+            cv.wait(lock, [this] { return hasPending() || terminated; });
+            --idle;
         }
+
+        currentQueue.set(nullptr);
+        platform::detachThread();
     });
 }
 
 void ThreadedSchedulerBase::schedule(std::function<void()> fn) {
+    scheduleWithPriority(TaskPriority::Default, std::move(fn));
+}
+
+void ThreadedSchedulerBase::scheduleWithPriority(TaskPriority priority, std::function<void()> fn) {
     assert(fn);
+    const auto lane = static_cast<std::size_t>(priority);
+    assert(lane < kPriorityCount);
+
+    // Keep work scheduled by a worker (e.g. a mailbox rescheduling itself) local to that
+    // worker; spread work coming from other threads across all queues.
+    WorkQueue* queue = currentQueue.get();
+    if (!queue) {
+        queue = queues[nextQueue++ % queues.size()].get();
+    }
+
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        queue.push(std::move(fn));
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks[lane].push_back(std::move(fn));
+        ++pending[lane];
+    }
+
+    if (idle > 0) {
+        { std::lock_guard<std::mutex> lock(mutex); }
+        cv.notify_one();
+    }
+}
+
+// static
+std::size_t ThreadPool::getDefaultThreadCount() {
+    auto value = platform::Settings::getInstance().get(platform::EXPERIMENTAL_THREAD_POOL_SIZE);
+    if (auto* size = value.getUint()) {
+        if (*size > 0) {
+            return static_cast<std::size_t>(*size);
+        }
     }
 
-    cv.notify_one();
+    return std::max(1u, std::thread::hardware_concurrency());
 }
 
 } // namespace mbgl
@@ -2,46 +2,91 @@
 
 #include <mbgl/actor/mailbox.hpp>
 #include <mbgl/actor/scheduler.hpp>
+#include <mbgl/util/thread_local.hpp>
 
 #include <array>
+#include <atomic>
+#include <cassert>
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <vector>
 
 namespace mbgl {
 
+/**
+ * @brief ThreadedSchedulerBase implements the task queues shared by the threaded schedulers
+ *
+ * Every worker thread owns a set of double-ended task queues, one per TaskPriority.
+ * Tasks scheduled from a worker thread go to that worker's own queues; tasks scheduled
+ * from any other thread are distributed round-robin. A worker looks for the most urgent
+ * pending task: it takes from the front of its own queue of a given priority and, if that
+ * is empty, steals from the back of its siblings' queues of the same priority before
+ * moving on to the next priority or going to sleep. Every kAgingInterval-th task a worker
+ * runs is looked for in the reverse order, so that Low tasks still make progress while
+ * more urgent ones keep arriving.
+ */
 class ThreadedSchedulerBase : public Scheduler {
 public:
     void schedule(std::function<void()>) override;
+    void scheduleWithPriority(TaskPriority, std::function<void()>) override;
+
+    /// Returns the number of worker threads serving this scheduler.
+    std::size_t getThreadCount() const { return queues.size(); }
 
 protected:
-    ThreadedSchedulerBase() = default;
+    explicit ThreadedSchedulerBase(std::size_t threadCount);
     ~ThreadedSchedulerBase() override;
 
     void terminate();
     std::thread makeSchedulerThread(size_t index);
 
-    std::queue<std::function<void()>> queue;
+private:
+    static constexpr std::size_t kPriorityCount = 3;
+    static constexpr std::size_t kAgingInterval = 16;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::array<std::deque<std::function<void()>>, kPriorityCount> tasks;
+    };
+
+    std::function<void()> next(std::size_t index, bool leastUrgentFirst);
+    std::function<void()> pop(std::size_t index, std::size_t lane);
+    std::function<void()> steal(std::size_t index, std::size_t lane);
+    bool hasPending() const;
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    util::ThreadLocal<WorkQueue> currentQueue;
+    std::atomic<std::size_t> nextQueue{0};
+
+    // Number of tasks of each priority sitting in any of the queues and number of workers
+    // waiting for one. They are only used to skip empty lanes, to decide when to sleep and
+    // when to wake up.
+    std::array<std::atomic<std::size_t>, kPriorityCount> pending{};
+    std::atomic<std::size_t> idle{0};
+
     std::mutex mutex;
     std::condition_variable cv;
-    bool terminated{false};
+    std::atomic<bool> terminated{false};
 };
 
 /**
  * @brief ThreadScheduler implements Scheduler interface using a lightweight event loop
  *
- * @tparam N number of threads
+ * The number of threads is fixed at construction time.
  *
- * Note: If N == 1 all scheduled tasks are guaranteed to execute consequently;
- * otherwise, some of the scheduled tasks might be executed in parallel.
+ * Note: If the thread count is 1 all tasks scheduled with the same priority are guaranteed to
+ * execute consequently; otherwise, some of the scheduled tasks might be executed in parallel.
  */
-template <std::size_t N>
 class ThreadedScheduler : public ThreadedSchedulerBase {
 public:
-    ThreadedScheduler() {
-        for (std::size_t i = 0u; i < N; ++i) {
-            threads[i] = makeSchedulerThread(i);
+    explicit ThreadedScheduler(std::size_t threadCount) : ThreadedSchedulerBase(threadCount) {
+        assert(threadCount > 0 && "Thread count must be more than zero.");
+        threads.reserve(threadCount);
+        for (std::size_t i = 0u; i < threadCount; ++i) {
+            threads.emplace_back(makeSchedulerThread(i));
         }
     }
 
@@ -56,16 +101,27 @@ public:
     mapbox::base::WeakPtr<Scheduler> makeWeakPtr() override { return weakFactory.makeWeakPtr(); }
 
 private:
-    std::array<std::thread, N> threads;
+    std::vector<std::thread> threads;
     mapbox::base::WeakPtrFactory<Scheduler> weakFactory{this};
-    static_assert(N > 0, "Thread count must be more than zero.");
 };
 
-class SequencedScheduler : public ThreadedScheduler<1> {};
+class SequencedScheduler : public ThreadedScheduler {
+public:
+    SequencedScheduler() : ThreadedScheduler(1) {}
+};
 
-template <std::size_t extra>
-using ParallelScheduler = ThreadedScheduler<1 + extra>;
+/**
+ * @brief ThreadPool is the shared worker pool returned by Scheduler::GetBackground()
+ *
+ * By default it runs one thread per hardware thread; the size can be overridden with the
+ * platform::EXPERIMENTAL_THREAD_POOL_SIZE setting before the pool is first created.
+ */
+class ThreadPool : public ThreadedScheduler {
+public:
+    ThreadPool() : ThreadedScheduler(getDefaultThreadCount()) {}
+    explicit ThreadPool(std::size_t threadCount) : ThreadedScheduler(threadCount) {}
 
-class ThreadPool : public ParallelScheduler<3> {};
+    static std::size_t getDefaultThreadCount();
+};
 
 } // namespace mbgl
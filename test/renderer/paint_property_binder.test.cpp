@@ -0,0 +1,119 @@
+#include <mbgl/test/util.hpp>
+#include <mbgl/test/stub_geometry_tile_feature.hpp>
+
+#include <mbgl/programs/attributes.hpp>
+#include <mbgl/renderer/paint_property_binder.hpp>
+#include <mbgl/style/conversion/json.hpp>
+#include <mbgl/style/conversion/property_value.hpp>
+#include <mbgl/style/conversion_impl.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace mbgl;
+using namespace std::literals::string_literals;
+
+namespace {
+
+class StubVertexBufferResource : public gfx::VertexBufferResource {};
+
+// Keeps a copy of every vertex buffer uploaded through it.
+class CapturingUploadPass : public gfx::UploadPass {
+public:
+    std::vector<std::vector<uint8_t>> vertexBuffers;
+
+protected:
+    void pushDebugGroup(const char*) override {}
+    void popDebugGroup() override {}
+
+    std::unique_ptr<gfx::VertexBufferResource> createVertexBufferResource(const void* data,
+                                                                          std::size_t size,
+                                                                          gfx::BufferUsageType) override {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        vertexBuffers.emplace_back(bytes, bytes + size);
+        return std::make_unique<StubVertexBufferResource>();
+    }
+    void updateVertexBufferResource(gfx::VertexBufferResource&, const void*, std::size_t) override {}
+    std::unique_ptr<gfx::IndexBufferResource> createIndexBufferResource(const void*,
+                                                                        std::size_t,
+                                                                        gfx::BufferUsageType) override {
+        return nullptr;
+    }
+    void updateIndexBufferResource(gfx::IndexBufferResource&, const void*, std::size_t) override {}
+    std::unique_ptr<gfx::TextureResource> createTextureResource(Size,
+                                                                const void*,
+                                                                gfx::TexturePixelType,
+                                                                gfx::TextureChannelDataType) override {
+        return nullptr;
+    }
+    void updateTextureResource(
+        gfx::TextureResource&, Size, const void*, gfx::TexturePixelType, gfx::TextureChannelDataType) override {}
+    void updateTextureResourceSub(gfx::TextureResource&,
+                                  uint16_t,
+                                  uint16_t,
+                                  Size,
+                                  const void*,
+                                  gfx::TexturePixelType,
+                                  gfx::TextureChannelDataType) override {}
+};
+
+style::PropertyExpression<float> parse(const char* json) {
+    style::conversion::Error error;
+    auto value = style::conversion::convertJSON<style::PropertyValue<float>>(json, error, true, false);
+    EXPECT_TRUE(value && value->isExpression()) << error.message;
+    return value->asExpression();
+}
+
+using Binder = PaintPropertyBinder<float, float, PossiblyEvaluatedPropertyValue<float>, attributes::radius::Type>;
+
+// Populates one binder a feature at a time and another one with the whole batch, and checks
+// that both produce the same vertices.
+void checkBatch(const style::PropertyExpression<float>& expression) {
+    const std::vector<StubGeometryTileFeature> features{
+        StubGeometryTileFeature(PropertyMap{{"size", uint64_t(3)}}),
+        StubGeometryTileFeature(PropertyMap{{"size", -1.5}}),
+        StubGeometryTileFeature(PropertyMap{{"size", 10.0}}),
+        StubGeometryTileFeature(PropertyMap{{"size", "1"s}}),
+        StubGeometryTileFeature(PropertyMap{}),
+    };
+    std::vector<const GeometryTileFeature*> pointers;
+    std::vector<std::size_t> lengths;
+    std::vector<std::size_t> indices;
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        pointers.push_back(&features[i]);
+        lengths.push_back((i + 1) * 4);
+        indices.push_back(i);
+    }
+
+    const CanonicalTileID canonical(0, 0, 0);
+    const PossiblyEvaluatedPropertyValue<float> value(expression);
+    auto single = Binder::create(value, 5.0f, 1.0f);
+    auto batch = Binder::create(value, 5.0f, 1.0f);
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        single->populateVertexVector(features[i], lengths[i], indices[i], {}, {}, canonical, {});
+    }
+    batch->populateVertexVectors(pointers.data(), lengths.data(), indices.data(), pointers.size(), canonical);
+
+    CapturingUploadPass uploadPass;
+    single->upload(uploadPass);
+    batch->upload(uploadPass);
+    ASSERT_EQ(2u, uploadPass.vertexBuffers.size());
+    EXPECT_FALSE(uploadPass.vertexBuffers[0].empty());
+    EXPECT_EQ(uploadPass.vertexBuffers[0], uploadPass.vertexBuffers[1]);
+    EXPECT_EQ(single->statistics.max(), batch->statistics.max());
+}
+
+} // namespace
+
+TEST(PaintPropertyBinder, SourceFunctionBatch) {
+    checkBatch(parse(R"(["get", "size"])"));
+    checkBatch(parse(R"(["interpolate", ["linear"], ["number", ["get", "size"], 0], 0, 2, 5, 12])"));
+    checkBatch(parse(R"(["match", ["get", "size"], 3, 30, [10, 1], 20, -5])"));
+}
+
+TEST(PaintPropertyBinder, CompositeFunctionBatch) {
+    checkBatch(parse(
+        R"(["interpolate", ["linear"], ["zoom"], 0, ["get", "size"], 10, ["*", 2, ["number", ["get", "size"], 1]]])"));
+    checkBatch(parse(R"(["step", ["zoom"], ["get", "size"], 5.5, ["number", ["get", "size"], 0]])"));
+}
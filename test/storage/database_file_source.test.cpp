@@ -1,7 +1,9 @@
+#include <mbgl/storage/database_file_source.hpp>
 #include <mbgl/storage/file_source_manager.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/resource_options.hpp>
 #include <mbgl/test/util.hpp>
+#include <mbgl/util/io.hpp>
 #include <mbgl/util/run_loop.hpp>
 #include <mbgl/util/timer.hpp>
 
@@ -54,4 +56,156 @@ TEST(DatabaseFileSource, VolatileResource) {
         });
     });
     loop.run();
-}
\ No newline at end of file
+}
+TEST(DatabaseFileSource, TEST_REQUIRES_WRITE(FileDatabase)) {
+    util::RunLoop loop;
+
+    const std::string path = "test/fixtures/offline_database/database_file_source.db";
+    util::deleteFile(path);
+    util::deleteFile(path + "-wal");
+    util::deleteFile(path + "-shm");
+
+    std::shared_ptr<FileSource> dbfs =
+        FileSourceManager::get()->getFileSource(FileSourceType::Database, ResourceOptions().withCachePath(path));
+
+    // Puts are written in batches, and reads of a database file are served by the readers.
+    std::vector<Resource> resources;
+    Response response{};
+    for (int i = 0; i < 3; ++i) {
+        resources.emplace_back(
+            Resource::Unknown, "http://127.0.0.1:3000/test/" + std::to_string(i), std::nullopt, Resource::LoadingMethod::CacheOnly);
+        response.data = std::make_shared<std::string>("Cached value " + std::to_string(i));
+        std::function<void()> callback;
+        if (i == 2) {
+            callback = [&] { loop.stop(); };
+        }
+        dbfs->forward(resources.back(), response, std::move(callback));
+    }
+    loop.run();
+
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    std::size_t responses = 0;
+    for (std::size_t i = 0; i < resources.size(); ++i) {
+        requests.push_back(dbfs->request(resources[i], [&, i](const Response& res) {
+            EXPECT_EQ(nullptr, res.error);
+            ASSERT_TRUE(res.data.get());
+            EXPECT_EQ("Cached value " + std::to_string(i), *res.data);
+            if (++responses == resources.size()) {
+                loop.stop();
+            }
+        }));
+    }
+    loop.run();
+}
+
+TEST(DatabaseFileSource, TEST_REQUIRES_WRITE(ResetWhileReading)) {
+    util::RunLoop loop;
+
+    const std::string path = "test/fixtures/offline_database/database_file_source_reset.db";
+    util::deleteFile(path);
+    util::deleteFile(path + "-wal");
+    util::deleteFile(path + "-shm");
+
+    auto dbfs = std::static_pointer_cast<DatabaseFileSource>(
+        FileSourceManager::get()->getFileSource(FileSourceType::Database, ResourceOptions().withCachePath(path)));
+
+    std::vector<Resource> resources;
+    Response response{};
+    for (int i = 0; i < 64; ++i) {
+        resources.emplace_back(
+            Resource::Unknown, "http://127.0.0.1:3000/test/" + std::to_string(i), std::nullopt, Resource::LoadingMethod::CacheOnly);
+        response.data = std::make_shared<std::string>("Cached value " + std::to_string(i));
+        std::function<void()> callback;
+        if (i == 63) {
+            callback = [&] { loop.stop(); };
+        }
+        dbfs->forward(resources.back(), response, std::move(callback));
+    }
+    loop.run();
+
+    // The reads queued on the readers are answered from the old database or not at all, and
+    // the database is only removed once the readers have closed it.
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    std::size_t responses = 0;
+    bool reset = false;
+    for (std::size_t i = 0; i < resources.size(); ++i) {
+        requests.push_back(dbfs->request(resources[i], [&, i](const Response& res) {
+            if (!res.error) {
+                ASSERT_TRUE(res.data.get());
+                EXPECT_EQ("Cached value " + std::to_string(i), *res.data);
+            } else {
+                EXPECT_EQ(Response::Error::Reason::NotFound, res.error->reason);
+            }
+            if (++responses == resources.size() && reset) {
+                loop.stop();
+            }
+        }));
+        if (i == resources.size() / 2) {
+            dbfs->resetDatabase([&](std::exception_ptr error) {
+                EXPECT_EQ(nullptr, error);
+                reset = true;
+                if (responses == resources.size()) {
+                    loop.stop();
+                }
+            });
+        }
+    }
+    loop.run();
+    requests.clear();
+
+    // The readers read the new database.
+    response.data = std::make_shared<std::string>("New value");
+    dbfs->forward(resources[0], response, [&] { loop.stop(); });
+    loop.run();
+
+    responses = 0;
+    requests.push_back(dbfs->request(resources[0], [&](const Response& res) {
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        EXPECT_EQ("New value", *res.data);
+        if (++responses == 2) {
+            loop.stop();
+        }
+    }));
+    requests.push_back(dbfs->request(resources[1], [&](const Response& res) {
+        ASSERT_TRUE(res.error.get());
+        EXPECT_EQ(Response::Error::Reason::NotFound, res.error->reason);
+        if (++responses == 2) {
+            loop.stop();
+        }
+    }));
+    loop.run();
+}
+
+TEST(DatabaseFileSource, TEST_REQUIRES_WRITE(ReadPendingPut)) {
+    util::RunLoop loop;
+
+    const std::string path = "test/fixtures/offline_database/database_file_source_pending.db";
+    util::deleteFile(path);
+    util::deleteFile(path + "-wal");
+    util::deleteFile(path + "-shm");
+
+    std::shared_ptr<FileSource> dbfs =
+        FileSourceManager::get()->getFileSource(FileSourceType::Database, ResourceOptions().withCachePath(path));
+
+    // Open the readers by waiting for a first put to be written.
+    const Resource other{
+        Resource::Unknown, "http://127.0.0.1:3000/other", std::nullopt, Resource::LoadingMethod::CacheOnly};
+    Response response{};
+    response.data = std::make_shared<std::string>("Other value");
+    dbfs->forward(other, response, [&] { loop.stop(); });
+    loop.run();
+
+    // A read right after a put sees it, although the put is still waiting for its batch.
+    const Resource resource{
+        Resource::Unknown, "http://127.0.0.1:3000/test", std::nullopt, Resource::LoadingMethod::CacheOnly};
+    response.data = std::make_shared<std::string>("Cached value");
+    dbfs->forward(resource, response, {});
+    auto req = dbfs->request(resource, [&](const Response& res) {
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        EXPECT_EQ("Cached value", *res.data);
+        loop.stop();
+    });
+    loop.run();
+}
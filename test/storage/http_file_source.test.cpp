@@ -205,3 +205,43 @@ TEST(HTTPFileSource, TEST_REQUIRES_SERVER(Load)) {
 
     loop.run();
 }
+
+#if !defined(__APPLE__) && !defined(__QT__) // Only the curl HTTP file source reports metrics.
+TEST(HTTPFileSource, TEST_REQUIRES_SERVER(Metrics)) {
+    util::RunLoop loop;
+    HTTPFileSource fs(ResourceOptions::Default(), ClientOptions());
+
+    fs.setProperty(HTTP2_MULTIPLEXING_KEY, true);
+    ASSERT_TRUE(*fs.getProperty(HTTP2_MULTIPLEXING_KEY).getBool());
+
+    // Requests one after the other, so that the later ones can reuse the connection. The test
+    // server speaks HTTP/1.1, which the requests fall back to.
+    int remaining = 3;
+    std::unique_ptr<AsyncRequest> req;
+    std::function<void()> next = [&] {
+        req = fs.request({Resource::Unknown, "http://127.0.0.1:3000/test"}, [&](Response res) {
+            EXPECT_EQ(nullptr, res.error);
+            if (--remaining == 0) {
+                loop.stop();
+            } else {
+                next();
+            }
+        });
+    };
+    next();
+
+    loop.run();
+    req.reset();
+
+    const auto metrics = fs.getProperty(HTTP_METRICS_KEY);
+    ASSERT_NE(nullptr, metrics.getObject());
+    const auto& counters = *metrics.getObject();
+    EXPECT_EQ(3u, *counters.at("requests").getUint());
+    EXPECT_EQ(0u, *counters.at("http2-requests").getUint());
+    EXPECT_EQ(3u, *counters.at("connections-opened").getUint() + *counters.at("connections-reused").getUint());
+    EXPECT_LE(1u, *counters.at("connections-opened").getUint());
+    EXPECT_EQ(0u, *counters.at("tls-handshakes").getUint());
+    EXPECT_LT(0u, *counters.at("bytes-sent").getUint());
+    EXPECT_LT(0u, *counters.at("bytes-received").getUint());
+}
+#endif
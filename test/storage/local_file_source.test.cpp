@@ -76,6 +76,25 @@ TEST(LocalFileSource, NonEmptyFile) {
     loop.run();
 }
 
+TEST(LocalFileSource, LargeFile) {
+    util::RunLoop loop;
+
+    LocalFileSource fs(ResourceOptions::Default(), ClientOptions());
+
+    // Larger than a single read, so that the file is assembled from several chunks.
+    const Resource resource{Resource::Unknown, toAbsoluteURL("../mbtiles/geography-class-png.mbtiles")};
+    std::unique_ptr<AsyncRequest> req = fs.request(resource, [&](Response res) {
+        req.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        EXPECT_EQ(490496u, res.data->size());
+        EXPECT_EQ(0u, res.data->find("SQLite format 3"));
+        loop.stop();
+    });
+
+    loop.run();
+}
+
 TEST(LocalFileSource, NonExistentFile) {
     util::RunLoop loop;
 
@@ -9,6 +9,7 @@
 #include <mbgl/util/client_options.hpp>
 #include <mbgl/test/util.hpp>
 #include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/string.hpp>
 #include <mbgl/util/timer.hpp>
 #include <mbgl/util/tile_server_options.hpp>
 
@@ -826,6 +827,75 @@ TEST(MainResourceLoader, TEST_REQUIRES_SERVER(NoDoubleDispatch)) {
     loop.run();
 }
 
+TEST(MainResourceLoader, TEST_REQUIRES_SERVER(CoalesceIdenticalRequests)) {
+    util::RunLoop loop;
+    MainResourceLoader fs(ResourceOptions{}, ClientOptions{});
+
+    // The server answers every request to this URL differently.
+    Resource resource{Resource::Unknown, "http://127.0.0.1:3000/cache"};
+    resource.storagePolicy = Resource::StoragePolicy::Volatile;
+
+    std::vector<std::string> responses;
+    auto onResponse = [&](Response res) {
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data);
+        responses.push_back(*res.data);
+        if (responses.size() == 2) {
+            loop.stop();
+        }
+    };
+
+    std::unique_ptr<AsyncRequest> req1 = fs.request(resource, [&](Response) { FAIL() << "Should never be called"; });
+    std::unique_ptr<AsyncRequest> req2 = fs.request(resource, onResponse);
+    std::unique_ptr<AsyncRequest> req3 = fs.request(resource, onResponse);
+
+    // Cancelling the first request keeps the shared request alive for the others.
+    req1.reset();
+
+    loop.run();
+
+    ASSERT_EQ(2u, responses.size());
+    EXPECT_EQ(responses[0], responses[1]);
+}
+
+TEST(MainResourceLoader, TEST_REQUIRES_SERVER(CoalescedRequestsTakeLowestRank)) {
+    util::RunLoop loop;
+    MainResourceLoader fs(ResourceOptions{}, ClientOptions{});
+
+    std::shared_ptr<FileSource> onlineFs =
+        FileSourceManager::get()->getFileSource(FileSourceType::Network, ResourceOptions{}, ClientOptions{});
+    onlineFs->setProperty(MAX_CONCURRENT_REQUESTS_KEY, 1u);
+
+    std::vector<int> responded;
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    auto request = [&](int number, double rank) {
+        Resource resource{Resource::Unknown,
+                          "http://127.0.0.1:3000/load/" + util::toString(number),
+                          {},
+                          Resource::LoadingMethod::NetworkOnly};
+        resource.setRank(rank);
+        requests.push_back(fs.request(resource, [&, number](Response) {
+            responded.push_back(number);
+            if (responded.size() == 5) {
+                loop.stop();
+            }
+        }));
+    };
+
+    // The first request takes the only connection, and the others wait for it by rank.
+    request(0, 0);
+    request(1, 4);
+    request(2, 3);
+    request(3, 5);
+
+    // An identical request with a lower rank sends the shared request ahead of the others.
+    request(3, 1);
+
+    loop.run();
+
+    EXPECT_EQ((std::vector<int>{0, 3, 3, 2, 1}), responded);
+}
+
 TEST(MainResourceLoader, ResourceOptions) {
     MainResourceLoader fs(
         ResourceOptions().withTileServerOptions(
@@ -1,6 +1,9 @@
 #include <mbgl/storage/mbtiles_file_source.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/resource_options.hpp>
+#include <mbgl/storage/sqlite3.hpp>
+#include <mbgl/test/util.hpp>
+#include <mbgl/util/io.hpp>
 #include <mbgl/util/platform.hpp>
 #include <mbgl/util/run_loop.hpp>
 
@@ -31,6 +34,41 @@ std::string toAbsoluteURL(const std::string &fileName) {
     return url;
 }
 
+// Writes an .mbtiles file without tiles, with the given metadata.
+void writeMBTiles(const std::string &fileName, const std::vector<std::pair<std::string, std::string>> &metadata) {
+    const std::string path = "test/fixtures/storage/mbtiles/" + fileName;
+    mbgl::util::deleteFile(path);
+    mapbox::sqlite::Database db = mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadWriteCreate);
+    db.exec("CREATE TABLE metadata (name TEXT, value TEXT)");
+    db.exec("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)");
+    mapbox::sqlite::Statement insert(db, "INSERT INTO metadata VALUES (?1, ?2)");
+    for (const auto &entry : metadata) {
+        mapbox::sqlite::Query query(insert);
+        query.bind(1, entry.first);
+        query.bind(2, entry.second);
+        query.run();
+    }
+}
+
+// Requests the TileJSON of a file, and returns it or the error message.
+std::pair<std::string, std::string> requestTileJSON(mbgl::MBTilesFileSource &mbtiles, const std::string &fileName) {
+    mbgl::util::RunLoop loop;
+    std::pair<std::string, std::string> result;
+    std::unique_ptr<mbgl::AsyncRequest> req = mbtiles.request(
+        {mbgl::Resource::Unknown, toAbsoluteURL(fileName)}, [&](mbgl::Response res) {
+            req.reset();
+            if (res.data) {
+                result.first = *res.data;
+            }
+            if (res.error) {
+                result.second = res.error->message;
+            }
+            loop.stop();
+        });
+    loop.run();
+    return result;
+}
+
 } // namespace
 
 using namespace mbgl;
@@ -140,3 +178,56 @@ TEST(MBTilesFileSource, NonExistentTile) {
 }
 
 
+
+// Bursts of tile requests are spread over the readers, which reuse their connections
+TEST(MBTilesFileSource, TileBurst) {
+    util::RunLoop loop;
+
+    MBTilesFileSource mbtiles(ResourceOptions::Default(), ClientOptions());
+
+    std::size_t pending = 0;
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    for (int32_t x = 0; x < 2; ++x) {
+        for (int32_t y = 0; y < 2; ++y) {
+            ++pending;
+            requests.push_back(mbtiles.request(
+                Resource::tile(toAbsoluteURL("geography-class-png.mbtiles?file={z}/{x}/{y}.png"), 1.0, x, y, 1, Tileset::Scheme::XYZ),
+                [&](Response res) {
+                    EXPECT_EQ(nullptr, res.error);
+                    EXPECT_TRUE(res.data.get());
+                    EXPECT_EQ(res.noContent, false);
+                    if (--pending == 0) {
+                        loop.stop();
+                    }
+                }));
+        }
+    }
+
+    loop.run();
+}
+
+// The connection to a file is reopened once the file changes, and malformed metadata is
+// reported as an error.
+TEST(MBTilesFileSource, TEST_REQUIRES_WRITE(ChangedFile)) {
+    MBTilesFileSource mbtiles(ResourceOptions::Default(), ClientOptions());
+
+    writeMBTiles("changed.mbtiles", {{"name", "first"}, {"minzoom", "0"}, {"maxzoom", "1"}});
+    auto result = requestTileJSON(mbtiles, "changed.mbtiles");
+    EXPECT_EQ("", result.second);
+    EXPECT_NE(std::string::npos, result.first.find("\"name\":\"first\""));
+
+    // The new file is larger, so it differs in size even if it has the same modification time.
+    writeMBTiles("changed.mbtiles",
+                 {{"name", "second"}, {"minzoom", "0"}, {"maxzoom", "1"}, {"description", std::string(16384, 'x')}});
+    result = requestTileJSON(mbtiles, "changed.mbtiles");
+    EXPECT_EQ("", result.second);
+    EXPECT_NE(std::string::npos, result.first.find("\"name\":\"second\""));
+
+    writeMBTiles("changed.mbtiles",
+                 {{"name", "third"}, {"minzoom", "low"}, {"maxzoom", "1"}, {"description", std::string(32768, 'x')}});
+    result = requestTileJSON(mbtiles, "changed.mbtiles");
+    EXPECT_EQ("", result.first);
+    EXPECT_NE("", result.second);
+
+    util::deleteFile("test/fixtures/storage/mbtiles/changed.mbtiles");
+}
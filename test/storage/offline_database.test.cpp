@@ -5,6 +5,8 @@
 #include <mbgl/storage/offline_database.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
+#include <mbgl/tile/tile_id.hpp>
+#include <mbgl/util/compression.hpp>
 #include <mbgl/util/io.hpp>
 #include <mbgl/util/string.hpp>
 
@@ -32,6 +34,7 @@ static void deleteDatabaseFiles() {
     // Delete leftover journaling files as well.
     util::deleteFile(filename);
     util::deleteFile(filename + "-wal"s);
+    util::deleteFile(filename + "-shm"s);
     util::deleteFile(filename + "-journal"s);
 }
 
@@ -98,6 +101,14 @@ static std::vector<std::string> databaseTableColumns(const std::string& path, co
     return columns;
 }
 
+static int64_t databaseColumnValue(const std::string& path, const char* sql) {
+    mapbox::sqlite::Database db = mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadOnly);
+    mapbox::sqlite::Statement stmt{db, sql};
+    mapbox::sqlite::Query query{stmt};
+    query.run();
+    return query.get<int64_t>(0);
+}
+
 static int databaseAutoVacuum(const std::string& path) {
     mapbox::sqlite::Database db = mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadOnly);
     mapbox::sqlite::Statement stmt{db, "pragma auto_vacuum"};
@@ -154,7 +165,6 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(CreateFail)) {
     // We can also still "query" the database even though it is not open, and we will always get an empty result.
     for (const auto& res : { fixture::resource, fixture::tile }) {
         EXPECT_FALSE(bool(db.get(res)));
-        EXPECT_EQ(1u, log.count(warning(ResultCode::CantOpen, "Can't update timestamp: unable to open database file")));
         EXPECT_EQ(1u, log.count(warning(ResultCode::CantOpen, "Can't read resource: unable to open database file")));
         EXPECT_EQ(0u, log.uncheckedCount());
     }
@@ -171,13 +181,12 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(CreateFail)) {
     }
 
     // Next, set the file system to read only mode and try to read the data again. While we can't
-    // write anymore, we should still be able to read, and the query that tries to update the last
-    // accessed timestamp may fail without crashing.
+    // write anymore, we should still be able to read, since the accessed timestamps are only
+    // written in batches.
     fs.allowFileCreate(false);
     fs.setWriteLimit(0);
     for (const auto& res : { fixture::resource, fixture::tile }) {
         auto result = db.get(res);
-        EXPECT_EQ(1u, log.count(warning(ResultCode::CantOpen, "Can't update timestamp: unable to open database file")));
         EXPECT_EQ(0u, log.uncheckedCount());
 
         ASSERT_TRUE(result && result->data);
@@ -186,13 +195,11 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(CreateFail)) {
     fs.setDebug(false);
 
     // We're allowing SQLite to create a journal file, but restrict the number of bytes it
-    // can write so that it can start writing the journal file, but eventually fails during the
-    // timestamp update.
+    // can write. Reading doesn't write anything.
     fs.allowFileCreate(true);
     fs.setWriteLimit(8192);
     for (const auto& res : { fixture::resource, fixture::tile }) {
         auto result = db.get(res);
-        EXPECT_EQ(1u, log.count(warning(ResultCode::Full, "Can't update timestamp: database or disk is full")));
         EXPECT_EQ(0u, log.uncheckedCount());
         ASSERT_TRUE(result && result->data);
         EXPECT_EQ("first", *result->data);
@@ -205,7 +212,6 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(CreateFail)) {
     for (const auto& res : { fixture::resource, fixture::tile }) {
         // First, try reading.
         auto result = db.get(res);
-        EXPECT_EQ(1u, log.count(warning(ResultCode::Auth, "Can't update timestamp: authorization denied")));
         EXPECT_EQ(1u, log.count(warning(ResultCode::Auth, "Can't read resource: authorization denied")));
         EXPECT_EQ(0u, log.uncheckedCount());
         EXPECT_FALSE(result);
@@ -235,7 +241,7 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(SchemaVersion)) {
         OfflineDatabase db(filename, fixture::tileServerOptions);
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(9, databaseUserVersion(filename));
 
     OfflineDatabase db(filename, fixture::tileServerOptions);
     // Now try inserting and reading back to make sure we have a valid database.
@@ -395,6 +401,53 @@ TEST(OfflineDatabase, PutTile) {
     EXPECT_EQ(0u, log.uncheckedCount());
 }
 
+TEST(OfflineDatabase, GetTiles) {
+    FixtureLog log;
+    OfflineDatabase db(":memory:", fixture::tileServerOptions);
+
+    // A 3x3 block at zoom 4 with a hole, a tile at zoom 2, and a tile from another tileset.
+    const auto put = [&](const std::string& urlTemplate, int32_t x, int32_t y, int8_t z) {
+        Resource resource = Resource::tile(urlTemplate, 1, x, y, z, Tileset::Scheme::XYZ);
+        Response response;
+        response.data = std::make_shared<std::string>(urlTemplate + util::toString(z) + "/" + util::toString(x) + "/" +
+                                                      util::toString(y));
+        db.put(resource, response);
+    };
+    for (int32_t x = 5; x < 8; ++x) {
+        for (int32_t y = 2; y < 5; ++y) {
+            if (x != 6 || y != 3) {
+                put("http://example.com/{z}/{x}/{y}", x, y, 4);
+            }
+        }
+    }
+    put("http://example.com/{z}/{x}/{y}", 1, 1, 2);
+    put("http://example.org/{z}/{x}/{y}", 5, 2, 4);
+
+    const std::vector<CanonicalTileID> tileIDs = {
+        {4, 5, 2}, {4, 6, 3}, {4, 7, 4}, {2, 1, 1}, {2, 3, 3}, {4, 6, 2}, {4, 5, 2}};
+    const auto responses = db.getTiles("http://example.com/{z}/{x}/{y}", 1, tileIDs);
+    ASSERT_EQ(tileIDs.size(), responses.size());
+
+    for (std::size_t i = 0; i < tileIDs.size(); ++i) {
+        const auto& id = tileIDs[i];
+        if ((id.z == 4 && id.x == 6 && id.y == 3) || (id.z == 2 && id.x == 3)) {
+            EXPECT_FALSE(responses[i]) << i;
+            continue;
+        }
+        ASSERT_TRUE(responses[i]) << i;
+        ASSERT_TRUE(responses[i]->data) << i;
+        EXPECT_EQ("http://example.com/{z}/{x}/{y}" + util::toString(id.z) + "/" + util::toString(id.x) + "/" +
+                      util::toString(id.y),
+                  *responses[i]->data);
+    }
+
+    // Tiles are looked up at the given pixel ratio.
+    const auto otherRatio = db.getTiles("http://example.org/{z}/{x}/{y}", 2, {{4, 5, 2}});
+    ASSERT_EQ(1u, otherRatio.size());
+    EXPECT_FALSE(otherRatio[0]);
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
 TEST(OfflineDatabase, PutResourceNoContent) {
     FixtureLog log;
     OfflineDatabase db(":memory:", fixture::tileServerOptions);
@@ -1062,6 +1115,197 @@ TEST(OfflineDatabase, PutReturnsSize) {
     EXPECT_EQ(0u, log.uncheckedCount());
 }
 
+static int64_t databaseAccessedTimestamp(const std::string& path, const char* table) {
+    mapbox::sqlite::Database db = mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadOnly);
+    const auto sql = std::string("SELECT accessed FROM ") + table;
+    mapbox::sqlite::Statement stmt{db, sql.c_str()};
+    mapbox::sqlite::Query query{stmt};
+    query.run();
+    return query.get<int64_t>(0);
+}
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(BatchedAccessedTimestamps)) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        db.put(fixture::resource, fixture::response);
+        db.put(fixture::tile, fixture::response);
+    }
+
+    {
+        mapbox::sqlite::Database db = mapbox::sqlite::Database::open(filename, mapbox::sqlite::ReadWriteCreate);
+        db.exec("UPDATE resources SET accessed = 0");
+        db.exec("UPDATE tiles SET accessed = 0");
+    }
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        EXPECT_TRUE(bool(db.get(fixture::resource)));
+        EXPECT_TRUE(bool(db.get(fixture::tile)));
+
+        // Reading doesn't write the accessed timestamps right away...
+        EXPECT_EQ(0, databaseAccessedTimestamp(filename, "resources"));
+        EXPECT_EQ(0, databaseAccessedTimestamp(filename, "tiles"));
+    }
+
+    // ...but they are written when the database is closed.
+    EXPECT_LT(0, databaseAccessedTimestamp(filename, "resources"));
+    EXPECT_LT(0, databaseAccessedTimestamp(filename, "tiles"));
+
+    EXPECT_EQ("wal", databaseJournalMode(filename));
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(MarkAccessed)) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        db.put(fixture::resource, fixture::response);
+        db.put(fixture::tile, fixture::response);
+    }
+
+    {
+        mapbox::sqlite::Database db = mapbox::sqlite::Database::open(filename, mapbox::sqlite::ReadWriteCreate);
+        db.exec("UPDATE resources SET accessed = 0");
+        db.exec("UPDATE tiles SET accessed = 0");
+    }
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        db.markAccessed(fixture::resource);
+        db.markAccessed(fixture::tile);
+        db.markAccessed(Resource::style("http://example.com/missing.json"));
+    }
+
+    EXPECT_LT(0, databaseAccessedTimestamp(filename, "resources"));
+    EXPECT_LT(0, databaseAccessedTimestamp(filename, "tiles"));
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, CompressesTilesWithDictionary) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    const std::string data = util::read_file("test/fixtures/resources/source_vector.json");
+    const std::string vectorTile = util::read_file("test/fixtures/offline_download/0-0-0.vector.pbf");
+    const Resource style = Resource::style("http://example.com/style.json");
+    const Resource tile = Resource::tile("http://example.com/{z}-{x}-{y}.vector.pbf", 1, 0, 0, 0, Tileset::Scheme::XYZ);
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        Response response;
+        response.data = std::make_shared<std::string>(vectorTile);
+        EXPECT_GT(vectorTile.size(), db.put(tile, response).second);
+        response.data = std::make_shared<std::string>(data);
+        db.put(style, response);
+    }
+
+    EXPECT_EQ(static_cast<int64_t>(OfflineDatabase::Codec::ZlibTileDictionaryV1),
+              databaseColumnValue(filename, "SELECT compressed FROM tile_data"));
+    EXPECT_EQ(static_cast<int64_t>(OfflineDatabase::Codec::Zlib),
+              databaseColumnValue(filename, "SELECT compressed FROM resources"));
+
+    {
+        // Rows written by older versions of the database stay readable.
+        mapbox::sqlite::Database db = mapbox::sqlite::Database::open(filename, mapbox::sqlite::ReadWrite);
+        mapbox::sqlite::Statement stmt{db, "UPDATE tiles SET data = ?1, compressed = 1, data_id = NULL"};
+        mapbox::sqlite::Query query{stmt};
+        const std::string compressed = util::compress(vectorTile);
+        query.bindBlob(1, compressed.data(), compressed.size());
+        query.run();
+    }
+
+    OfflineDatabase db(filename, fixture::tileServerOptions);
+    EXPECT_EQ(vectorTile, *db.get(tile)->data);
+    EXPECT_EQ(data, *db.get(style)->data);
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, SharesIdenticalTileData) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    const std::string vectorTile = util::read_file("test/fixtures/offline_download/0-0-0.vector.pbf");
+    const std::string urlTemplate = "http://example.com/{z}-{x}-{y}.vector.pbf";
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        Response response;
+        response.data = std::make_shared<std::string>(vectorTile);
+        for (int32_t x = 0; x < 3; ++x) {
+            db.put(Resource::tile(urlTemplate, 1, x, 0, 2, Tileset::Scheme::XYZ), response);
+        }
+    }
+
+    EXPECT_EQ(1, databaseColumnValue(filename, "SELECT COUNT(*) FROM tile_data"));
+    EXPECT_EQ(3, databaseColumnValue(filename, "SELECT refcount FROM tile_data"));
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        for (int32_t x = 0; x < 3; ++x) {
+            EXPECT_EQ(vectorTile, *db.get(Resource::tile(urlTemplate, 1, x, 0, 2, Tileset::Scheme::XYZ))->data);
+        }
+
+        Response response;
+        response.data = std::make_shared<std::string>("other");
+        db.put(Resource::tile(urlTemplate, 1, 0, 0, 2, Tileset::Scheme::XYZ), response);
+        EXPECT_EQ("other", *db.get(Resource::tile(urlTemplate, 1, 0, 0, 2, Tileset::Scheme::XYZ))->data);
+    }
+
+    EXPECT_EQ(2, databaseColumnValue(filename, "SELECT COUNT(*) FROM tile_data"));
+    EXPECT_EQ(2, databaseColumnValue(filename, "SELECT MAX(refcount) FROM tile_data"));
+
+    {
+        // Deleting the last tiles using a row deletes the row.
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        EXPECT_EQ(nullptr, db.clearAmbientCache());
+    }
+
+    EXPECT_EQ(0, databaseColumnValue(filename, "SELECT COUNT(*) FROM tile_data"));
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(TileDataSharedWithRegionIsNotAmbient)) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    const std::string urlTemplate = "http://example.com/{z}-{x}-{y}.vector.pbf";
+    const Resource regionTile = Resource::tile(urlTemplate, 1, 0, 0, 1, Tileset::Scheme::XYZ);
+    const Resource ambientTile = Resource::tile(urlTemplate, 1, 1, 0, 1, Tileset::Scheme::XYZ);
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        OfflineTilePyramidRegionDefinition definition(
+            "http://example.com/style.json", LatLngBounds::world(), 0.0, 0.0, 1.0, false);
+        auto region = db.createRegion(definition, OfflineRegionMetadata());
+        ASSERT_TRUE(region);
+
+        Response response;
+        response.data = randomString(100 * 1024);
+        db.putRegionResource(region->getID(), regionTile, response);
+        db.put(ambientTile, response);
+    }
+
+    EXPECT_EQ(1, databaseColumnValue(filename, "SELECT COUNT(*) FROM tile_data"));
+
+    {
+        // The ambient cache size is computed when the database is opened again. The shared
+        // contents belong to the region, so the ambient tile fits into a cache smaller than them.
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        EXPECT_EQ(nullptr, db.setMaximumAmbientCacheSize(50 * 1024));
+        EXPECT_TRUE(bool(db.get(ambientTile)));
+        EXPECT_TRUE(bool(db.get(regionTile)));
+    }
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
 TEST(OfflineDatabase, PutEvictsLeastRecentlyUsedResources) {
     FixtureLog log;
     OfflineDatabase db(":memory:", fixture::tileServerOptions);
@@ -1143,6 +1387,73 @@ TEST(OfflineDatabase, PutRegionResourceDoesNotEvict) {
     EXPECT_EQ(0u, log.uncheckedCount());
 }
 
+TEST(OfflineDatabase, DeleteRegionMakesResourcesEvictable) {
+    FixtureLog log;
+    OfflineDatabase db(":memory:", fixture::tileServerOptions);
+    db.setMaximumAmbientCacheSize(1024 * 100);
+
+    OfflineTilePyramidRegionDefinition definition{"", LatLngBounds::world(), 0, INFINITY, 1.0, true};
+    auto region = db.createRegion(definition, OfflineRegionMetadata());
+    ASSERT_TRUE(region);
+
+    Response response;
+    response.data = randomString(1024);
+
+    for (uint32_t i = 1; i <= 200; i++) {
+        db.putRegionResource(region->getID(), Resource::style("http://example.com/"s + util::toString(i)), response);
+    }
+
+    // The resources of the region are now part of the ambient cache, which is over its size.
+    EXPECT_EQ(nullptr, db.deleteRegion(std::move(*region)));
+    EXPECT_FALSE(bool(db.get(Resource::style("http://example.com/1"))));
+
+    EXPECT_FALSE(db.isEvictionPending());
+    EXPECT_FALSE(db.evictAmbientCache(Milliseconds(10)));
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(DeferredEviction)) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    OfflineDatabase db(filename, fixture::tileServerOptions);
+    db.setMaximumAmbientCacheSize(1024 * 100);
+
+    Response small;
+    small.data = randomString(512);
+    for (uint32_t i = 1; i <= 160; i++) {
+        db.put(Resource::style("http://example.com/"s + util::toString(i)), small);
+    }
+
+    {
+        // Eviction deletes the entries accessed up to a round's last timestamp, so give each
+        // entry a timestamp of its own for the rounds to be as small as they can be.
+        mapbox::sqlite::Database other = mapbox::sqlite::Database::open(filename, mapbox::sqlite::ReadWriteCreate);
+        other.exec("UPDATE resources SET accessed = id");
+    }
+
+    // The insert stops evicting after a single round, which isn't enough room.
+    db.setInsertEvictionBudget(Duration::zero());
+    Response big;
+    big.data = randomString(1024 * 60);
+    EXPECT_TRUE(db.put(Resource::style("http://example.com/big"), big).first);
+    EXPECT_TRUE(db.isEvictionPending());
+    EXPECT_GT(databaseColumnValue(filename, "SELECT SUM(LENGTH(data)) FROM resources"), 1024 * 100);
+
+    // The rest is evicted by later calls, as the database thread does on a timer.
+    for (int i = 0; i < 100 && db.evictAmbientCache(Milliseconds(10)); ++i) {
+    }
+    EXPECT_FALSE(db.isEvictionPending());
+    EXPECT_LE(databaseColumnValue(filename, "SELECT SUM(LENGTH(data)) FROM resources"), 1024 * 100);
+
+    EXPECT_TRUE(bool(db.get(Resource::style("http://example.com/big"))));
+    EXPECT_TRUE(bool(db.get(Resource::style("http://example.com/160"))));
+    EXPECT_FALSE(bool(db.get(Resource::style("http://example.com/1"))));
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
 TEST(OfflineDatabase, PutFailsWhenEvictionInsuffices) {
     FixtureLog log;
     OfflineDatabase db(":memory:", fixture::tileServerOptions);
@@ -1403,7 +1714,7 @@ TEST(OfflineDatabase, MigrateFromV2Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(9, databaseUserVersion(filename));
     EXPECT_LT(databasePageCount(filename),
               databasePageCount("test/fixtures/offline_database/v2.db"));
 
@@ -1426,7 +1737,7 @@ TEST(OfflineDatabase, MigrateFromV3Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(9, databaseUserVersion(filename));
 
     EXPECT_EQ(0u, log.uncheckedCount());
 }
@@ -1447,10 +1758,10 @@ TEST(OfflineDatabase, MigrateFromV4Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(9, databaseUserVersion(filename));
 
-    // Journal mode should be DELETE after migration to v5.
-    EXPECT_EQ("delete", databaseJournalMode(filename));
+    // Journal mode is switched to WAL whenever the database is opened for writing.
+    EXPECT_EQ("wal", databaseJournalMode(filename));
 
     // Synchronous setting should be FULL (2) after migration to v5.
     EXPECT_EQ(2, databaseSyncMode(filename));
@@ -1475,7 +1786,7 @@ TEST(OfflineDatabase, MigrateFromV5Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(9, databaseUserVersion(filename));
 
     EXPECT_EQ((std::vector<std::string>{"id",
                                         "url_template",
@@ -1489,12 +1800,22 @@ TEST(OfflineDatabase, MigrateFromV5Schema) {
                                         "data",
                                         "compressed",
                                         "accessed",
-                                        "must_revalidate"}),
+                                        "must_revalidate",
+                                        "ambient",
+                                        "data_id"}),
               databaseTableColumns(filename, "tiles"));
-    EXPECT_EQ(
-        (std::vector<std::string>{
-            "id", "url", "kind", "expires", "modified", "etag", "data", "compressed", "accessed", "must_revalidate"}),
-        databaseTableColumns(filename, "resources"));
+    EXPECT_EQ((std::vector<std::string>{"id",
+                                        "url",
+                                        "kind",
+                                        "expires",
+                                        "modified",
+                                        "etag",
+                                        "data",
+                                        "compressed",
+                                        "accessed",
+                                        "must_revalidate",
+                                        "ambient"}),
+              databaseTableColumns(filename, "resources"));
 
     EXPECT_EQ(0u, log.uncheckedCount());
 }
@@ -1532,14 +1853,14 @@ TEST(OfflineDatabase, DowngradeSchema) {
         db.setMaximumAmbientCacheSize(0);
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(9, databaseUserVersion(filename));
 
     EXPECT_EQ((std::vector<std::string>{ "id", "url_template", "pixel_ratio", "z", "x", "y",
                                          "expires", "modified", "etag", "data", "compressed",
-                                         "accessed", "must_revalidate" }),
+                                         "accessed", "must_revalidate", "ambient", "data_id" }),
               databaseTableColumns(filename, "tiles"));
     EXPECT_EQ((std::vector<std::string>{ "id", "url", "kind", "expires", "modified", "etag", "data",
-                                         "compressed", "accessed", "must_revalidate" }),
+                                         "compressed", "accessed", "must_revalidate", "ambient" }),
               databaseTableColumns(filename, "resources"));
 
     EXPECT_EQ(1u, log.count({ EventSeverity::Warning, Event::Database, -1, "Removing existing incompatible offline database" }));
@@ -1617,7 +1938,6 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(DisallowedIO)) {
     fs.allowIO(false);
 
     EXPECT_EQ(std::nullopt, db.get(fixture::resource));
-    EXPECT_EQ(1u, log.count(warning(ResultCode::Auth, "Can't update timestamp: authorization denied")));
     EXPECT_EQ(1u, log.count(warning(ResultCode::Auth, "Can't read resource: authorization denied")));
     EXPECT_EQ(0u, log.uncheckedCount());
 
@@ -1638,7 +1958,6 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(DisallowedIO)) {
     EXPECT_EQ(0u, log.uncheckedCount());
 
     EXPECT_EQ(std::nullopt, db.getRegionResource(fixture::resource));
-    EXPECT_EQ(1u, log.count(warning(ResultCode::Auth, "Can't update timestamp: authorization denied")));
     EXPECT_EQ(1u, log.count(warning(ResultCode::Auth, "Can't read region resource: authorization denied")));
     EXPECT_EQ(0u, log.uncheckedCount());
 
@@ -12,8 +12,8 @@
 #include <mbgl/storage/http_file_source.hpp>
 #include <mbgl/util/run_loop.hpp>
 #include <mbgl/util/io.hpp>
-#include <mbgl/util/compression.hpp>
 #include <mbgl/util/string.hpp>
+#include <mbgl/util/timer.hpp>
 
 #include <mbgl/storage/sqlite3.hpp>
 #include <gtest/gtest.h>
@@ -59,12 +59,15 @@ public:
 
 class OfflineTest {
 public:
-    OfflineTest(const std::string& path = ":memory:") : db(path, TileServerOptions::MapTilerConfiguration()) {
-    }
+    OfflineTest(const std::string& path = ":memory:")
+        : db(path, TileServerOptions::MapTilerConfiguration()),
+          scratch(":memory:", TileServerOptions::MapTilerConfiguration()) {}
 
     util::RunLoop loop;
     StubFileSource fileSource;
     OfflineDatabase db;
+    // Measures the stored size of the responses, which depends on how the database encodes them.
+    OfflineDatabase scratch;
     std::size_t size = 0;
 
     auto createRegion() {
@@ -80,9 +83,9 @@ public:
     Response response(const std::string& path) {
         Response result;
         result.data = std::make_shared<std::string>(util::read_file("test/fixtures/offline_download/"s + path));
-        size_t uncompressed = result.data->size();
-        size_t compressed = util::compress(*result.data).size();
-        size += std::min(uncompressed, compressed);
+        const bool tile = path.find(".vector.pbf") != std::string::npos;
+        const Resource resource = tile ? Resource::tile(path, 1, 0, 0, 0, Tileset::Scheme::XYZ) : Resource::style(path);
+        size += scratch.put(resource, result).second;
         return result;
     }
 };
@@ -263,6 +266,8 @@ TEST(OfflineDownload, Activate) {
             EXPECT_EQ(status.completedTileCount, status.requiredTileCount);
             EXPECT_EQ(264u, status.completedResourceCount); // 256 glyphs, 2 sprite images, 2 sprite jsons, 1 tile, 1 style, source, image
             EXPECT_EQ(test.size, status.completedResourceSize);
+            EXPECT_LT(0, status.downloadedTilesPerSecond);
+            EXPECT_LT(0, status.downloadedBytesPerSecond);
 
             download.setState(OfflineRegionDownloadState::Inactive);
             OfflineRegionStatus computedStatus = download.getStatus();
@@ -388,6 +393,60 @@ TEST(OfflineDownload, DoesNotFloodTheFileSourceWithRequests) {
     EXPECT_EQ(*fileSource.getProperty(MAX_CONCURRENT_REQUESTS_KEY).getUint(), fileSource.requests.size());
 }
 
+TEST(OfflineDownload, WritesBufferedResourcesOnDeactivation) {
+    OfflineTest test;
+    FakeOnlineFileSource fileSource;
+    auto region = test.createRegion();
+    ASSERT_TRUE(region);
+    OfflineDownload download(
+        region->getID(),
+        OfflineTilePyramidRegionDefinition("http://127.0.0.1:3000/style.json", LatLngBounds::world(), 0.0, 0.0, 1.0, true),
+        test.db, fileSource);
+
+    download.setObserver(std::make_unique<MockObserver>());
+    download.setState(OfflineRegionDownloadState::Active);
+    test.loop.runOnce();
+
+    // The style is buffered while its sprites, glyphs and sources are still being downloaded.
+    ASSERT_TRUE(fileSource.respond(Resource::Kind::Style, test.response("style.json")));
+    EXPECT_EQ(0u, test.db.getRegionCompletedStatus(region->getID())->completedResourceCount);
+
+    download.setState(OfflineRegionDownloadState::Inactive);
+    EXPECT_EQ(1u, test.db.getRegionCompletedStatus(region->getID())->completedResourceCount);
+}
+
+TEST(OfflineDownload, WritesBufferedResourcesAfterBatchInterval) {
+    OfflineTest test;
+    FakeOnlineFileSource fileSource;
+    auto region = test.createRegion();
+    ASSERT_TRUE(region);
+    OfflineDownload download(
+        region->getID(),
+        OfflineTilePyramidRegionDefinition("http://127.0.0.1:3000/style.json", LatLngBounds::world(), 0.0, 0.0, 1.0, true),
+        test.db, fileSource);
+
+    auto observer = std::make_unique<MockObserver>();
+    observer->statusChangedFn = [&](OfflineRegionStatus status) {
+        if (status.completedResourceCount == 1) {
+            test.loop.stop();
+        }
+    };
+
+    download.setObserver(std::move(observer));
+    download.setState(OfflineRegionDownloadState::Active);
+    test.loop.runOnce();
+
+    // No other response arrives after the style, which is written once the batch interval has passed.
+    ASSERT_TRUE(fileSource.respond(Resource::Kind::Style, test.response("style.json")));
+    EXPECT_EQ(0u, test.db.getRegionCompletedStatus(region->getID())->completedResourceCount);
+
+    util::Timer timeout;
+    timeout.start(Seconds(5), Duration::zero(), [&] { test.loop.stop(); });
+    test.loop.run();
+
+    EXPECT_EQ(1u, test.db.getRegionCompletedStatus(region->getID())->completedResourceCount);
+}
+
 TEST(OfflineDownload, GetStatusNoResources) {
     OfflineTest test;
     auto region = test.createRegion();
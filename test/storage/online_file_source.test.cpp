@@ -11,6 +11,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 using namespace mbgl;
 
 TEST(OnlineFileSource, Cancel) {
@@ -596,6 +598,41 @@ TEST(OnlineFileSource, TEST_REQUIRES_SERVER(LowHighPriorityRequestsMany)) {
     loop.run();
 }
 
+TEST(OnlineFileSource, TEST_REQUIRES_SERVER(RankedRequests)) {
+    util::RunLoop loop;
+    std::unique_ptr<FileSource> fs = std::make_unique<OnlineFileSource>(ResourceOptions::Default(), ClientOptions());
+    std::vector<double> ranks = {4, 1, 3, 2, 5};
+    std::vector<double> responded;
+
+    NetworkStatus::Set(NetworkStatus::Status::Offline);
+    fs->setProperty(MAX_CONCURRENT_REQUESTS_KEY, 1u);
+    fs->pause();
+
+    std::vector<std::unique_ptr<AsyncRequest>> collector;
+    for (std::size_t i = 0; i < ranks.size(); ++i) {
+        Resource resource{Resource::Unknown, "http://127.0.0.1:3000/load/" + util::toString(i)};
+        resource.setRank(ranks[i]);
+        collector.push_back(fs->request(resource, [&, i](Response) {
+            responded.push_back(ranks[i]);
+            if (responded.size() == ranks.size()) {
+                loop.stop();
+            }
+        }));
+    }
+
+    // Moving into the viewport sends the last request ahead of the others.
+    collector.back()->setRank(0);
+    ranks.back() = 0;
+
+    fs->resume();
+    NetworkStatus::Set(NetworkStatus::Status::Online);
+    loop.run();
+
+    // The first request that comes back online is sent right away; the queued ones follow by rank.
+    ASSERT_EQ(ranks.size(), responded.size());
+    EXPECT_TRUE(std::is_sorted(responded.begin() + 1, responded.end()));
+}
+
 TEST(OnlineFileSource, TEST_REQUIRES_SERVER(MaximumConcurrentRequests)) {
     util::RunLoop loop;
     std::unique_ptr<FileSource> fs = std::make_unique<OnlineFileSource>(ResourceOptions::Default(), ClientOptions());
@@ -606,6 +643,108 @@ TEST(OnlineFileSource, TEST_REQUIRES_SERVER(MaximumConcurrentRequests)) {
     ASSERT_EQ(*fs->getProperty(MAX_CONCURRENT_REQUESTS_KEY).getUint(), 10u);
 }
 
+TEST(OnlineFileSource, TEST_REQUIRES_SERVER(MaximumConcurrentRequestsPerHost)) {
+    util::RunLoop loop;
+    std::unique_ptr<FileSource> fs = std::make_unique<OnlineFileSource>(ResourceOptions::Default(), ClientOptions());
+    std::size_t response_counter = 0;
+
+    ASSERT_EQ(*fs->getProperty(MAX_CONCURRENT_REQUESTS_PER_HOST_KEY).getUint(), 0u);
+
+    NetworkStatus::Set(NetworkStatus::Status::Offline);
+    fs->setProperty(MAX_CONCURRENT_REQUESTS_KEY, 2u);
+    fs->setProperty(MAX_CONCURRENT_REQUESTS_PER_HOST_KEY, 1u);
+    ASSERT_EQ(*fs->getProperty(MAX_CONCURRENT_REQUESTS_PER_HOST_KEY).getUint(), 1u);
+    fs->pause();
+
+    // The second request to the first host waits for the first one, and lets the request to
+    // the other host go ahead of it.
+    std::unique_ptr<AsyncRequest> req_0 = fs->request({Resource::Unknown, "http://127.0.0.1:3000/delayed"},
+                                                      [&](Response) {
+                                                          response_counter++;
+                                                          req_0.reset();
+                                                      });
+
+    std::unique_ptr<AsyncRequest> req_1 = fs->request({Resource::Unknown, "http://127.0.0.1:3000/delayed"},
+                                                      [&](Response) {
+                                                          response_counter++;
+                                                          req_1.reset();
+                                                          EXPECT_EQ(3u, response_counter);
+                                                          loop.stop();
+                                                      });
+
+    std::unique_ptr<AsyncRequest> req_2 = fs->request({Resource::Unknown, "http://localhost:3000/test"},
+                                                      [&](Response) {
+                                                          response_counter++;
+                                                          req_2.reset();
+                                                          EXPECT_EQ(1u, response_counter);
+                                                      });
+
+    fs->resume();
+    NetworkStatus::Set(NetworkStatus::Status::Online);
+    loop.run();
+}
+
+TEST(OnlineFileSource, TEST_REQUIRES_SERVER(ManyRequestsToSaturatedHost)) {
+    util::RunLoop loop;
+    std::unique_ptr<FileSource> fs = std::make_unique<OnlineFileSource>(ResourceOptions::Default(), ClientOptions());
+    const std::size_t count = 1000;
+    std::size_t response_counter = 0;
+    std::size_t other_host_response = 0;
+
+    NetworkStatus::Set(NetworkStatus::Status::Offline);
+    fs->setProperty(MAX_CONCURRENT_REQUESTS_KEY, 2u);
+    fs->setProperty(MAX_CONCURRENT_REQUESTS_PER_HOST_KEY, 1u);
+    fs->pause();
+
+    // All but one of the requests queue up behind the first host's limit, and are not looked at
+    // each time a request to the other host could go ahead of them.
+    std::vector<std::unique_ptr<AsyncRequest>> collector;
+    for (std::size_t i = 0; i < count; ++i) {
+        collector.push_back(
+            fs->request({Resource::Unknown, "http://127.0.0.1:3000/load/" + util::toString(i)}, [&](Response) {
+                if (++response_counter == count + 1) {
+                    loop.stop();
+                }
+            }));
+    }
+
+    collector.push_back(fs->request({Resource::Unknown, "http://localhost:3000/test"}, [&](Response) {
+        other_host_response = ++response_counter;
+        if (response_counter == count + 1) {
+            loop.stop();
+        }
+    }));
+
+    fs->resume();
+    NetworkStatus::Set(NetworkStatus::Status::Online);
+    loop.run();
+
+    EXPECT_EQ(count + 1, response_counter);
+    EXPECT_GE(2u, other_host_response);
+}
+
+#if !defined(__APPLE__) && !defined(__QT__) // Only the curl HTTP file source reports metrics.
+TEST(OnlineFileSource, TEST_REQUIRES_SERVER(HTTPMetrics)) {
+    util::RunLoop loop;
+    std::unique_ptr<FileSource> fs = std::make_unique<OnlineFileSource>(ResourceOptions::Default(), ClientOptions());
+
+    fs->setProperty(HTTP2_MULTIPLEXING_KEY, true);
+
+    std::unique_ptr<AsyncRequest> req = fs->request({Resource::Unknown, "http://127.0.0.1:3000/test"}, [&](Response res) {
+        EXPECT_EQ(nullptr, res.error);
+        req.reset();
+        loop.stop();
+    });
+
+    loop.run();
+
+    const auto metrics = fs->getProperty(HTTP_METRICS_KEY);
+    ASSERT_NE(nullptr, metrics.getObject());
+    EXPECT_EQ(1u, *metrics.getObject()->at("requests").getUint());
+    EXPECT_TRUE(*fs->getProperty(HTTP2_MULTIPLEXING_KEY).getBool());
+}
+#endif
+
 TEST(OnlineFileSource, TEST_REQUIRES_SERVER(RequestSameUrlMultipleTimes)) {
     util::RunLoop loop;
     std::unique_ptr<FileSource> fs = std::make_unique<OnlineFileSource>(ResourceOptions::Default(), ClientOptions());
@@ -0,0 +1,238 @@
+#include <mbgl/storage/pmtiles_file_source.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/resource_options.hpp>
+#include <mbgl/test/util.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/platform.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <climits>
+#include <functional>
+#include <gtest/gtest.h>
+
+#if defined(WIN32)
+#    include <Windows.h>
+#    ifndef PATH_MAX
+#        define PATH_MAX MAX_PATH
+#    endif /* PATH_MAX */
+#else
+#    include <unistd.h>
+#endif
+
+namespace {
+
+std::string toAbsoluteURL(const std::string &fileName) {
+    char buff[PATH_MAX + 1];
+#ifdef _MSC_VER
+    char *cwd = _getcwd(buff, PATH_MAX + 1);
+#else
+    char *cwd = getcwd(buff, PATH_MAX + 1);
+#endif
+    std::string url
+        = {"pmtiles://" + std::string(cwd) + "/test/fixtures/storage/pmtiles/" + fileName};
+    assert(url.size() <= PATH_MAX);
+    return url;
+}
+
+std::string tileURL() {
+    return toAbsoluteURL("fixture.pmtiles?file={z}/{x}/{y}");
+}
+
+// Header fields of the fixture.
+constexpr std::size_t rootOffsetField = 8;
+constexpr std::size_t rootLengthField = 16;
+constexpr std::size_t internalCompressionField = 97;
+
+void writeLittleEndian(std::string &data, std::size_t offset, uint64_t value) {
+    for (std::size_t i = 0; i < 8; ++i) {
+        data[offset + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+// Writes a copy of the fixture changed by the given function, and returns its path.
+std::string writeArchive(const std::string &fileName, const std::function<void(std::string &)> &change) {
+    std::string data = mbgl::util::read_file("test/fixtures/storage/pmtiles/fixture.pmtiles");
+    change(data);
+    const std::string path = "test/fixtures/storage/pmtiles/" + fileName;
+    mbgl::util::write_file(path, data);
+    return path;
+}
+
+// Requests the TileJSON of an archive, and returns the error message, or an empty string.
+std::string tileJSONError(mbgl::PMTilesFileSource &pmtiles, const std::string &fileName) {
+    mbgl::util::RunLoop loop;
+    std::string message;
+    std::unique_ptr<mbgl::AsyncRequest> req = pmtiles.request(
+        {mbgl::Resource::Unknown, toAbsoluteURL(fileName)}, [&](mbgl::Response res) {
+            req.reset();
+            if (res.error) {
+                message = res.error->message;
+            }
+            loop.stop();
+        });
+    loop.run();
+    return message;
+}
+
+} // namespace
+
+using namespace mbgl;
+
+TEST(PMTilesFileSource, AcceptsURL) {
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+    EXPECT_TRUE(pmtiles.canRequest(Resource::style("pmtiles:///test")));
+    EXPECT_FALSE(pmtiles.canRequest(Resource::style("pmtile://test")));
+    EXPECT_FALSE(pmtiles.canRequest(Resource::style("mbtiles:///test")));
+    EXPECT_FALSE(pmtiles.canRequest(Resource::style("pmtiles:")));
+    EXPECT_FALSE(pmtiles.canRequest(Resource::style("")));
+}
+
+// pmtiles paths must be absolute
+TEST(PMTilesFileSource, AbsolutePath) {
+    util::RunLoop loop;
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+
+    std::unique_ptr<AsyncRequest> req = pmtiles.request(
+        {Resource::Unknown, "pmtiles://not_absolute"}, [&](Response res) {
+            req.reset();
+            ASSERT_NE(nullptr, res.error);
+            EXPECT_EQ(Response::Error::Reason::Other, res.error->reason);
+            EXPECT_NE((res.error->message).find("absolute"), std::string::npos);
+            ASSERT_FALSE(res.data.get());
+            loop.stop();
+        });
+
+    loop.run();
+}
+
+// Nonexistent pmtiles file raises error
+TEST(PMTilesFileSource, NonExistentFile) {
+    util::RunLoop loop;
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+
+    std::unique_ptr<AsyncRequest> req = pmtiles.request(
+        {Resource::Unknown, toAbsoluteURL("does_not_exist")}, [&](Response res) {
+            req.reset();
+            ASSERT_NE(nullptr, res.error);
+            EXPECT_EQ(Response::Error::Reason::NotFound, res.error->reason);
+            EXPECT_NE((res.error->message).find("path not found"), std::string::npos);
+            ASSERT_FALSE(res.data.get());
+            loop.stop();
+        });
+
+    loop.run();
+}
+
+// Existing pmtiles file default request returns TileJSON built from the header and metadata
+TEST(PMTilesFileSource, TileJSON) {
+    util::RunLoop loop;
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+
+    std::unique_ptr<AsyncRequest> req = pmtiles.request(
+        {Resource::Unknown, toAbsoluteURL("fixture.pmtiles")}, [&](Response res) {
+            req.reset();
+            EXPECT_EQ(nullptr, res.error);
+            ASSERT_TRUE(res.data.get());
+            EXPECT_NE((*res.data).find("fixture.pmtiles?file={z}/{x}/{y}"), std::string::npos);
+            EXPECT_NE((*res.data).find("\"vector_layers\""), std::string::npos);
+            EXPECT_NE((*res.data).find("\"maxzoom\":2"), std::string::npos);
+            loop.stop();
+        });
+
+    loop.run();
+}
+
+// Tiles are found in the root directory, in leaf directories and within runs of identical tiles
+TEST(PMTilesFileSource, Tile) {
+    util::RunLoop loop;
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+
+    const std::vector<std::pair<Resource, std::string>> tiles = {
+        {Resource::tile(tileURL(), 1.0, 0, 0, 0, Tileset::Scheme::XYZ), "tile 0/0/0"},
+        {Resource::tile(tileURL(), 1.0, 1, 0, 1, Tileset::Scheme::XYZ), "tile 1/1/0"},
+        {Resource::tile(tileURL(), 1.0, 1, 1, 2, Tileset::Scheme::XYZ), "tile 2 shared"},
+    };
+
+    std::size_t pending = tiles.size();
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    for (const auto &tile : tiles) {
+        requests.push_back(pmtiles.request(tile.first, [&, expected = tile.second](Response res) {
+            EXPECT_EQ(nullptr, res.error);
+            ASSERT_TRUE(res.data.get());
+            EXPECT_EQ(expected, *res.data);
+            EXPECT_FALSE(res.noContent);
+            if (--pending == 0) {
+                loop.stop();
+            }
+        }));
+    }
+
+    loop.run();
+}
+
+// Nonexistent tiles do not raise errors, they simply return no content
+TEST(PMTilesFileSource, NonExistentTile) {
+    util::RunLoop loop;
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+
+    std::unique_ptr<AsyncRequest> req = pmtiles.request(
+        Resource::tile(tileURL(), 1.0, 3, 3, 2, Tileset::Scheme::XYZ), [&](Response res) {
+            req.reset();
+            EXPECT_EQ(nullptr, res.error);
+            ASSERT_FALSE(res.data.get());
+            ASSERT_EQ(res.noContent, true);
+            loop.stop();
+        });
+
+    loop.run();
+}
+
+// Malformed archives are reported as errors.
+TEST(PMTilesFileSource, TEST_REQUIRES_WRITE(Malformed)) {
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+
+    const std::string truncatedHeader = writeArchive("truncated_header.pmtiles", [](std::string &data) {
+        data.resize(100);
+    });
+    EXPECT_NE(std::string::npos, tileJSONError(pmtiles, "truncated_header.pmtiles").find("not a PMTiles archive"));
+
+    const std::string rootOutOfRange = writeArchive("root_out_of_range.pmtiles", [](std::string &data) {
+        writeLittleEndian(data, rootOffsetField, data.size() - 10);
+    });
+    EXPECT_NE(std::string::npos, tileJSONError(pmtiles, "root_out_of_range.pmtiles").find("truncated"));
+
+    // An uncompressed root directory made of a varint that doesn't end.
+    const std::string badVarint = writeArchive("bad_varint.pmtiles", [](std::string &data) {
+        data[internalCompressionField] = 1;
+        writeLittleEndian(data, rootLengthField, 12);
+        for (std::size_t i = 0; i < 12; ++i) {
+            data[127 + i] = static_cast<char>(0xff);
+        }
+    });
+    EXPECT_NE(std::string::npos, tileJSONError(pmtiles, "bad_varint.pmtiles").find("malformed directory"));
+
+    util::deleteFile(truncatedHeader);
+    util::deleteFile(rootOutOfRange);
+    util::deleteFile(badVarint);
+}
+
+// An archive is read again once its file changes.
+TEST(PMTilesFileSource, TEST_REQUIRES_WRITE(ChangedFile)) {
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+
+    const std::string path = writeArchive("changed.pmtiles", [](std::string &) {});
+    EXPECT_EQ("", tileJSONError(pmtiles, "changed.pmtiles"));
+
+    writeArchive("changed.pmtiles", [](std::string &data) { data.resize(100); });
+    EXPECT_NE(std::string::npos, tileJSONError(pmtiles, "changed.pmtiles").find("not a PMTiles archive"));
+
+    writeArchive("changed.pmtiles", [](std::string &) {});
+    EXPECT_EQ("", tileJSONError(pmtiles, "changed.pmtiles"));
+
+    util::deleteFile(path);
+}
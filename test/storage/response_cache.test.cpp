@@ -0,0 +1,127 @@
+#include <mbgl/storage/response_cache.hpp>
+#include <mbgl/util/chrono.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace mbgl;
+
+namespace {
+
+const std::string scope = "scope";
+
+Response freshResponse(std::string data) {
+    Response response;
+    response.data = std::make_shared<const std::string>(std::move(data));
+    response.expires = util::now() + Seconds(60);
+    return response;
+}
+
+} // namespace
+
+TEST(ResponseCache, PutAndGet) {
+    ResponseCache cache;
+    const Resource style = Resource::style("http://example.com/style.json");
+
+    EXPECT_FALSE(cache.get(style, scope));
+    const Response response = freshResponse("style");
+    cache.put(style, response, scope);
+
+    auto cached = cache.get(style, scope);
+    ASSERT_TRUE(cached);
+    EXPECT_EQ(response.data, cached->data);
+    EXPECT_EQ(response.expires, cached->expires);
+
+    // The kind is part of the key.
+    EXPECT_FALSE(cache.get(Resource::source("http://example.com/style.json"), scope));
+
+    const auto statistics = cache.getStatistics();
+    EXPECT_EQ(1u, statistics.hits);
+    EXPECT_EQ(2u, statistics.misses);
+    EXPECT_EQ(1u, statistics.entries);
+    EXPECT_EQ(5u, statistics.size);
+}
+
+TEST(ResponseCache, Scopes) {
+    ResponseCache cache;
+    const Resource style = Resource::style("maptiler://maps/streets");
+
+    // Loaders with other options resolve the same URL differently, and don't share responses.
+    cache.put(style, freshResponse("first"), "first");
+    cache.put(style, freshResponse("second"), "second");
+    EXPECT_FALSE(cache.get(style, "third"));
+
+    auto first = cache.get(style, "first");
+    ASSERT_TRUE(first);
+    EXPECT_EQ("first", *first->data);
+
+    auto second = cache.get(style, "second");
+    ASSERT_TRUE(second);
+    EXPECT_EQ("second", *second->data);
+
+    EXPECT_EQ(2u, cache.getStatistics().entries);
+}
+
+TEST(ResponseCache, RejectsUncacheable) {
+    ResponseCache cache;
+    const Resource style = Resource::style("http://example.com/style.json");
+
+    Response stale = freshResponse("stale");
+    stale.expires = util::now() - Seconds(1);
+    cache.put(style, stale, scope);
+
+    Response noExpiration = freshResponse("no expiration");
+    noExpiration.expires = std::nullopt;
+    cache.put(style, noExpiration, scope);
+
+    Response error = freshResponse("error");
+    error.error = std::make_unique<Response::Error>(Response::Error::Reason::Server);
+    cache.put(style, error, scope);
+
+    Resource volatileStyle = style;
+    volatileStyle.storagePolicy = Resource::StoragePolicy::Volatile;
+    cache.put(volatileStyle, freshResponse("volatile"), scope);
+
+    cache.put(Resource::tile("http://example.com/{z}/{x}/{y}.pbf", 1.0, 0, 0, 0, Tileset::Scheme::XYZ),
+              freshResponse("tile"), scope);
+
+    EXPECT_EQ(0u, cache.getStatistics().entries);
+}
+
+TEST(ResponseCache, NetworkOnlyBypassesCache) {
+    ResponseCache cache;
+    Resource style = Resource::style("http://example.com/style.json");
+    cache.put(style, freshResponse("style"), scope);
+
+    style.loadingMethod = Resource::LoadingMethod::NetworkOnly;
+    EXPECT_FALSE(cache.get(style, scope));
+}
+
+TEST(ResponseCache, EvictsLeastRecentlyUsed) {
+    ResponseCache cache(10);
+    const Resource first = Resource::spriteJSON("http://example.com/sprite", 1.0);
+    const Resource second = Resource::spriteImage("http://example.com/sprite", 1.0);
+    const Resource third = Resource::glyphs("http://example.com/{fontstack}/{range}.pbf", {"Font"}, {0, 255});
+
+    cache.put(first, freshResponse("1111"), scope);
+    cache.put(second, freshResponse("2222"), scope);
+    EXPECT_TRUE(cache.get(first, scope));
+
+    // The second response is the least recently used one.
+    cache.put(third, freshResponse("3333"), scope);
+    EXPECT_TRUE(cache.get(first, scope));
+    EXPECT_FALSE(cache.get(second, scope));
+    EXPECT_TRUE(cache.get(third, scope));
+    EXPECT_EQ(8u, cache.getStatistics().size);
+
+    // Responses larger than the cache aren't kept.
+    cache.put(second, freshResponse("22222222222"), scope);
+    EXPECT_FALSE(cache.get(second, scope));
+
+    cache.setMaximumSize(4);
+    EXPECT_EQ(1u, cache.getStatistics().entries);
+    EXPECT_TRUE(cache.get(third, scope));
+
+    cache.clear();
+    EXPECT_EQ(0u, cache.getStatistics().size);
+    EXPECT_FALSE(cache.get(third, scope));
+}
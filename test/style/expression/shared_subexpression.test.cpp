@@ -0,0 +1,153 @@
+#include <mbgl/test/util.hpp>
+#include <mbgl/test/stub_geometry_tile_feature.hpp>
+
+#include <mbgl/style/expression/dsl.hpp>
+#include <mbgl/style/expression/shared_subexpression.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace mbgl::style::expression;
+using mbgl::PropertyMap;
+using mbgl::StubGeometryTileFeature;
+
+namespace {
+
+class CountingFeature : public StubGeometryTileFeature {
+public:
+    using StubGeometryTileFeature::StubGeometryTileFeature;
+
+    std::optional<mbgl::Value> getValue(const std::string& key) const override {
+        ++reads;
+        return StubGeometryTileFeature::getValue(key);
+    }
+
+    mutable std::size_t reads = 0;
+};
+
+// Compares evaluation results, including their errors.
+bool sameResult(const EvaluationResult& lhs, const EvaluationResult& rhs) {
+    if (!lhs || !rhs) {
+        return !lhs && !rhs && lhs.error().message == rhs.error().message;
+    }
+    return *lhs == *rhs;
+}
+
+const char* name = R"(["coalesce", ["get", "name:en"], ["get", "name"]])";
+const char* concatenated = R"(["concat", ["coalesce", ["get", "name:en"], ["get", "name"]], "!"])";
+const char* upcased = R"(["upcase", ["coalesce", ["get", "name:en"], ["get", "name"]]])";
+
+} // namespace
+
+TEST(SharedSubexpression, EvaluatedOncePerFeature) {
+    std::unique_ptr<Expression> first;
+    std::unique_ptr<Expression> second;
+    {
+        SubexpressionPool pool;
+        first = dsl::createExpression(concatenated);
+        second = dsl::createExpression(upcased);
+    }
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(Kind::SharedSubexpression, first->getKind());
+
+    // Without a cache, every occurrence is evaluated.
+    CountingFeature feature(PropertyMap{{"name", std::string("Berlin")}});
+    EXPECT_EQ(Value(std::string("Berlin!")), *first->evaluate(EvaluationContext(&feature)));
+    EXPECT_EQ(2u, feature.reads);
+
+    SubexpressionCache cache;
+    cache.beginFeature(feature);
+    feature.reads = 0;
+    EXPECT_EQ(Value(std::string("Berlin!")), *first->evaluate(EvaluationContext(&feature)));
+    EXPECT_EQ(Value(std::string("BERLIN")), *second->evaluate(EvaluationContext(&feature)));
+    EXPECT_EQ(2u, feature.reads);
+
+    // Results are dropped for the next feature.
+    CountingFeature other(PropertyMap{{"name:en", std::string("Munich")}});
+    cache.beginFeature(other);
+    EXPECT_EQ(Value(std::string("MUNICH")), *second->evaluate(EvaluationContext(&other)));
+    EXPECT_EQ(Value(std::string("Munich!")), *first->evaluate(EvaluationContext(&other)));
+    EXPECT_EQ(1u, other.reads);
+
+    // Other features are never served from the cache.
+    feature.reads = 0;
+    EXPECT_EQ(Value(std::string("BERLIN")), *second->evaluate(EvaluationContext(&feature)));
+    EXPECT_EQ(2u, feature.reads);
+}
+
+TEST(SharedSubexpression, Transparent) {
+    std::unique_ptr<Expression> pooled;
+    {
+        SubexpressionPool pool;
+        pooled = dsl::createExpression(concatenated);
+        dsl::createExpression(name);
+    }
+    const auto plain = dsl::createExpression(concatenated);
+
+    EXPECT_EQ(plain->serialize(), pooled->serialize());
+    EXPECT_TRUE(*pooled == *plain);
+    EXPECT_TRUE(*plain == *pooled);
+    EXPECT_TRUE(*pooled != *dsl::createExpression(upcased));
+    EXPECT_TRUE(*dsl::createExpression(upcased) != *pooled);
+
+    // Subexpressions that depend on more than the feature aren't shared, but their children
+    // are, and compare equal to unshared ones either way.
+    const char* zoomDependentText = R"(["case", [">", ["zoom"], 10], ["upcase", ["get", "name"]], "none"])";
+    const auto plainZoomDependent = dsl::createExpression(zoomDependentText);
+    SubexpressionPool pool;
+    const auto zoomDependent = dsl::createExpression(zoomDependentText);
+    EXPECT_NE(Kind::SharedSubexpression, zoomDependent->getKind());
+    bool sharesChild = false;
+    zoomDependent->eachChild(
+        [&](const Expression& child) { sharesChild |= child.getKind() == Kind::SharedSubexpression; });
+    EXPECT_TRUE(sharesChild);
+    EXPECT_TRUE(*zoomDependent == *plainZoomDependent);
+    EXPECT_TRUE(*plainZoomDependent == *zoomDependent);
+}
+
+TEST(SharedSubexpression, SameResultAsUnshared) {
+    const std::vector<const char*> expressions{
+        concatenated,
+        upcased,
+        R"(["match", ["get", "class"], "motorway", 1, "trunk", 2, 0])",
+        R"(["match", ["get", "class"], "motorway", 2, "trunk", 1, 0])",
+        R"(["case", ["==", ["get", "class"], "motorway"], ["length", ["get", "name"]], -1])",
+        R"(["to-number", ["coalesce", ["get", "rank"], ["get", "class"]], 7])",
+        R"(["in", ["get", "class"], ["literal", ["motorway", "trunk"]]])",
+    };
+    const std::vector<PropertyMap> features{
+        PropertyMap{{"name", std::string("Berlin")}, {"class", std::string("motorway")}},
+        PropertyMap{{"name:en", std::string("Munich")}, {"class", std::string("trunk")}, {"rank", 2.0}},
+        PropertyMap{{"class", std::string("path")}, {"rank", std::string("x")}},
+        PropertyMap{},
+    };
+
+    // The expressions share subexpressions with each other; the labels of the two matches only
+    // differ in data that isn't a child expression, so they must not be merged.
+    std::vector<std::unique_ptr<Expression>> shared;
+    {
+        SubexpressionPool pool;
+        for (const char* expression : expressions) {
+            shared.push_back(dsl::createExpression(expression));
+            ASSERT_TRUE(shared.back());
+        }
+    }
+
+    for (std::size_t i = 0; i < expressions.size(); ++i) {
+        const auto plain = dsl::createExpression(expressions[i]);
+        ASSERT_TRUE(plain);
+        for (const auto& properties : features) {
+            StubGeometryTileFeature feature(properties);
+            const EvaluationResult expected = plain->evaluate(EvaluationContext(&feature));
+
+            EXPECT_TRUE(sameResult(expected, shared[i]->evaluate(EvaluationContext(&feature)))) << expressions[i];
+
+            SubexpressionCache cache;
+            cache.beginFeature(feature);
+            for (const auto& other : shared) {
+                other->evaluate(EvaluationContext(&feature));
+            }
+            EXPECT_TRUE(sameResult(expected, shared[i]->evaluate(EvaluationContext(&feature)))) << expressions[i];
+        }
+    }
+}
@@ -8,6 +8,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <mbgl/style/conversion/stringify.hpp>
 
+#include <mbgl/style/compiled_filter.hpp>
 #include <mbgl/style/filter.hpp>
 #include <mbgl/style/conversion/json.hpp>
 #include <mbgl/style/conversion/filter.hpp>
@@ -33,7 +34,9 @@ bool filter(const char * json,
     StubGeometryTileFeature feature { featureId, featureType, featureGeometry, featureProperties };
     expression::EvaluationContext context = { zoom, &feature };
     
-    return (*filter)(context);
+    const bool result = (*filter)(context);
+    EXPECT_EQ(result, CompiledFilter(*filter)(context)) << json;
+    return result;
 }
 
 void invalidFilter(const char * json) {
@@ -262,3 +265,52 @@ TEST(Filter, LegacyExpressionInvalidType) {
     std::optional<Filter> result = conversion::convert<Filter>(conversion::Convertible(&value), error);
     EXPECT_FALSE(result);
 }
+
+TEST(Filter, Compiled) {
+    const auto compile = [](const char* json) {
+        conversion::Error error;
+        std::optional<Filter> result = conversion::convertJSON<Filter>(json, error);
+        EXPECT_TRUE(bool(result));
+        return CompiledFilter(*result);
+    };
+
+    // Common legacy and expression filters are evaluated without going through the expression.
+    EXPECT_EQ(0u, compile(R"(["all", ["==", "class", "motorway"], ["!=", "$type", "Point"], ["in", "rank", 1, 2], ["has", "name"]])").getFallbackCount());
+    EXPECT_EQ(0u, compile(R"(["all", ["==", ["get", "class"], "motorway"], ["!=", ["get", "layer"], 1], ["!", ["has", "tunnel"]]])").getFallbackCount());
+    EXPECT_EQ(1u, compile(R"(["all", ["==", "class", "motorway"], ["<", ["get", "rank"], 5]])").getFallbackCount());
+
+    // Properties are compared like expression values.
+    ASSERT_TRUE(filter(R"(["==", ["get", "rank"], 1])", {{"rank", uint64_t(1)}}));
+    ASSERT_TRUE(filter(R"(["==", ["get", "rank"], -1])", {{"rank", int64_t(-1)}}));
+    ASSERT_FALSE(filter(R"(["==", ["get", "rank"], "1"])", {{"rank", uint64_t(1)}}));
+    ASSERT_TRUE(filter(R"(["==", ["get", "rank"], null])", {{}}));
+    ASSERT_TRUE(filter(R"(["!=", ["get", "rank"], 1])", {{}}));
+    ASSERT_FALSE(filter(R"(["!=", ["get", "rank"], null])", {{}}));
+    ASSERT_TRUE(filter(R"(["in", "rank", 2, 3])", {{"rank", 3.0}}));
+    ASSERT_FALSE(filter(R"(["in", "rank", 2, 3])", {{}}));
+}
+
+TEST(Filter, CompiledFallback) {
+    const auto compile = [](const char* json) {
+        conversion::Error error;
+        std::optional<Filter> result = conversion::convertJSON<Filter>(json, error);
+        EXPECT_TRUE(bool(result));
+        return CompiledFilter(*result);
+    };
+
+    // The expression syntax of geometry type comparisons and "in" isn't compiled...
+    EXPECT_EQ(1u, compile(R"(["==", ["geometry-type"], "Point"])").getFallbackCount());
+    EXPECT_EQ(1u, compile(R"(["in", ["get", "class"], ["literal", ["motorway", "trunk"]]])").getFallbackCount());
+    EXPECT_EQ(2u, compile(R"(["all", ["==", "class", "motorway"], ["!=", ["geometry-type"], "Point"], ["in", 1, ["get", "ranks"]]])").getFallbackCount());
+
+    // ...but gives the same result as the filter through the fallback.
+    ASSERT_TRUE(filter(R"(["==", ["geometry-type"], "Point"])"));
+    ASSERT_FALSE(filter(R"(["==", ["geometry-type"], "LineString"])"));
+    ASSERT_TRUE(filter(R"(["!=", ["geometry-type"], "Polygon"])", {{}}, {}, FeatureType::LineString));
+    ASSERT_TRUE(filter(R"(["in", ["get", "class"], ["literal", ["motorway", "trunk"]]])", {{"class", std::string("trunk")}}));
+    ASSERT_FALSE(filter(R"(["in", ["get", "class"], ["literal", ["motorway", "trunk"]]])", {{"class", std::string("path")}}));
+    ASSERT_TRUE(filter(R"(["all", ["==", "class", "motorway"], ["!=", ["geometry-type"], "Point"]])",
+                       {{"class", std::string("motorway")}}, {}, FeatureType::Polygon));
+    ASSERT_FALSE(filter(R"(["all", ["==", "class", "motorway"], ["!=", ["geometry-type"], "Point"]])",
+                        {{"class", std::string("motorway")}}, {}, FeatureType::Point));
+}
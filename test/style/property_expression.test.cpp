@@ -1,6 +1,9 @@
 #include <mbgl/test/util.hpp>
 #include <mbgl/test/stub_geometry_tile_feature.hpp>
 
+#include <mbgl/style/conversion/json.hpp>
+#include <mbgl/style/conversion/property_value.hpp>
+#include <mbgl/style/conversion_impl.hpp>
 #include <mbgl/style/property_expression.hpp>
 #include <mbgl/renderer/property_evaluator.hpp>
 #include <mbgl/renderer/property_evaluation_parameters.hpp>
@@ -111,6 +114,54 @@ TEST(PropertyExpression, ZoomInterpolation) {
     .evaluate(0.0f, oneInteger, -1.0f)) << "Should interpolate TO the first stop";
 }
 
+TEST(PropertyExpression, BatchEvaluation) {
+    const std::vector<StubGeometryTileFeature> features{
+        StubGeometryTileFeature(PropertyMap{{"property", uint64_t(3)}}),
+        StubGeometryTileFeature(PropertyMap{{"property", -1.5}}),
+        StubGeometryTileFeature(PropertyMap{{"property", 10.0}}),
+        StubGeometryTileFeature(PropertyMap{{"property", "1"s}}),
+        StubGeometryTileFeature(PropertyMap{}),
+    };
+    std::vector<const GeometryTileFeature*> pointers;
+    for (const auto& feature : features) {
+        pointers.push_back(&feature);
+    }
+
+    const auto check = [&](const PropertyExpression<float>& expression, float zoomLevel) {
+        const EvaluationContext context(zoomLevel, nullptr);
+        std::vector<float> results(pointers.size());
+        expression.evaluate(context, pointers.data(), pointers.size(), results.data(), -1.0f);
+        for (std::size_t i = 0; i < features.size(); ++i) {
+            EXPECT_EQ(expression.evaluate(EvaluationContext(zoomLevel, &features[i]), -1.0f), results[i])
+                << "feature " << i << " at zoom " << zoomLevel;
+        }
+    };
+
+    const auto parse = [](const char* json) {
+        conversion::Error error;
+        auto value = conversion::convertJSON<PropertyValue<float>>(json, error, true, false);
+        EXPECT_TRUE(value && value->isExpression()) << error.message;
+        return value->asExpression();
+    };
+
+    for (float zoomLevel : {0.0f, 2.5f, 5.0f, 12.0f}) {
+        check(PropertyExpression<float>(number(get("property")), 0.0f), zoomLevel);
+        check(PropertyExpression<float>(number(get("property"), literal(7.0))), zoomLevel);
+        check(PropertyExpression<float>(
+                  interpolate(exponential(2.0), number(get("property")), 0.0, literal(0.0), 5.0, literal(10.0))),
+              zoomLevel);
+        check(PropertyExpression<float>(step(number(get("property")), literal(1.0), 2.0, literal(2.0))), zoomLevel);
+        check(PropertyExpression<float>(
+                  interpolate(linear(), zoom(),
+                      0.0, interpolate(linear(), number(get("property")), 0.0, literal(0.0), 5.0, literal(10.0)),
+                      5.0, interpolate(linear(), number(get("property")), 0.0, literal(20.0), 5.0, literal(40.0)))),
+              zoomLevel);
+        check(parse(R"(["match", ["get", "property"], 3, 30, [1, 10], 20, -5])"), zoomLevel);
+        check(parse(R"(["match", ["get", "property"], "1", ["get", "property"], 0])"), zoomLevel);
+        check(parse(R"(["step", ["zoom"], ["get", "property"], 4, ["*", 2, ["number", ["get", "property"], 0]]])"), zoomLevel);
+    }
+}
+
 TEST(PropertyExpression, Issue8460) {
     PropertyExpression<float> fn1(
         interpolate(linear(), zoom(),
@@ -6,16 +6,25 @@
 
 #include <mbgl/annotation/annotation_manager.hpp>
 #include <mbgl/map/transform.hpp>
+#include <mbgl/platform/settings.hpp>
+#include <mbgl/renderer/buckets/circle_bucket.hpp>
 #include <mbgl/renderer/image_manager.hpp>
+#include <mbgl/renderer/render_layer.hpp>
 #include <mbgl/renderer/tile_parameters.hpp>
 #include <mbgl/style/layers/circle_layer.hpp>
 #include <mbgl/style/layers/circle_layer_impl.hpp>
+#include <mbgl/style/layers/symbol_layer.hpp>
+#include <mbgl/style/layers/symbol_layer_impl.hpp>
 #include <mbgl/style/sources/geojson_source.hpp>
 #include <mbgl/style/style.hpp>
 #include <mbgl/text/glyph_manager.hpp>
+#include <mbgl/tile/tile_parse_counters.hpp>
 #include <mbgl/util/run_loop.hpp>
 
+#include <chrono>
+#include <cstring>
 #include <memory>
+#include <thread>
 
 using namespace mbgl;
 using namespace mbgl::style;
@@ -132,3 +141,190 @@ TEST(GeoJSONTile, Issue9927) {
     ASSERT_TRUE(tile.isRenderable());
     ASSERT_TRUE(tile.layerPropertiesUpdated(layerProperties));
  }
+
+TEST(GeoJSONTile, ParseStatistics) {
+    GeoJSONTileTest test;
+    auto counters = std::make_shared<TileParseCounters>();
+    TileParameters tileParameters{1.0,
+                                  MapDebugOptions(),
+                                  test.transformState,
+                                  test.fileSource,
+                                  MapMode::Continuous,
+                                  test.annotationManager.makeWeakPtr(),
+                                  test.imageManager,
+                                  test.glyphManager,
+                                  0,
+                                  counters};
+
+    CircleLayer layer("circle", "source");
+    Immutable<LayerProperties> layerProperties =
+        makeMutable<CircleLayerProperties>(staticImmutableCast<CircleLayer::Impl>(layer.baseImpl));
+    std::vector<Immutable<LayerProperties>> layers{layerProperties};
+
+    mapbox::feature::feature_collection<int16_t> features;
+    features.push_back(mapbox::feature::feature<int16_t>{mapbox::geometry::point<int16_t>(0, 0)});
+    auto data = std::make_shared<FakeGeoJSONData>(std::move(features));
+
+    GeoJSONTile tile(OverscaledTileID(0, 0, 0), "source", tileParameters, data);
+    tile.setLayers(layers);
+    while (!tile.isComplete()) {
+        test.loop.runOnce();
+    }
+
+    auto statistics = counters->getStatistics();
+    EXPECT_EQ(1u, statistics.parsesStarted);
+    EXPECT_EQ(0u, statistics.parsesCancelled);
+    EXPECT_EQ(0.0, statistics.wastedParseWallTime);
+
+    // A parse of an obsolete tile is abandoned and accounted for.
+    GeoJSONTile obsoleteTile(OverscaledTileID(0, 0, 0), "source", tileParameters, data);
+    obsoleteTile.cancel();
+    obsoleteTile.setLayers(layers);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (counters->getStatistics().parsesCancelled == 0) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "The obsolete parse was never abandoned";
+        std::this_thread::yield();
+    }
+
+    statistics = counters->getStatistics();
+    EXPECT_EQ(2u, statistics.parsesStarted);
+    EXPECT_EQ(1u, statistics.parsesCancelled);
+    EXPECT_LT(0.0, statistics.wastedParseWallTime);
+    EXPECT_FALSE(obsoleteTile.isRenderable());
+
+    // Further updates of the obsolete tile neither parse it again nor count it again.
+    obsoleteTile.setLayers(layers);
+    obsoleteTile.setLayers(layers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const auto wastedParseWallTime = statistics.wastedParseWallTime;
+    statistics = counters->getStatistics();
+    EXPECT_EQ(2u, statistics.parsesStarted);
+    EXPECT_EQ(1u, statistics.parsesCancelled);
+    EXPECT_EQ(wastedParseWallTime, statistics.wastedParseWallTime);
+}
+
+TEST(GeoJSONTile, ParseStatisticsWaitingForGlyphs) {
+    GeoJSONTileTest test;
+    auto counters = std::make_shared<TileParseCounters>();
+    TileParameters tileParameters{1.0,
+                                  MapDebugOptions(),
+                                  test.transformState,
+                                  test.fileSource,
+                                  MapMode::Continuous,
+                                  test.annotationManager.makeWeakPtr(),
+                                  test.imageManager,
+                                  test.glyphManager,
+                                  0,
+                                  counters};
+
+    SymbolLayer layer("symbol", "source");
+    layer.setTextField(expression::Formatted("label"));
+    Immutable<LayerProperties> layerProperties =
+        makeMutable<SymbolLayerProperties>(staticImmutableCast<SymbolLayer::Impl>(layer.baseImpl));
+
+    mapbox::feature::feature_collection<int16_t> features;
+    features.push_back(mapbox::feature::feature<int16_t>{mapbox::geometry::point<int16_t>(0, 0)});
+    auto data = std::make_shared<FakeGeoJSONData>(std::move(features));
+
+    auto& fileSource = static_cast<FakeFileSource&>(*test.fileSource);
+    auto tile = std::make_unique<GeoJSONTile>(OverscaledTileID(0, 0, 0), "source", tileParameters, data);
+    tile->setLayers({layerProperties});
+
+    // The parse is done once the tile asks for the glyphs, which never arrive.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (fileSource.requests.empty()) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "The tile never requested its glyphs";
+        test.loop.runOnce();
+    }
+    EXPECT_EQ(1u, counters->getStatistics().parsesStarted);
+    EXPECT_EQ(0u, counters->getStatistics().parsesCancelled);
+
+    // Discarding the tile abandons the parse that was waiting for them.
+    tile->cancel();
+    tile.reset();
+
+    const auto statistics = counters->getStatistics();
+    EXPECT_EQ(1u, statistics.parsesStarted);
+    EXPECT_EQ(1u, statistics.parsesCancelled);
+    EXPECT_LT(0.0, statistics.wastedParseWallTime);
+}
+
+namespace {
+
+// Exposes the parse results of a tile.
+class InspectableGeoJSONTile : public GeoJSONTile {
+public:
+    using GeoJSONTile::GeoJSONTile;
+    using GeometryTile::getLayerRenderData;
+};
+
+// Sets the parallel tile parsing setting for the lifetime of the guard.
+class ParallelParsingSetting {
+public:
+    explicit ParallelParsingSetting(bool enabled) {
+        platform::Settings::getInstance().set(platform::EXPERIMENTAL_PARALLEL_TILE_PARSING,
+                                              mapbox::base::Value{enabled});
+    }
+    ~ParallelParsingSetting() {
+        platform::Settings::getInstance().set(platform::EXPERIMENTAL_PARALLEL_TILE_PARSING, mapbox::base::Value{});
+    }
+};
+
+} // namespace
+
+TEST(GeoJSONTile, ParallelParsing) {
+    // Different zoom ranges put the layers into separate layer groups.
+    CircleLayer layer1("circle1", "source");
+    CircleLayer layer2("circle2", "source");
+    layer2.setMaxZoom(20);
+
+    Immutable<LayerProperties> layerProperties1 =
+        makeMutable<CircleLayerProperties>(staticImmutableCast<CircleLayer::Impl>(layer1.baseImpl));
+    Immutable<LayerProperties> layerProperties2 =
+        makeMutable<CircleLayerProperties>(staticImmutableCast<CircleLayer::Impl>(layer2.baseImpl));
+    std::vector<Immutable<LayerProperties>> layers{layerProperties1, layerProperties2};
+
+    mapbox::feature::feature_collection<int16_t> features;
+    features.push_back(mapbox::feature::feature<int16_t>{mapbox::geometry::point<int16_t>(0, 0)});
+    features.push_back(mapbox::feature::feature<int16_t>{mapbox::geometry::point<int16_t>(10, 10)});
+    auto data = std::make_shared<FakeGeoJSONData>(std::move(features));
+
+    // Returns the vertices and indices of the circle bucket of every layer.
+    auto parse = [&](bool parallel) {
+        ParallelParsingSetting setting(parallel);
+        GeoJSONTileTest test;
+        InspectableGeoJSONTile tile(OverscaledTileID(0, 0, 0), "source", test.tileParameters, data);
+        tile.setLayers(layers);
+        while (!tile.isComplete()) {
+            test.loop.runOnce();
+        }
+
+        EXPECT_TRUE(tile.isRenderable());
+        EXPECT_TRUE(tile.layerPropertiesUpdated(layerProperties1));
+        EXPECT_TRUE(tile.layerPropertiesUpdated(layerProperties2));
+
+        std::vector<std::pair<std::vector<CircleLayoutVertex>, std::vector<uint16_t>>> buckets;
+        for (const auto& layer : layers) {
+            LayerRenderData* renderData = tile.getLayerRenderData(*layer->baseImpl);
+            EXPECT_NE(nullptr, renderData);
+            if (!renderData) continue;
+            const auto& bucket = static_cast<const CircleBucket&>(*renderData->bucket);
+            buckets.emplace_back(bucket.vertices.vector(), bucket.triangles.vector());
+        }
+        return buckets;
+    };
+
+    const auto serial = parse(false);
+    const auto parallel = parse(true);
+    ASSERT_EQ(2u, serial.size());
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        ASSERT_EQ(serial[i].first.size(), parallel[i].first.size());
+        EXPECT_EQ(0,
+                  std::memcmp(serial[i].first.data(),
+                              parallel[i].first.data(),
+                              serial[i].first.size() * sizeof(CircleLayoutVertex)));
+        EXPECT_EQ(serial[i].second, parallel[i].second);
+    }
+}
@@ -0,0 +1,146 @@
+#include <mbgl/test/util.hpp>
+
+#include <mbgl/tile/geojson_tile_data.hpp>
+#include <mbgl/tile/geometry_tile_layer_cache.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+GeoJSONTileData makeData() {
+    mapbox::feature::feature_collection<int16_t> features;
+    features.push_back(mapbox::feature::feature<int16_t>{mapbox::geometry::point<int16_t>(1, 2)});
+    features.push_back(mapbox::feature::feature<int16_t>{mapbox::geometry::point<int16_t>(3, 4)});
+    return GeoJSONTileData(std::move(features));
+}
+
+// Counts how often the geometry of its single feature is decoded.
+class CountingFeature final : public GeometryTileFeature {
+public:
+    explicit CountingFeature(std::atomic<int>& decoded_) : decoded(decoded_) {}
+
+    FeatureType getType() const override { return FeatureType::Point; }
+    std::optional<Value> getValue(const std::string&) const override { return std::nullopt; }
+
+    const GeometryCollection& getGeometries() const override {
+        if (!geometries) {
+            ++decoded;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            geometries = GeometryCollection{{{1, 2}}};
+        }
+        return *geometries;
+    }
+
+private:
+    std::atomic<int>& decoded;
+    mutable std::optional<GeometryCollection> geometries;
+};
+
+class CountingLayer final : public GeometryTileLayer {
+public:
+    explicit CountingLayer(std::atomic<int>& decoded_) : decoded(decoded_) {}
+
+    std::size_t featureCount() const override { return 1; }
+    std::unique_ptr<GeometryTileFeature> getFeature(std::size_t) const override {
+        return std::make_unique<CountingFeature>(decoded);
+    }
+    std::string getName() const override { return "layer"; }
+
+private:
+    std::atomic<int>& decoded;
+};
+
+class CountingData final : public GeometryTileData {
+public:
+    std::unique_ptr<GeometryTileData> clone() const override { return std::make_unique<CountingData>(); }
+    std::unique_ptr<GeometryTileLayer> getLayer(const std::string&) const override {
+        return std::make_unique<CountingLayer>(decoded);
+    }
+
+    mutable std::atomic<int> decoded{0};
+};
+
+} // namespace
+
+TEST(GeometryTileLayerCache, SharesDecodedFeatures) {
+    auto data = makeData();
+    GeometryTileLayerCache cache(data, 1024 * 1024);
+
+    auto first = cache.getLayer("layer");
+    auto second = cache.getLayer("layer");
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(2u, first->featureCount());
+    const std::size_t slots = cache.getSize();
+
+    // Every layer object reads the geometry decoded by the first reader.
+    auto cursor = first->makeCursor();
+    const GeometryCollection& geometries = cursor->seek(1).getGeometries();
+    GeometryCollection expected{{{3, 4}}};
+    EXPECT_EQ(expected, geometries);
+    EXPECT_LT(slots, cache.getSize());
+
+    EXPECT_EQ(&geometries, &second->makeCursor()->seek(1).getGeometries());
+    EXPECT_EQ(&geometries, &second->getFeature(1)->getGeometries());
+
+    // So does a feature taken from a cursor.
+    auto other = second->makeCursor();
+    other->seek(1);
+    EXPECT_EQ(&geometries, &other->take()->getGeometries());
+}
+
+TEST(GeometryTileLayerCache, ChargesOverhead) {
+    auto data = makeData();
+    GeometryTileLayerCache cache(data, 1024 * 1024);
+
+    // A single point costs more than its coordinates.
+    auto layer = cache.getLayer("layer");
+    const std::size_t slots = cache.getSize();
+    layer->makeCursor()->seek(0).getGeometries();
+    EXPECT_LT(sizeof(GeometryCollection) + sizeof(GeometryCoordinates) + sizeof(GeometryCoordinate),
+              cache.getSize() - slots);
+}
+
+TEST(GeometryTileLayerCache, SizeLimit) {
+    auto data = makeData();
+    GeometryTileLayerCache cache(data, 1);
+
+    auto first = cache.getLayer("layer");
+    auto second = cache.getLayer("layer");
+    first->makeCursor()->seek(0).getGeometries();
+
+    // The limit is reached, so the second feature isn't cached anymore.
+    auto feature = first->getFeature(1);
+    auto other = second->getFeature(1);
+    EXPECT_EQ(feature->getGeometries(), other->getGeometries());
+    EXPECT_NE(&feature->getGeometries(), &other->getGeometries());
+}
+
+TEST(GeometryTileLayerCache, DecodesOnceAcrossThreads) {
+    CountingData data;
+    GeometryTileLayerCache cache(data, 1024 * 1024);
+
+    // Readers that ask for the feature while it is being decoded wait for it instead of
+    // decoding it again, and they all get the same data.
+    std::vector<std::unique_ptr<GeometryTileLayer>> layers;
+    for (int i = 0; i < 4; ++i) {
+        layers.push_back(cache.getLayer("layer"));
+    }
+    std::vector<const GeometryCollection*> results(layers.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < layers.size(); ++i) {
+        threads.emplace_back([&, i] { results[i] = &layers[i]->makeCursor()->seek(0).getGeometries(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(1, data.decoded);
+    for (const auto* result : results) {
+        EXPECT_EQ(results.front(), result);
+    }
+}
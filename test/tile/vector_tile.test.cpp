@@ -105,3 +105,27 @@ TEST(VectorTileData, ParseResults) {
 
     ASSERT_EQ(feature->getValue("invalid"), std::nullopt);
 }
+
+TEST(VectorTileData, Cursor) {
+    VectorTileData data(std::make_shared<std::string>(util::read_file("test/fixtures/map/issue12432/0-0-0.mvt")));
+    std::unique_ptr<GeometryTileLayer> layer = data.getLayer("admin");
+
+    // The cursor yields the same features as getFeature().
+    auto cursor = layer->makeCursor();
+    for (std::size_t i : {0u, 1u, 17153u}) {
+        const GeometryTileFeature& feature = cursor->seek(i);
+        std::unique_ptr<GeometryTileFeature> expected = layer->getFeature(i);
+        EXPECT_EQ(expected->getType(), feature.getType());
+        EXPECT_EQ(expected->getID(), feature.getID());
+        EXPECT_EQ(expected->getProperties(), feature.getProperties());
+        EXPECT_EQ(expected->getGeometries(), feature.getGeometries());
+    }
+
+    // A feature taken from the cursor keeps the data decoded through the cursor.
+    const GeometryCollection geometries = cursor->seek(1u).getGeometries();
+    std::unique_ptr<GeometryTileFeature> taken = cursor->take();
+    ASSERT_NE(nullptr, taken);
+    EXPECT_EQ(layer->getFeature(1u)->getID(), taken->getID());
+    EXPECT_EQ(geometries, taken->getGeometries());
+    EXPECT_EQ(layer->getFeature(1u)->getProperties(), taken->getProperties());
+}
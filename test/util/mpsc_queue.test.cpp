@@ -0,0 +1,57 @@
+#include <mbgl/test/util.hpp>
+
+#include <mbgl/util/mpsc_queue.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+TEST(MPSCQueue, FIFO) {
+    util::MPSCQueue<std::unique_ptr<int>> queue;
+
+    std::unique_ptr<int> value;
+    EXPECT_FALSE(queue.pop(value));
+
+    queue.push(std::make_unique<int>(1));
+    queue.push(std::make_unique<int>(2));
+
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(1, *value);
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(2, *value);
+    EXPECT_FALSE(queue.pop(value));
+
+    // Elements left in the queue are destroyed with it.
+    queue.push(std::make_unique<int>(3));
+}
+
+TEST(MPSCQueue, MultipleProducers) {
+    constexpr int kProducers = 4;
+    constexpr int kMessages = 10000;
+    util::MPSCQueue<std::pair<int, int>> queue;
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducers; ++i) {
+        producers.emplace_back([&queue, i] {
+            for (int j = 0; j < kMessages; ++j) {
+                queue.push({i, j});
+            }
+        });
+    }
+
+    // Messages of every producer arrive in the order they were pushed.
+    std::vector<int> next(kProducers, 0);
+    std::pair<int, int> message;
+    for (int received = 0; received < kProducers * kMessages;) {
+        if (queue.pop(message)) {
+            EXPECT_EQ(next[message.first]++, message.second);
+            ++received;
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+}
@@ -0,0 +1,113 @@
+#include <mbgl/util/thread_pool.hpp>
+
+#include <mbgl/platform/settings.hpp>
+#include <mbgl/test/util.hpp>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <vector>
+
+using namespace mbgl;
+
+TEST(ThreadPool, ThreadCount) {
+    ThreadPool pool(3);
+    EXPECT_EQ(3u, pool.getThreadCount());
+
+    auto& settings = platform::Settings::getInstance();
+    settings.set(platform::EXPERIMENTAL_THREAD_POOL_SIZE, mapbox::base::Value{uint64_t(5)});
+    EXPECT_EQ(5u, ThreadPool::getDefaultThreadCount());
+
+    settings.set(platform::EXPERIMENTAL_THREAD_POOL_SIZE, mapbox::base::Value{});
+    EXPECT_LE(1u, ThreadPool::getDefaultThreadCount());
+}
+
+TEST(ThreadPool, RunsTasksScheduledFromWorkers) {
+    // Tasks scheduled from a worker land on that worker's queue and have to be
+    // picked up by the other workers through stealing.
+    ThreadPool pool(4);
+    constexpr int kTasks = 1000;
+    std::atomic<int> count{0};
+    std::promise<void> done;
+
+    pool.schedule([&] {
+        for (int i = 0; i < kTasks; ++i) {
+            pool.schedule([&] {
+                if (++count == kTasks) done.set_value();
+            });
+        }
+    });
+
+    done.get_future().get();
+    EXPECT_EQ(kTasks, count);
+}
+
+TEST(ThreadPool, SequencedSchedulerKeepsOrder) {
+    SequencedScheduler scheduler;
+    constexpr int kTasks = 100;
+    int next = 0;
+    bool ordered = true;
+    std::promise<void> done;
+
+    for (int i = 0; i < kTasks; ++i) {
+        scheduler.schedule([&, i] {
+            ordered = ordered && (next++ == i);
+            if (i == kTasks - 1) done.set_value();
+        });
+    }
+
+    done.get_future().get();
+    EXPECT_TRUE(ordered);
+}
+
+TEST(ThreadPool, RunsHigherPriorityFirst) {
+    SequencedScheduler scheduler;
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future();
+    std::vector<TaskPriority> order;
+    std::promise<void> done;
+
+    // Occupy the only worker so that all of the following tasks are queued at once.
+    scheduler.schedule([&] {
+        blocked.set_value();
+        releaseFuture.wait();
+    });
+    blocked.get_future().wait();
+
+    scheduler.scheduleWithPriority(TaskPriority::Low, [&] {
+        order.push_back(TaskPriority::Low);
+        done.set_value();
+    });
+    scheduler.schedule([&] { order.push_back(TaskPriority::Default); });
+    scheduler.scheduleWithPriority(TaskPriority::High, [&] { order.push_back(TaskPriority::High); });
+    release.set_value();
+
+    done.get_future().get();
+    EXPECT_EQ((std::vector<TaskPriority>{TaskPriority::High, TaskPriority::Default, TaskPriority::Low}), order);
+}
+
+TEST(ThreadPool, RunsLowPriorityWhileHigherPriorityKeepsArriving) {
+    SequencedScheduler scheduler;
+    constexpr int kMaximumHighTasks = 100000;
+    std::atomic<bool> lowRan{false};
+    int highTasks = 0;
+    std::promise<void> done;
+
+    // Each High task schedules the next one until the Low task ran, so the High lane is never
+    // empty when the worker looks for a task.
+    std::function<void()> high = [&] {
+        if (lowRan || ++highTasks == kMaximumHighTasks) {
+            done.set_value();
+            return;
+        }
+        scheduler.scheduleWithPriority(TaskPriority::High, high);
+    };
+
+    scheduler.scheduleWithPriority(TaskPriority::High, high);
+    scheduler.scheduleWithPriority(TaskPriority::Low, [&] { lowRan = true; });
+
+    done.get_future().get();
+    EXPECT_TRUE(lowRan);
+    EXPECT_GT(kMaximumHighTasks, highTasks);
+}